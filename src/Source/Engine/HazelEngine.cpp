@@ -3,11 +3,61 @@
 #include "HE_Assert.h"
 #include "HE_String.h"
 
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
 namespace HE
 {
-	Engine::Engine(const std::vector<std::string>& args)
+	namespace
 	{
+		// Parses "<size>[K|M|G]", returning 0 if the size is invalid or larger than the address space of the platform
+		size_t ParseSize(const std::string& sSize) noexcept
+		{
+			// strtoull also accepts leading spaces and signs, and wraps negative values around
+			if (sSize.empty() || !std::isdigit(static_cast<unsigned char>(sSize[0]))) return 0;
+
+			char* pEnd = nullptr;
+			errno = 0;
+			auto const nValue = std::strtoull(sSize.c_str(), &pEnd, 10);
+			if (errno == ERANGE || nValue > SIZE_MAX) return 0;
+
+			unsigned nShift = 0;
+			switch (*pEnd)
+			{
+			case '\0': break;
+			case 'K': case 'k': nShift = 10; break;
+			case 'M': case 'm': nShift = 20; break;
+			case 'G': case 'g': nShift = 30; break;
+			default: return 0;
+			}
+			if (nShift != 0 && pEnd[1] != '\0') return 0;
+			if (nValue > (PlatformMaxAddressSpace >> nShift)) return 0;
+
+			return static_cast<size_t>(nValue) << nShift;
+		}
+
+		size_t GetSimulationArenaSize(const std::vector<std::string>& args)
+		{
+			static char const option[] = "--simulation-arena=";
+			for (auto const& sArg : args)
+			{
+				if (sArg.compare(0, sizeof(option) - 1, option) != 0) continue;
 
+				auto const nSize = ParseSize(sArg.substr(sizeof(option) - 1));
+				if (nSize != 0) return nSize;
+
+				LogError("Invalid argument \"{_}\", the simulation arena keeps its default size", sArg);
+			}
+			return Engine::default_simulation_arena_size;
+		}
+	}
+
+	Engine::Engine(const std::vector<std::string>& args)
+		: m_simulationArena{ GetSimulationArenaSize(args) }
+	{
+		if (m_simulationArena.reserved() == 0) LogError("Could not reserve the address space of the simulation arena");
 	}
 
 	Engine::~Engine() { Stop(); }
@@ -26,6 +76,8 @@ namespace HE
 			auto i = 0;
 			while (!m_bShouldStop) 
 			{ 
+				m_frameAllocator.nextFrame();
+
 				std::this_thread::sleep_for(100ms); 
 				++i;
 				if (i > 100)
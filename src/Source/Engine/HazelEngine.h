@@ -3,6 +3,9 @@
 #include <future>
 #include <cstdint>
 
+#include "HE_Allocator.h"
+#include "HE_VirtualMemory.h"
+
 namespace HE
 {
 	using EngineVersion = std::uint32_t;
@@ -42,7 +45,8 @@ namespace HE
 
 	// Represents a game engine that wraps both a Model of a game and
 	// a View of the Model
-	// The Engine can be customized on construction
+	// The Engine can be customized on construction, with the arguments:
+	//   --simulation-arena=<size>[K|M|G]: address space reserved for the SimulationArena, in bytes by default
 	// The Engine should be Run after being constructed. The Engine
 	// will then run on its own and do its own thing, until told to stop or 
 	// decides to stop
@@ -66,7 +70,23 @@ namespace HE
 		// Thread-safe. Signals the Engine to stop running
 		void Stop();
 
+		// Allocator for transient memory of the current frame, reset at the start of every frame
+		// Memory allocated during a frame stays valid during the next frame
+		// Not thread-safe: should only be used from the Engine's thread while it is running
+		using FrameArena = FrameAllocator<16 * 1024 * 1024, 2, AlignedMallocAllocator>;
+		FrameArena& GetFrameAllocator() noexcept { return m_frameAllocator; }
+
+		// Allocator for the large arrays of the simulation, ex: the component arrays of the entities, on huge pages
+		// when the system has them. Its size is only reserved, pages are committed as the allocations reach them,
+		// except for explicit huge pages, which are all taken from the system's pool on construction
+		// Not thread-safe: should only be used from the Engine's thread while it is running
+		using SimulationArena = HugePageArena;
+		static constexpr size_t default_simulation_arena_size = size_t{ 1 } << 30;
+		SimulationArena& GetSimulationArena() noexcept { return m_simulationArena; }
+
 	private:
+		FrameArena m_frameAllocator;
+		SimulationArena m_simulationArena{ default_simulation_arena_size };
 		std::atomic<bool> m_bShouldStop{false};
 		bool m_bRunning{ false };
 	};
@@ -1,13 +1,10 @@
 #pragma once
 
-#include <vector>
-#include <memory>
-
+#include "HE_HandlePool.h"
+#include "Entity.h"
 
 namespace HE
 {
-	class Entity;
-
 	class Model
 	{
 	public:
@@ -18,7 +15,7 @@ namespace HE
 		auto const& GetEntities() const noexcept { return m_cEntities; }
 
 	private:
-		std::vector<std::unique_ptr<Entity>> m_cEntities;
+		HandlePool<Entity> m_cEntities;
 
 	};
 
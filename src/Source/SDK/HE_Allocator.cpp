@@ -20,6 +20,15 @@ namespace HE
 		std::free(blk.ptr);
 	}
 
+	bool MallocAllocator::reallocate(Blk& b, size_t n)
+	{
+		auto const p = std::realloc(b.ptr, n);
+		if (!p) return false;
+
+		b = { p, n };
+		return true;
+	}
+
 	Blk AlignedMallocAllocator::allocate(size_t n)
 	{
 		return{ ALIGNED_MALLOC(n, alignment), n };
@@ -60,4 +69,14 @@ namespace HE
 	{
 		return b.ptr == nullptr;
 	}
+
+	bool NullAllocator::expand(Blk&, size_t delta)
+	{
+		return delta == 0;
+	}
+
+	bool NullAllocator::reallocate(Blk&, size_t)
+	{
+		return false;
+	}
 }
\ No newline at end of file
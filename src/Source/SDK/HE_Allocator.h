@@ -5,8 +5,20 @@
 #include "TMP_Helper.h"
 #include "HE_Assert.h"
 #include "HE_Math.h"
+#include "HE_Platform.h"
 
 #include <type_traits>
+#include <chrono>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+
+#if defined(PLATFORM_SSE2)
+#include <emmintrin.h>
+#endif
 
 namespace HE
 {
@@ -25,6 +37,9 @@ namespace HE
 	constexpr size_t PlatformMaxAlignment = Math::Max(alignof(void*), alignof(size_t));
 	static_assert(Math::IsPow2(PlatformMaxAlignment), "PlatformMaxAlignment is not a power of 2, as should be");
 
+	// Size of a cache line, used to keep data written by different threads apart
+	constexpr size_t PlatformCacheLineSize = 64;
+
 	namespace Private
 	{
 		template<class T>
@@ -46,6 +61,12 @@ namespace HE
 
 		template<class T>
 		using try_it = std::enable_if_t<std::is_same<T, decltype(T::it)>::value>;
+
+		template<class T>
+		using try_expand = std::enable_if_t<std::is_same<bool, decltype(std::declval<T>().expand(std::declval<Blk&>(), std::declval<size_t>()))>::value>;
+
+		template<class T>
+		using try_reallocate = std::enable_if_t<std::is_same<bool, decltype(std::declval<T>().reallocate(std::declval<Blk&>(), std::declval<size_t>()))>::value>;
 	}
 
 	// Allocator
@@ -96,6 +117,33 @@ namespace HE
 		return and_<is_aligned_allocator<T>...>::value;
 	}
 
+	// ExpandingAllocator
+	// Must have (for allocator of type T)
+	// - HE::is_allocator<T>()
+	// - bool T::expand(MemoryBlock&, size_t delta)
+	// Grows a non-null block by delta bytes without moving it. On failure, returns false and leaves the block untouched
+	template<class T>
+	using is_expanding_allocator = and_<is_allocator<T>, has_op<T, Private::try_expand>>;
+	template<class... T>
+	constexpr bool IsExpandingAllocator()
+	{
+		return and_<is_expanding_allocator<T>...>::value;
+	}
+
+	// ReallocatingAllocator
+	// Must have (for allocator of type T)
+	// - HE::is_allocator<T>()
+	// - bool T::reallocate(MemoryBlock&, size_t n)
+	// Resizes a non-null block to n != 0 bytes, moving it if needed while keeping its content. On failure,
+	// returns false and leaves the block untouched. Use HE::reallocate for null blocks and sizes of 0
+	template<class T>
+	using is_reallocating_allocator = and_<is_allocator<T>, has_op<T, Private::try_reallocate>>;
+	template<class... T>
+	constexpr bool IsReallocatingAllocator()
+	{
+		return and_<is_reallocating_allocator<T>...>::value;
+	}
+
 	// Generic allocator functions
 	template< class Type, class Allocator, class Enable = std::enable_if_t<is_allocator<Allocator>::value>>
 	Blk allocate(Allocator&& a)
@@ -109,6 +157,158 @@ namespace HE
 		return a.allocate(count*sizeof(Type), alignof(Type));
 	}
 
+	namespace Private
+	{
+		// Copies the content of b to result, then deallocates b on 'from'. Fails if result is null
+		template<class From>
+		bool ReplaceBlock(From& from, Blk& b, Blk result)
+		{
+			if (!result.ptr) return false;
+
+			std::memcpy(result.ptr, b.ptr, Math::Min(b.length, result.length));
+			from.deallocate(b);
+			b = result;
+			return true;
+		}
+
+		// Moves the content of b to a new block of n bytes allocated on 'to', then deallocates b on 'from'
+		template<class To, class From>
+		bool MoveBlock(To& to, From& from, Blk& b, size_t n)
+		{
+			return ReplaceBlock(from, b, to.allocate(n));
+		}
+
+		// Same, with the new block allocated at the alignment
+		template<class To, class From>
+		bool MoveBlock(To& to, From& from, Blk& b, size_t n, size_t alignment)
+		{
+			return ReplaceBlock(from, b, to.allocate(n, alignment));
+		}
+
+		template<class Allocator>
+		bool Expand(Allocator& a, Blk& b, size_t delta, std::true_type)
+		{
+			return a.expand(b, delta);
+		}
+
+		template<class Allocator>
+		bool Expand(Allocator&, Blk&, size_t, std::false_type)
+		{
+			return false;
+		}
+
+		// Calls a.expand if the allocator supports it, otherwise fails
+		template<class Allocator>
+		bool Expand(Allocator& a, Blk& b, size_t delta)
+		{
+			return Expand(a, b, delta, has_op<Allocator, try_expand>{});
+		}
+
+		template<class Allocator>
+		bool Reallocate(Allocator& a, Blk& b, size_t n, std::true_type)
+		{
+			return a.reallocate(b, n);
+		}
+
+		template<class Allocator>
+		bool Reallocate(Allocator& a, Blk& b, size_t n, std::false_type)
+		{
+			if (n > b.length && Expand(a, b, n - b.length)) return true;
+			return MoveBlock(a, a, b, n);
+		}
+
+		// Calls a.reallocate if the allocator supports it, otherwise tries to expand the block in place before 
+		// moving it to a new block
+		// Pre-condition: b.ptr != nullptr and n != 0
+		template<class Allocator>
+		bool Reallocate(Allocator& a, Blk& b, size_t n)
+		{
+			return Reallocate(a, b, n, has_op<Allocator, try_reallocate>{});
+		}
+	}
+
+	// Resizes b to n bytes with the allocator, keeping its content
+	// A null block gets allocated, and a size of 0 deallocates the block
+	// On failure, returns false and leaves the block untouched
+	template<class Allocator, class Enable = std::enable_if_t<is_allocator<Allocator>::value>>
+	bool reallocate(Allocator& a, Blk& b, size_t n)
+	{
+		if (!b.ptr)
+		{
+			auto const result = a.allocate(n);
+			if (!result.ptr && n != 0) return false;
+			b = result;
+			return true;
+		}
+
+		if (n == 0)
+		{
+			a.deallocate(b);
+			b = { nullptr, 0 };
+			return true;
+		}
+
+		if (b.length == n) return true;
+		return Private::Reallocate(a, b, n);
+	}
+
+	// Same, for a block allocated at the alignment, which the new block keeps
+	// Blocks over-aligned for the allocator are only resized in place by expand, since the allocator's reallocate
+	// may move them to a block at its default alignment
+	template<class Allocator, class Enable = std::enable_if_t<is_aligned_allocator<Allocator>::value>>
+	bool reallocate(Allocator& a, Blk& b, size_t n, size_t alignment)
+	{
+		if (alignment <= Allocator::alignment) return reallocate(a, b, n);
+
+		if (!b.ptr)
+		{
+			auto const result = a.allocate(n, alignment);
+			if (!result.ptr && n != 0) return false;
+			b = result;
+			return true;
+		}
+
+		if (n == 0)
+		{
+			a.deallocate(b);
+			b = { nullptr, 0 };
+			return true;
+		}
+
+		if (b.length == n) return true;
+		if (n > b.length && Private::Expand(a, b, n - b.length)) return true;
+		return Private::MoveBlock(a, a, b, n, alignment);
+	}
+
+	namespace Private
+	{
+		template<class T, class Allocator>
+		Blk AllocateAlignedFor(Allocator& a, size_t n, std::true_type)
+		{
+			return a.allocate(n, alignof(T));
+		}
+
+		template<class T, class Allocator>
+		Blk AllocateAlignedFor(Allocator& a, size_t n, std::false_type)
+		{
+			return a.allocate(n);
+		}
+
+		// Allocates n bytes for the objects of a container, aligned for T. Types over-aligned for the allocator use
+		// the aligned allocate, which the allocator must then support
+		// Throws std::bad_alloc when the allocator fails
+		template<class T, class Allocator>
+		Blk AllocateFor(Allocator& a, size_t n)
+		{
+			using needs_alignment = std::integral_constant<bool, (alignof(T) > Allocator::alignment)>;
+			static_assert(!needs_alignment::value || IsAlignedAllocator<Allocator>(), "T is over-aligned for Allocator, which does not meet the HE::AlignedAllocator concept");
+
+			auto const b = AllocateAlignedFor<T>(a, n, needs_alignment{});
+			if (!b.ptr) throw std::bad_alloc{};
+			return b;
+		}
+	}
+
 	class NullAllocator
 	{
 	public:
@@ -120,6 +320,8 @@ namespace HE
 		void deallocate(Blk) noexcept;
 		void deallocateAll() noexcept;
 		bool owns(Blk);
+		bool expand(Blk&, size_t delta);
+		bool reallocate(Blk&, size_t);
 	};
 	
 	// Returns the beginning of the buffer is the buffer is big enough, even if it
@@ -167,10 +369,197 @@ namespace HE
 
 		void deallocate(Blk) noexcept {}
 
+		bool expand(Blk& b, size_t delta)
+		{
+			return reallocate(b, b.length + delta);
+		}
+
+		// The block can't move out of the buffer, so it is only resized in place
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (n > N - (static_cast<char*>(b.ptr) - m_buffer)) return false;
+			b.length = n;
+			return true;
+		}
+
 	private:
 		char m_buffer[N];
 	};
 
+	namespace Private
+	{
+		// Storage of a StackAllocator, a BitmappedBlock or a CompactingAllocator: a buffer of N bytes allocated on the Parent allocator 
+		// on construction, and returned to it on destruction
+		template<size_t N, class Parent>
+		class StackStorage : private Parent
+		{
+			static_assert(IsAllocator<Parent>(), "StackAllocator's Parent does not meet the HE::Allocator concept");
+
+		protected:
+			static constexpr size_t storage_alignment = Parent::alignment;
+
+			StackStorage() : m_pBuffer{ static_cast<char*>(Parent::allocate(N).ptr) } {}
+			~StackStorage()
+			{
+				if (m_pBuffer) Parent::deallocate({ m_pBuffer, N });
+			}
+
+			StackStorage(const StackStorage&) = delete;
+			void operator=(const StackStorage&) = delete;
+
+			char* buffer() const noexcept { return m_pBuffer; }
+
+		private:
+			char* const m_pBuffer;
+		};
+
+		// Inline storage of a StackAllocator, a BitmappedBlock or a CompactingAllocator
+		template<size_t N>
+		class alignas(PlatformMaxAlignment) StackStorage<N, void>
+		{
+		protected:
+			static constexpr size_t storage_alignment = PlatformMaxAlignment;
+
+			StackStorage() = default;
+			StackStorage(const StackStorage&) = delete;
+			void operator=(const StackStorage&) = delete;
+
+			char* buffer() const noexcept { return const_cast<char*>(m_buffer); }
+
+		private:
+			char m_buffer[N];
+		};
+	}
+
+	// An allocator that allocates by bumping an offset in a buffer of N bytes. The buffer
+	// is inline if Parent is void, or allocated on the Parent allocator otherwise
+	// Deallocations must happen in LIFO order: deallocating a block other than the last one
+	// allocated does nothing, and the memory is only recovered on rewind or deallocateAll
+	// Every allocation is rounded up to the alignment of the allocator. With aligned allocations,
+	// the padding before the block is only recovered by a rewind or a deallocateAll
+	// Pairs well as the primary allocator of a FallbackAllocator, or as the small allocator
+	// of a SegregateAllocator
+	template<size_t N, class Parent = void>
+	class StackAllocator : private Private::StackStorage<N, Parent>
+	{
+		static_assert(N > 0, "StackAllocator's size should be higher than 0");
+
+		using Storage = Private::StackStorage<N, Parent>;
+
+	public:
+		static constexpr size_t alignment = Storage::storage_alignment;
+
+		// Opaque position in the stack, used to deallocate everything allocated since the marker was taken
+		struct Marker
+		{
+			size_t offset;
+		};
+
+		Blk allocate(size_t n)
+		{
+			if (!buffer() || n > N - m_nTop) return{ nullptr, 0 };
+			auto const nAllocationSize = Math::RoundUpToMultipleOf(n, alignment);
+			if (nAllocationSize > N - m_nTop) return{ nullptr, 0 };
+
+			Blk const b{ buffer() + m_nTop, n };
+			m_nTop += nAllocationSize;
+			return b;
+		}
+
+		Blk allocate(size_t n, size_t a)
+		{
+			EXPECTS(Math::IsPow2(a) && a >= alignment);
+			if (!buffer()) return{ nullptr, 0 };
+
+			auto const nBegin = reinterpret_cast<size_t>(buffer());
+			auto const nOffset = Math::RoundUpToMultipleOf(nBegin + m_nTop, a) - nBegin;
+			if (nOffset > N || n > N - nOffset) return{ nullptr, 0 };
+			auto const nAllocationSize = Math::RoundUpToMultipleOf(n, alignment);
+			if (nAllocationSize > N - nOffset) return{ nullptr, 0 };
+
+			Blk const b{ buffer() + nOffset, n };
+			m_nTop = nOffset + nAllocationSize;
+			return b;
+		}
+
+		// Only the last allocated block is actually deallocated
+		void deallocate(Blk b) noexcept
+		{
+			if (isLast(b))
+			{
+				m_nTop = static_cast<char*>(b.ptr) - buffer();
+			}
+		}
+
+		void deallocateAll() noexcept
+		{
+			m_nTop = 0;
+		}
+
+		bool owns(Blk b) const
+		{
+			return buffer() && b.begin() >= buffer() && b.end() <= buffer() + N;
+		}
+
+		// Only the last allocated block can grow
+		bool expand(Blk& b, size_t delta)
+		{
+			if (!isLast(b)) return false;
+			return resizeLast(b, b.length + delta);
+		}
+
+		// The last allocated block is resized in place. Other blocks shrink in place, leaving their tail unused until
+		// a rewind or deallocateAll, and grow by moving to a new allocation unless their rounded size stays the same
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (isLast(b)) return resizeLast(b, n);
+			if (n <= b.length || Math::RoundUpToMultipleOf(n, alignment) == Math::RoundUpToMultipleOf(b.length, alignment))
+			{
+				b.length = n;
+				return true;
+			}
+			return Private::MoveBlock(*this, *this, b, n);
+		}
+
+		Marker marker() const noexcept
+		{
+			return{ m_nTop };
+		}
+
+		// Deallocates every block allocated since the marker was taken
+		// Pre-condition: the marker was taken on this allocator, and no rewind to an earlier marker happened since
+		void rewind(Marker m) noexcept
+		{
+			EXPECTS(m.offset <= m_nTop);
+			m_nTop = m.offset;
+		}
+
+		size_t size() const noexcept { return m_nTop; }
+		static constexpr size_t capacity() { return N; }
+
+	private:
+		using Storage::buffer;
+
+		size_t m_nTop{ 0 };
+
+		bool isLast(Blk b) const noexcept
+		{
+			return b.ptr && static_cast<char*>(b.ptr) + Math::RoundUpToMultipleOf(b.length, alignment) == buffer() + m_nTop;
+		}
+
+		bool resizeLast(Blk& b, size_t n) noexcept
+		{
+			auto const nOffset = static_cast<size_t>(static_cast<char*>(b.ptr) - buffer());
+			if (n > N - nOffset) return false;
+			auto const nAllocationSize = Math::RoundUpToMultipleOf(n, alignment);
+			if (nAllocationSize > N - nOffset) return false;
+
+			m_nTop = nOffset + nAllocationSize;
+			b.length = n;
+			return true;
+		}
+	};
+
 	class MallocAllocator
 	{
 	public:
@@ -179,6 +568,7 @@ namespace HE
 
 		Blk allocate(size_t n);
 		void deallocate(Blk) noexcept;
+		bool reallocate(Blk&, size_t n);
 	};
 
 	class AlignedMallocAllocator
@@ -192,6 +582,83 @@ namespace HE
 		void deallocate(Blk) noexcept;
 	};
 
+	// An allocator for transient memory that only needs to live for a few frames
+	// Allocates from one StackAllocator of N bytes per frame in flight. Ending a frame with nextFrame
+	// makes the next stack current and resets it in O(1), so that memory allocated during a frame
+	// stays valid for the FrameCount - 1 frames that follow it (ex: with the default of 2, what was written
+	// in frame N can still be read while frame N + 1 is simulated)
+	// Deallocations follow the StackAllocator rules on the current frame, and are ignored on previous frames
+	template<size_t N, size_t FrameCount = 2, class Parent = MallocAllocator>
+	class FrameAllocator
+	{
+		static_assert(FrameCount > 0, "FrameAllocator's FrameCount should be higher than 0");
+
+	public:
+		using FrameStack = StackAllocator<N, Parent>;
+		static constexpr size_t alignment = FrameStack::alignment;
+
+		Blk allocate(size_t n)
+		{
+			return current().allocate(n);
+		}
+
+		Blk allocate(size_t n, size_t a)
+		{
+			return current().allocate(n, a);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			current().deallocate(b);
+		}
+
+		bool expand(Blk& b, size_t delta)
+		{
+			return current().expand(b, delta);
+		}
+
+		// Blocks of previous frames shrink in place, and grow by moving to the current frame unless their rounded size
+		// stays the same
+		bool reallocate(Blk& b, size_t n)
+		{
+			return current().reallocate(b, n);
+		}
+
+		void deallocateAll() noexcept
+		{
+			for (auto& stack : m_stacks)
+			{
+				stack.deallocateAll();
+			}
+		}
+
+		bool owns(Blk b) const
+		{
+			for (auto const& stack : m_stacks)
+			{
+				if (stack.owns(b)) return true;
+			}
+			return false;
+		}
+
+		// Ends the current frame. Every block allocated FrameCount frames ago is deallocated
+		void nextFrame() noexcept
+		{
+			m_nFrame = (m_nFrame + 1) % FrameCount;
+			current().deallocateAll();
+		}
+
+		// Index of the current frame stack, in [0, FrameCount)
+		size_t frame() const noexcept { return m_nFrame; }
+		static constexpr size_t frameCount() { return FrameCount; }
+
+	private:
+		FrameStack m_stacks[FrameCount];
+		size_t m_nFrame{ 0 };
+
+		FrameStack& current() noexcept { return m_stacks[m_nFrame]; }
+	};
+
 	template< class Primary, class Fallback >
 	class FallbackAllocator;
 
@@ -255,6 +722,23 @@ namespace HE
 				F::deallocate(b);
 		}
 
+		bool expand(Blk& b, size_t delta)
+		{
+			if (P::owns(b))
+				return Private::Expand(static_cast<P&>(*this), b, delta);
+			else
+				return Private::Expand(static_cast<F&>(*this), b, delta);
+		}
+
+		// A block of the Primary allocator that cannot be resized in it is moved to the Fallback allocator
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (P::owns(b))
+				return Private::Reallocate(static_cast<P&>(*this), b, n) || Private::MoveBlock(static_cast<F&>(*this), static_cast<P&>(*this), b, n);
+			else
+				return Private::Reallocate(static_cast<F&>(*this), b, n);
+		}
+
 		template<class Enable = std::enable_if_t<and_<has_op<Primary, Private::try_deallocateAll>, has_op<Fallback, Private::try_deallocateAll>>::value>>
 		void deallocateAll() noexcept
 		{
@@ -289,9 +773,12 @@ namespace HE
 	// maxSize: Maxsimum size of the allocation to be considered in range
 	// batchCount: Number of allocations on a fresh "in range" allocation. Basically fills up the Freelist with batchCount nodes on allocation
 	// maxNodes: Max number of nodes the freelist can keep
+	// With a batchCount higher than 1, the nodes are carved from a single "chunk" allocated on the Parent. Chunks are only
+	// returned to the Parent on deallocateAll, which is why a batched Freelist cannot have a maxNodes
 	template< class Parent,
 		size_t MinSize, 
 		size_t MaxSize = MinSize,
+		size_t BatchCount = 1,
 		size_t MaxNodes = Allocator::unbounded,
 		class Enable = std::enable_if_t<is_allocator<Parent>::value>
 		>
@@ -300,29 +787,28 @@ namespace HE
 	{
 		static_assert(MaxSize >= MinSize, "FreelistAllocator's MaxSize should be higher or equal to MinSize");
 		static_assert(MaxSize >= sizeof(void*), "FreelistAllocator's MaxSize and MinSize should be higher or equal than sizeof(void*)");
+		static_assert(BatchCount > 0, "FreelistAllocator's BatchCount should be higher than 0");
+		static_assert(BatchCount == 1 || MaxNodes == Allocator::unbounded, "A batched FreelistAllocator cannot have a MaxNodes, since nodes are not deallocated individually");
 
 	public:
 		static constexpr size_t alignment = Parent::alignment;
 
 		Blk allocate(size_t n)
 		{
-			return allocateImpl(n);
+			return allocateImpl(n, alignment);
 		}
 
-		template<class Enable = std::enable_if_t<is_aligned_allocator<Parent>::value>>
+		template<class P = Parent, class = std::enable_if_t<is_aligned_allocator<P>::value>>
 		Blk allocate(size_t n, size_t alignment)
 		{
-			return allocateImpl(n, alignment);
+			return allocateImpl(n, alignment, alignment);
 		}
 
 		void deallocate(Blk b) noexcept
 		{
 			if ((MaxNodes == Allocator::unbounded || m_nNodesCount != MaxNodes) && inRange(b.length))
 			{
-				auto const next = m_pFreelistRoot;
-				m_pFreelistRoot = static_cast<Node*>(b.ptr);
-				m_pFreelistRoot->next = next;
-				++m_nNodesCount;
+				push(b.ptr);
 			}
 			else
 			{
@@ -331,27 +817,61 @@ namespace HE
 		}
 
 		// Only O(1) if the Parent allocator supports deallocateAll
-		// If the Freelist is unbounded and the Parent doesn't support deallocateAll,
-		// the Freelist will do a best effort of deallocating all the nodes in its freelist
-		// in O(n)
+		// If the Freelist is batched, every chunk is returned to the Parent allocator in O(chunks)
+		// Otherwise, if the Parent doesn't support deallocateAll, the Freelist will do a best effort 
+		// of deallocating all the nodes in its freelist in O(n)
 		void deallocateAll() noexcept
 		{
-			deallocateAllImpl();
+			deallocateAllImpl(std::integral_constant<bool, has_fast_deallocateAll()>{}, std::integral_constant<bool, is_batched()>{});
+			m_pFreelistRoot = nullptr;
+			m_pChunkRoot = nullptr;
+			m_nNodesCount = 0;
 		}
 
 		static constexpr bool has_fast_deallocateAll() { return has_op<Parent, Private::try_deallocateAll>::value; }
+		static constexpr bool is_batched() { return BatchCount > 1; }
 
 		bool owns(Blk b)
 		{
 			return Parent::owns(b);
 		}
 
+		// Nodes have room for MaxSize bytes, so in range blocks can grow up to MaxSize in place
+		// Out of range blocks are expanded by the Parent, as long as they stay out of range
+		bool expand(Blk& b, size_t delta)
+		{
+			auto const n = b.length + delta;
+			if (inRange(b.length) != inRange(n)) return false;
+			if (!inRange(n)) return Private::Expand(static_cast<Parent&>(*this), b, delta);
+
+			b.length = n;
+			return true;
+		}
+
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (inRange(b.length) != inRange(n)) return Private::MoveBlock(*this, *this, b, n);
+			if (!inRange(n)) return Private::Reallocate(static_cast<Parent&>(*this), b, n);
+
+			b.length = n;
+			return true;
+		}
+
 	private:
 		struct Node
 		{
 			Node* next;
 		};
+
+		// Bookkeeping of a batch allocation, placed at the end of the chunk
+		struct Chunk
+		{
+			Chunk* next;
+			Blk block;
+		};
+
 		Node* m_pFreelistRoot{ nullptr };
+		Chunk* m_pChunkRoot{ nullptr };
 		size_t m_nNodesCount{ 0 };
 
 		bool inRange(size_t n) const
@@ -361,13 +881,23 @@ namespace HE
 			return (MinSize == 0 || n >= MinSize) && n <= MaxSize;
 		}
 
+		void push(void* p) noexcept
+		{
+			auto const next = m_pFreelistRoot;
+			m_pFreelistRoot = static_cast<Node*>(p);
+			m_pFreelistRoot->next = next;
+			++m_nNodesCount;
+		}
+
 		template<class... Args>
-		Blk allocateImpl(size_t n, Args... args)
+		Blk allocateImpl(size_t n, size_t nodeAlignment, Args... args)
 		{
 			if (!inRange(n)) return Parent::allocate(n, args...);
 
 			if (!m_pFreelistRoot)
 			{
+				if (is_batched()) return{ allocateChunk(nodeAlignment, args...), n };
+
 				auto const b = Parent::allocate(MaxSize, args...);
 				return{ b.ptr, n };
 			}
@@ -380,19 +910,49 @@ namespace HE
 			}
 		}
 
-		void deallocateAllImpl(std::enable_if_t<has_op<Parent, Private::try_deallocateAll>::value>* = nullptr) noexcept
+		// Allocates BatchCount nodes in a single Parent allocation, keeps the first one for
+		// the caller and pushes the others on the freelist
+		template<class... Args>
+		void* allocateChunk(size_t nodeAlignment, Args... args)
+		{
+			auto const nStride = Math::RoundUpToMultipleOf(MaxSize, nodeAlignment);
+			auto const nChunkOffset = Math::RoundUpToMultipleOf(nStride * BatchCount, alignof(Chunk));
+			auto const b = Parent::allocate(nChunkOffset + sizeof(Chunk), args...);
+			if (!b.ptr) return nullptr;
+
+			auto const p = static_cast<char*>(b.ptr);
+			auto const pChunk = reinterpret_cast<Chunk*>(p + nChunkOffset);
+			pChunk->next = m_pChunkRoot;
+			pChunk->block = b;
+			m_pChunkRoot = pChunk;
+
+			// Push in reverse so that the nodes are handed out in address order
+			for (size_t i = BatchCount - 1; i > 0; --i)
+			{
+				push(p + i * nStride);
+			}
+			return p;
+		}
+
+		template<bool Batched>
+		void deallocateAllImpl(std::true_type, std::integral_constant<bool, Batched>) noexcept
 		{
 			Parent::deallocateAll();
-			m_pFreelistRoot = nullptr;
 		}
 
-		// In this case, we can only guarantee a complete deallocation if the freelist is unbounded
-		void deallocateAllImpl(std::enable_if_t<
-			and_<
-			not_<has_op<Parent, Private::try_deallocateAll>>,
-			has_op<Parent, Private::try_deallocate>,
-			equal_<std::integral_constant<size_t, MaxNodes>, std::integral_constant<size_t, Allocator::unbounded>>
-			>::value>* = nullptr) noexcept
+		void deallocateAllImpl(std::false_type, std::true_type) noexcept
+		{
+			auto next = m_pChunkRoot;
+			while (next)
+			{
+				auto const b = next->block;
+				next = next->next;
+				Parent::deallocate(b);
+			}
+		}
+
+		// In this case, only the nodes in the freelist can be returned to the Parent
+		void deallocateAllImpl(std::false_type, std::false_type) noexcept
 		{
 			auto next = m_pFreelistRoot;
 			while (next)
@@ -401,16 +961,607 @@ namespace HE
 				next = next->next;
 				Parent::deallocate(b);
 			}
-			m_pFreelistRoot = nullptr;
 		}
 	};
 
-	template<class Parent, class PrefixType, class SuffixType>
-	class AffixAllocator;
-
-	namespace Private
+	// An allocator that divides a slab of Count blocks of BlockSize bytes, with a bitmap of the free blocks
+	// The slab is allocated on the Parent allocator on construction, or inline if Parent is void
+	// An allocation takes as many contiguous blocks as needed, found by scanning the bitmap a word at a time
+	// Compared to a FreelistAllocator, the metadata is one bit per block kept outside of the blocks, and 
+	// neighbour allocations stay neighbours in memory. The cost is a O(Count / 64) search when the slab fills up
+	template<class Parent, size_t BlockSize, size_t Count>
+	class BitmappedBlock : private Private::StackStorage<BlockSize * Count, Parent>
 	{
-		template < class Parent, class PrefixType, class SuffixType, class Enable = void>
+		static_assert(BlockSize > 0, "BitmappedBlock's BlockSize should be higher than 0");
+		static_assert(Count > 0, "BitmappedBlock's Count should be higher than 0");
+
+		using Storage = Private::StackStorage<BlockSize * Count, Parent>;
+		using Word = std::uint64_t;
+		static constexpr size_t word_bits = 64;
+		static constexpr size_t word_count = (Count + word_bits - 1) / word_bits;
+
+	public:
+		// Every block is aligned on the largest power of 2 dividing BlockSize, up to the slab's alignment
+		static constexpr size_t alignment = Math::Min(Storage::storage_alignment, BlockSize & (~BlockSize + 1));
+
+		BitmappedBlock()
+		{
+			deallocateAll();
+		}
+
+		Blk allocate(size_t n)
+		{
+			if (n == 0 || n > capacity() || !buffer()) return{ nullptr, 0 };
+
+			auto const nBlocks = blockCount(n);
+			auto const nFirst = findFreeRun(nBlocks);
+			if (nFirst == Count) return{ nullptr, 0 };
+
+			markRange(nFirst, nBlocks, false);
+			return{ buffer() + nFirst * BlockSize, n };
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			if (!b.ptr) return;
+			EXPECTS(owns(b));
+			markRange(blockIndex(b), blockCount(b.length), true);
+		}
+
+		// Resets the bitmap, regardless of the number of allocations
+		void deallocateAll() noexcept
+		{
+			for (auto& w : m_bitmap) w = ~Word{ 0 };
+			if (Count % word_bits != 0)
+			{
+				// The bits past Count are never free
+				m_bitmap[word_count - 1] = (Word{ 1 } << (Count % word_bits)) - 1;
+			}
+		}
+
+		bool owns(Blk b) const
+		{
+			return buffer() && b.begin() >= buffer() && b.end() <= buffer() + capacity();
+		}
+
+		// Grows the block over the free blocks that follow it
+		bool expand(Blk& b, size_t delta)
+		{
+			auto const nFirst = blockIndex(b);
+			if (delta > capacity() - nFirst * BlockSize - b.length) return false;
+
+			auto const nBlocks = blockCount(b.length);
+			auto const nNewBlocks = blockCount(b.length + delta);
+			if (nNewBlocks > nBlocks)
+			{
+				auto const nEnd = nFirst + nBlocks;
+				if (nextUsed(nEnd) - nEnd < nNewBlocks - nBlocks) return false;
+				markRange(nEnd, nNewBlocks - nBlocks, false);
+			}
+
+			b.length += delta;
+			return true;
+		}
+
+		// Shrinking frees the blocks past the new size. Growing expands the block if possible, or moves it otherwise
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (n > b.length)
+			{
+				return expand(b, n - b.length) || Private::MoveBlock(*this, *this, b, n);
+			}
+
+			auto const nFirst = blockIndex(b);
+			auto const nBlocks = blockCount(b.length);
+			auto const nNewBlocks = blockCount(n);
+			markRange(nFirst + nNewBlocks, nBlocks - nNewBlocks, true);
+			b.length = n;
+			return true;
+		}
+
+		static constexpr size_t capacity() { return BlockSize * Count; }
+
+	private:
+		using Storage::buffer;
+
+		Word m_bitmap[word_count];
+
+		static size_t blockCount(size_t n) noexcept
+		{
+			return (n + BlockSize - 1) / BlockSize;
+		}
+
+		size_t blockIndex(Blk b) const noexcept
+		{
+			return (static_cast<char*>(b.ptr) - buffer()) / BlockSize;
+		}
+
+		// Index of the first block of nBlocks free blocks in a row, or Count if there is none
+		size_t findFreeRun(size_t nBlocks) const noexcept
+		{
+			auto i = nextFree(0);
+			if (nBlocks == 1) return i;
+
+			while (i < Count && nBlocks <= Count - i)
+			{
+				auto const nEnd = nextUsed(i);
+				if (nEnd - i >= nBlocks) return i;
+				i = nextFree(nEnd);
+			}
+			return Count;
+		}
+
+		size_t nextFree(size_t i) const noexcept { return scan(i, Word{ 0 }); }
+		size_t nextUsed(size_t i) const noexcept { return scan(i, ~Word{ 0 }); }
+
+		// Index of the first block at or after i whose bit differs from skip, which is all 0s or all 1s
+		// Returns Count if there is none
+		size_t scan(size_t i, Word skip) const noexcept
+		{
+			if (i >= Count) return Count;
+
+			auto w = i / word_bits;
+			auto const nFirst = (m_bitmap[w] ^ skip) & (~Word{ 0 } << (i % word_bits));
+			if (nFirst) return Math::Min(w * word_bits + Math::CountTrailingZeros(nFirst), Count);
+
+			w = skipWords(w + 1, skip);
+			if (w == word_count) return Count;
+			return Math::Min(w * word_bits + Math::CountTrailingZeros(m_bitmap[w] ^ skip), Count);
+		}
+
+		// Index of the first word at or after w that differs from skip, or word_count
+		// With SSE2, words are compared two at a time
+		size_t skipWords(size_t w, Word skip) const noexcept
+		{
+#if defined(PLATFORM_SSE2)
+			auto const vSkip = _mm_set1_epi32(static_cast<int>(skip));
+			for (; w + 2 <= word_count; w += 2)
+			{
+				auto const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_bitmap + w));
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, vSkip)) != 0xFFFF) break;
+			}
+#endif
+			while (w < word_count && m_bitmap[w] == skip) ++w;
+			return w;
+		}
+
+		void markRange(size_t i, size_t n, bool bFree) noexcept
+		{
+			while (n > 0)
+			{
+				auto const nBit = i % word_bits;
+				auto const nBits = Math::Min(n, word_bits - nBit);
+				auto const nMask = (nBits == word_bits ? ~Word{ 0 } : (Word{ 1 } << nBits) - 1) << nBit;
+				if (bFree) m_bitmap[i / word_bits] |= nMask;
+				else m_bitmap[i / word_bits] &= ~nMask;
+
+				i += nBits;
+				n -= nBits;
+			}
+		}
+	};
+
+	class PageAllocator;
+
+	// See HE_VirtualMemory.h, for the CompactingAllocator to give back the pages of a PageAllocator
+	namespace VirtualMemory
+	{
+		size_t GetPageSize() noexcept;
+		bool Commit(void* p, size_t n) noexcept;
+		void Decommit(void* p, size_t n) noexcept;
+	}
+
+	namespace Private
+	{
+		// Slots of a container handing out generational handles, ex: a HandlePool or a CompactingAllocator
+		// A handle is the index of a slot and the generation of the slot when it was taken. A slot is live when its 
+		// generation is odd, so that null handles (generation 0) and handles to free slots never match
+		// Free slots are chained through their Link member, which the container uses as it wants while the slot is live
+		// The container stores the slots, and gives access to them through slotAt(index)
+		template<class Slot, std::uint32_t Slot::*Link>
+		class GenerationalSlots
+		{
+		public:
+			static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+			// Number of slots ever taken, live or free
+			std::uint32_t count() const noexcept { return m_nCount; }
+
+			// True if there is no free slot, and nMaxSlots slots were taken
+			bool full(size_t nMaxSlots) const noexcept { return m_nFree == npos && m_nCount == nMaxSlots; }
+
+			// Takes a free slot, or slot count() if there is none, whose storage must exist. The slot is made live
+			template<class SlotAt>
+			std::uint32_t pop(SlotAt&& slotAt) noexcept
+			{
+				auto nSlot = m_nFree;
+				if (nSlot == npos)
+				{
+					nSlot = m_nCount++;
+					slotAt(nSlot).generation = 0;
+				}
+				else
+				{
+					m_nFree = slotAt(nSlot).*Link;
+				}
+
+				++slotAt(nSlot).generation;
+				return nSlot;
+			}
+
+			void push(Slot& slot, std::uint32_t nSlot) noexcept
+			{
+				// A slot whose generation wraps around is retired instead, since its next handles could match old ones
+				if (++slot.generation == 0) return;
+
+				slot.*Link = m_nFree;
+				m_nFree = nSlot;
+			}
+
+			template<class SlotAt>
+			bool contains(std::uint32_t nSlot, std::uint32_t nGeneration, SlotAt&& slotAt) const noexcept
+			{
+				return (nGeneration & 1) != 0 && nSlot < m_nCount && slotAt(nSlot).generation == nGeneration;
+			}
+
+		private:
+			std::uint32_t m_nCount{ 0 };
+			std::uint32_t m_nFree{ npos };
+		};
+
+		// Redirection entry of a CompactingAllocator handle
+		struct CompactingEntry
+		{
+			std::uint32_t offset; // Offset of the block header when the entry is live, next free entry otherwise
+			std::uint32_t length;
+			std::uint32_t generation; // Odd when the entry is live
+		};
+
+		// Size of the storage of a CompactingAllocator: the heap, followed by the redirection table
+		constexpr size_t CompactingStorageSize(size_t nHeapSize, size_t nMaxHandles)
+		{
+			return Math::RoundUpToMultipleOf(nHeapSize, alignof(CompactingEntry)) + nMaxHandles * sizeof(CompactingEntry);
+		}
+	}
+
+	// A heap of N bytes whose blocks are referred to by handles instead of pointers, so that it can move them
+	// over the holes left by deallocations
+	// The heap and the redirection table are allocated together on the Parent allocator on construction, or inline
+	// if Parent is void
+	// Blocks are bump allocated at the top of the heap, and only take the first hole big enough once the top is full
+	// compact moves live blocks down over the holes a few at a time, so that defragmentation can be spread over frames 
+	// within a budget of bytes moved or of time. Moves are recorded in a redirection table of MaxHandles entries, so 
+	// handles stay valid, but a block resolved to a pointer is only valid until the next compact
+	// When Parent is the PageAllocator, trim decommits the pages above the top of the heap, so that compacting lowers
+	// the resident memory. They are committed again when the top reaches them
+	// Blocks are moved with memmove, so they must only hold trivially relocatable objects
+	template<class Parent, size_t N, size_t MaxHandles = N / 64>
+	class CompactingAllocator : private Private::StackStorage<Private::CompactingStorageSize(N, MaxHandles), Parent>
+	{
+		static_assert(N > 0 && N < std::numeric_limits<std::uint32_t>::max(), "CompactingAllocator's size should be higher than 0 and fit in 32 bits");
+		static_assert(MaxHandles > 0 && MaxHandles < std::numeric_limits<std::uint32_t>::max(), "CompactingAllocator's MaxHandles should be higher than 0 and fit in 32 bits");
+		static_assert(MaxHandles <= (std::numeric_limits<size_t>::max() - N - alignof(Private::CompactingEntry)) / sizeof(Private::CompactingEntry), "CompactingAllocator's storage size should fit in size_t");
+
+		using Storage = Private::StackStorage<Private::CompactingStorageSize(N, MaxHandles), Parent>;
+
+		// Precedes every block, live or free
+		struct BlockHeader
+		{
+			std::uint32_t size; // Size of the block, header included
+			std::uint32_t entry; // Redirection entry of a live block, npos for a free block
+		};
+
+		static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+	public:
+		static constexpr size_t alignment = Math::Min(Storage::storage_alignment, sizeof(BlockHeader));
+
+		struct Handle
+		{
+			std::uint32_t index;
+			std::uint32_t generation;
+
+			bool isNull() const noexcept { return generation == 0; }
+		};
+
+		struct Fragmentation
+		{
+			size_t liveBytes; // Bytes in live blocks, headers included
+			size_t freeBytes; // Bytes in the holes below the top of the heap
+			size_t freeBlocks; // Number of holes, neighbour holes counting as one
+			size_t largestFreeBlock; // Largest contiguous free range, be it a hole or the top of the heap
+
+			// 0 when all the free memory is contiguous, and closer to 1 as it gets split in smaller holes
+			double ratio() const noexcept
+			{
+				auto const nTotal = N - liveBytes;
+				return nTotal == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeBlock) / nTotal;
+			}
+		};
+
+		// Returns a null handle on failure
+		Handle allocate(size_t n)
+		{
+			if (n == 0 || n > N - sizeof(BlockHeader) || !buffer()) return{ 0, 0 };
+			if (m_entryList.full(MaxHandles)) return{ 0, 0 };
+
+			auto const nSize = static_cast<std::uint32_t>(Math::RoundUpToMultipleOf(sizeof(BlockHeader) + n, sizeof(BlockHeader)));
+			auto nOffset = m_nTop;
+			if (nSize <= N - m_nTop)
+			{
+				if (!commitUpTo(m_nTop + nSize)) return{ 0, 0 };
+				headerAt(nOffset).size = nSize;
+				m_nTop += nSize;
+			}
+			else
+			{
+				nOffset = takeHole(nSize);
+				if (nOffset == npos) return{ 0, 0 };
+			}
+
+			auto const nEntry = m_entryList.pop(entryAccess());
+			auto& entry = entries()[nEntry];
+			entry.offset = nOffset;
+			entry.length = static_cast<std::uint32_t>(n);
+
+			auto& header = headerAt(nOffset);
+			header.entry = nEntry;
+			m_nLiveBytes += header.size;
+
+			return{ nEntry, entry.generation };
+		}
+
+		void deallocate(Handle h) noexcept
+		{
+			if (h.isNull()) return;
+			EXPECTS(contains(h));
+
+			auto const nOffset = entries()[h.index].offset;
+			auto& header = headerAt(nOffset);
+			header.entry = npos;
+			m_nLiveBytes -= header.size;
+			m_entryList.push(entries()[h.index], h.index);
+
+			if (nOffset + header.size == m_nTop)
+			{
+				m_nTop = nOffset;
+				if (m_nFreeBytes != 0) lowerTopOverHoles();
+				m_nCompacted = Math::Min(m_nCompacted, m_nTop);
+			}
+			else
+			{
+				m_nFreeBytes += header.size;
+				m_nCompacted = Math::Min(m_nCompacted, nOffset);
+			}
+		}
+
+		// Invalidates every handle, in O(MaxHandles)
+		void deallocateAll() noexcept
+		{
+			for (std::uint32_t i = 0; i < m_entryList.count(); ++i)
+			{
+				if (entries()[i].generation & 1) m_entryList.push(entries()[i], i);
+			}
+			m_nTop = 0;
+			m_nCompacted = 0;
+			m_nLiveBytes = 0;
+			m_nFreeBytes = 0;
+		}
+
+		bool contains(Handle h) const noexcept
+		{
+			return m_entryList.contains(h.index, h.generation, entryAccess());
+		}
+
+		// Returns the current location of the block, or a null block if the handle is not valid
+		// The pointer is invalidated by the next compact
+		Blk resolve(Handle h) const noexcept
+		{
+			if (!contains(h)) return{ nullptr, 0 };
+
+			auto const& entry = entries()[h.index];
+			return{ buffer() + entry.offset + sizeof(BlockHeader), entry.length };
+		}
+
+		// Moves live blocks over the holes until nMaxBytes were moved or the heap is compact, and returns the number of 
+		// bytes moved. At least one block is moved if there is a hole, even if it is bigger than nMaxBytes
+		size_t compact(size_t nMaxBytes = N) noexcept
+		{
+			size_t nMoved = 0;
+			while (!isCompact() && nMoved < nMaxBytes) nMoved += compactStep();
+			return nMoved;
+		}
+
+		// Same as compact, but stops once the time budget is spent, ex: what is left of the frame
+		template<class Rep, class Period>
+		size_t compactFor(std::chrono::duration<Rep, Period> budget) noexcept
+		{
+			auto const tDeadline = std::chrono::steady_clock::now() + budget;
+
+			size_t nMoved = 0;
+			while (!isCompact())
+			{
+				nMoved += compactStep();
+				if (std::chrono::steady_clock::now() >= tDeadline) break;
+			}
+			return nMoved;
+		}
+
+		// True if there is no hole below the top of the heap
+		bool isCompact() const noexcept { return m_nFreeBytes == 0; }
+
+		// Decommits the pages above the top of the heap if Parent is the PageAllocator, does nothing otherwise
+		// A last page that the heap shares with the redirection table is kept
+		void trim() noexcept
+		{
+			if (!page_backed || !buffer()) return;
+
+			auto const nPageSize = VirtualMemory::GetPageSize();
+			auto const nBegin = Math::RoundUpToMultipleOf(size_t{ m_nTop }, nPageSize);
+			auto const nEnd = Math::Min(size_t{ m_nCommitted }, N / nPageSize * nPageSize);
+			if (nBegin >= nEnd) return;
+
+			VirtualMemory::Decommit(buffer() + nBegin, nEnd - nBegin);
+			m_nCommitted = static_cast<std::uint32_t>(nBegin);
+		}
+
+		// Walks the heap, in O(blocks)
+		Fragmentation fragmentation() const noexcept
+		{
+			Fragmentation result{ m_nLiveBytes, m_nFreeBytes, 0, N - m_nTop };
+			auto nOffset = m_nCompacted;
+			while (nOffset < m_nTop)
+			{
+				if (headerAt(nOffset).entry != npos)
+				{
+					nOffset += headerAt(nOffset).size;
+					continue;
+				}
+
+				auto const nHoleEnd = holeEnd(nOffset);
+				++result.freeBlocks;
+				result.largestFreeBlock = Math::Max(result.largestFreeBlock, size_t{ nHoleEnd - nOffset });
+				nOffset = nHoleEnd;
+			}
+			return result;
+		}
+
+		// Bytes from the bottom to the top of the heap
+		size_t size() const noexcept { return m_nTop; }
+		static constexpr size_t capacity() noexcept { return N; }
+
+		// Bytes of the heap backed by memory, lower than the capacity after a trim
+		size_t committed() const noexcept { return m_nCommitted; }
+
+	private:
+		using Entry = Private::CompactingEntry;
+		using Storage::buffer;
+
+		static constexpr size_t entries_offset = Math::RoundUpToMultipleOf(N, alignof(Entry));
+		static constexpr bool page_backed = std::is_same<Parent, PageAllocator>::value;
+
+		Private::GenerationalSlots<Entry, &Entry::offset> m_entryList;
+		std::uint32_t m_nTop{ 0 };
+		std::uint32_t m_nCompacted{ 0 }; // There are no holes below this offset
+		std::uint32_t m_nCommitted{ N }; // Only lower than N after a trim
+		size_t m_nLiveBytes{ 0 };
+		size_t m_nFreeBytes{ 0 };
+
+		BlockHeader& headerAt(std::uint32_t nOffset) const noexcept
+		{
+			return *reinterpret_cast<BlockHeader*>(buffer() + nOffset);
+		}
+
+		Entry* entries() const noexcept
+		{
+			return reinterpret_cast<Entry*>(buffer() + entries_offset);
+		}
+
+		// Returns the end of the run of holes starting at nOffset
+		std::uint32_t holeEnd(std::uint32_t nOffset) const noexcept
+		{
+			while (nOffset < m_nTop && headerAt(nOffset).entry == npos) nOffset += headerAt(nOffset).size;
+			return nOffset;
+		}
+
+		// Commits the pages up to nEnd that a trim decommitted
+		bool commitUpTo(size_t nEnd) noexcept
+		{
+			if (nEnd <= m_nCommitted) return true;
+
+			auto const nPageSize = VirtualMemory::GetPageSize();
+			auto const nPagesEnd = N / nPageSize * nPageSize;
+			auto const nCommitted = Math::Min(Math::RoundUpToMultipleOf(nEnd, nPageSize), nPagesEnd);
+			if (nCommitted > m_nCommitted && !VirtualMemory::Commit(buffer() + m_nCommitted, nCommitted - m_nCommitted)) return false;
+
+			m_nCommitted = nCommitted == nPagesEnd ? std::uint32_t{ N } : static_cast<std::uint32_t>(nCommitted);
+			return true;
+		}
+
+		// The holes right below the top of the heap join it. Blocks can only be walked forward, so the last run of
+		// holes is found from the first hole
+		void lowerTopOverHoles() noexcept
+		{
+			auto nRun = npos;
+			for (auto nOffset = m_nCompacted; nOffset < m_nTop; nOffset += headerAt(nOffset).size)
+			{
+				if (headerAt(nOffset).entry != npos) nRun = npos;
+				else if (nRun == npos) nRun = nOffset;
+			}
+
+			if (nRun != npos)
+			{
+				m_nFreeBytes -= m_nTop - nRun;
+				m_nTop = nRun;
+			}
+		}
+
+		// Moves the first live block above the first hole to the start of the hole, or lowers the top of the heap
+		// if there is no live block above. Returns the number of bytes moved
+		size_t compactStep() noexcept
+		{
+			while (m_nCompacted < m_nTop && headerAt(m_nCompacted).entry != npos) m_nCompacted += headerAt(m_nCompacted).size;
+
+			auto const nHoleEnd = holeEnd(m_nCompacted);
+			auto const nHoleSize = nHoleEnd - m_nCompacted;
+			if (nHoleEnd == m_nTop)
+			{
+				m_nTop = m_nCompacted;
+				m_nFreeBytes -= nHoleSize;
+				return 0;
+			}
+
+			auto const header = headerAt(nHoleEnd);
+			std::memmove(buffer() + m_nCompacted, buffer() + nHoleEnd, header.size);
+			entries()[header.entry].offset = m_nCompacted;
+			m_nCompacted += header.size;
+			headerAt(m_nCompacted) = { nHoleSize, npos };
+			return header.size;
+		}
+
+		// First fit in the holes, merging the neighbour holes on the way
+		std::uint32_t takeHole(std::uint32_t nSize) noexcept
+		{
+			auto nOffset = m_nCompacted;
+			while (nOffset < m_nTop)
+			{
+				auto& header = headerAt(nOffset);
+				if (header.entry != npos)
+				{
+					nOffset += header.size;
+					continue;
+				}
+
+				header.size = holeEnd(nOffset) - nOffset;
+				if (header.size >= nSize)
+				{
+					// A remainder too small for a header stays in the block
+					if (header.size - nSize >= sizeof(BlockHeader))
+					{
+						headerAt(nOffset + nSize) = { header.size - nSize, npos };
+						header.size = nSize;
+					}
+					m_nFreeBytes -= header.size;
+					return nOffset;
+				}
+				nOffset += header.size;
+			}
+			return npos;
+		}
+
+		// Gives m_entryList access to the entries
+		auto entryAccess() const noexcept
+		{
+			return [this](std::uint32_t i) -> Entry& { return entries()[i]; };
+		}
+	};
+
+	template<class Parent, class PrefixType, class SuffixType>
+	class AffixAllocator;
+
+	namespace Private
+	{
+		template < class Parent, class PrefixType, class SuffixType, class Enable = void>
 		struct AffixParentImpl : protected Parent {	};
 
 		template < class Parent, class PrefixType, class SuffixType>
@@ -495,6 +1646,27 @@ namespace HE
 			Parent::deallocate(actualAllocation(b));
 		}
 
+		// Only supported without a suffix, which would have to be moved
+		template<class S = SuffixType, class = std::enable_if_t<std::is_void<S>::value>>
+		bool expand(Blk& b, size_t delta)
+		{
+			auto actual = actualAllocation(b);
+			if (!Private::Expand(static_cast<Parent&>(*this), actual, delta)) return false;
+
+			b.length += delta;
+			return true;
+		}
+
+		template<class S = SuffixType, class = std::enable_if_t<std::is_void<S>::value>>
+		bool reallocate(Blk& b, size_t n)
+		{
+			auto actual = actualAllocation(b);
+			if (!Private::Reallocate(static_cast<Parent&>(*this), actual, totalAllocationSize(n))) return false;
+
+			b = { static_cast<char*>(actual.ptr) + StateSize<PrefixType>::value, n };
+			return true;
+		}
+
 	private:
 		// Takes a requested allocation, and returns the actual allocation that was request to the parent
 		static Blk actualAllocation(Blk b)
@@ -555,12 +1727,30 @@ namespace HE
 
 		bool owns(Blk b)
 		{
-			return n <= Threshold ? SmallAllocator::owns(b) : LargeAllocator::owns(b);
+			return b.length <= Threshold ? SmallAllocator::owns(b) : LargeAllocator::owns(b);
 		}
 
 		void deallocate(Blk b)
 		{
-			return n <= Threshold ? SmallAllocator::deallocate(b) : LargeAllocator::deallocate(b);
+			return b.length <= Threshold ? SmallAllocator::deallocate(b) : LargeAllocator::deallocate(b);
+		}
+
+		bool expand(Blk& b, size_t delta)
+		{
+			if (b.length > Threshold) return Private::Expand(static_cast<LargeAllocator&>(*this), b, delta);
+			if (b.length + delta > Threshold) return false;
+			return Private::Expand(static_cast<SmallAllocator&>(*this), b, delta);
+		}
+
+		// A block whose size crosses the Threshold is moved from one allocator to the other
+		bool reallocate(Blk& b, size_t n)
+		{
+			auto& small = static_cast<SmallAllocator&>(*this);
+			auto& large = static_cast<LargeAllocator&>(*this);
+			if (b.length <= Threshold)
+				return n <= Threshold ? Private::Reallocate(small, b, n) : Private::MoveBlock(large, small, b, n);
+			else
+				return n > Threshold ? Private::Reallocate(large, b, n) : Private::MoveBlock(small, large, b, n);
 		}
 
 		void deallocateAll()
@@ -579,4 +1769,179 @@ namespace HE
 
 	template < size_t Threshold, class SmallAllocator, class LargeAllocator >
 	SegregateAllocator<Threshold, SmallAllocator, LargeAllocator> Private::SegregateAllocatorImpl<Threshold, SmallAllocator, LargeAllocator, Private::SegregateAllocatorStatelessCond<SmallAllocator, LargeAllocator>>::it;
+
+	namespace Private
+	{
+		template<class... Allocators>
+		struct MinAlignment;
+
+		template<class A>
+		struct MinAlignment<A> : std::integral_constant<size_t, A::alignment> {};
+
+		template<class A, class B, class... Rest>
+		struct MinAlignment<A, B, Rest...> : std::integral_constant<size_t, Math::Min(A::alignment, MinAlignment<B, Rest...>::value)> {};
+
+		// Size classes of Step bytes: class i handles sizes in (Min + i * Step, Min + (i + 1) * Step]
+		template<size_t Min, size_t Max, size_t Step>
+		struct LinearSizeClasses
+		{
+			static_assert(Step > 0, "Bucketizer's Step should be higher than 0");
+			static_assert(Max > Min && (Max - Min) % Step == 0, "Bucketizer's Max - Min should be a non-zero multiple of Step");
+
+			static constexpr size_t count = (Max - Min) / Step;
+			static constexpr size_t lower(size_t i) { return Min + i * Step + 1; }
+			static constexpr size_t upper(size_t i) { return Min + (i + 1) * Step; }
+
+			static bool inRange(size_t n) noexcept { return n > Min && n <= Max; }
+			static size_t index(size_t n) noexcept { return (n - Min - 1) / Step; }
+		};
+
+		// Power of 2 size classes: class i handles sizes in (Min * 2^i, Min * 2^(i + 1)]
+		template<size_t Min, size_t Max>
+		struct Pow2SizeClasses
+		{
+			static_assert(Math::IsPow2(Min) && Math::IsPow2(Max), "LogBucketizer's Min and Max should be powers of 2");
+			static_assert(Max > Min, "LogBucketizer's Max should be higher than Min");
+
+			static constexpr size_t count = Math::Log2(Max) - Math::Log2(Min);
+			static constexpr size_t lower(size_t i) { return (Min << i) + 1; }
+			static constexpr size_t upper(size_t i) { return Min << (i + 1); }
+
+			static bool inRange(size_t n) noexcept { return n > Min && n <= Max; }
+			static size_t index(size_t n) noexcept { return Math::CeilLog2(n) - Math::Log2(Min) - 1; }
+		};
+
+		template<template<size_t, size_t> class BucketAllocator, class SizeClasses, class Indices = std::make_index_sequence<SizeClasses::count>>
+		class BucketizerImpl;
+
+		// The bucket of a size is found with arithmetic on the size, then the call goes through a table of 
+		// function pointers indexed by bucket, so dispatch is O(1) no matter the number of buckets
+		template<template<size_t, size_t> class BucketAllocator, class SizeClasses, size_t... Is>
+		class BucketizerImpl<BucketAllocator, SizeClasses, std::index_sequence<Is...>>
+		{
+			template<size_t I>
+			using Bucket = BucketAllocator<SizeClasses::lower(I), SizeClasses::upper(I)>;
+			using Buckets = std::tuple<Bucket<Is>...>;
+
+		public:
+			static constexpr size_t alignment = MinAlignment<Bucket<Is>...>::value;
+			static constexpr size_t bucket_count = SizeClasses::count;
+
+			Blk allocate(size_t n)
+			{
+				using Fn = Blk(*)(Buckets&, size_t);
+				static constexpr Fn table[] = { &allocateBucket<Is>... };
+
+				if (!SizeClasses::inRange(n)) return{ nullptr, 0 };
+				return table[SizeClasses::index(n)](m_buckets, n);
+			}
+
+			template<class Dummy = void, class = std::enable_if_t<and_<std::is_void<Dummy>, is_aligned_allocator<Bucket<Is>>...>::value>>
+			Blk allocate(size_t n, size_t alignment_requirement)
+			{
+				using Fn = Blk(*)(Buckets&, size_t, size_t);
+				static constexpr Fn table[] = { &allocateAlignedBucket<Is>... };
+
+				EXPECTS(alignment_requirement >= alignment && Math::IsPow2(alignment_requirement));
+				if (!SizeClasses::inRange(n)) return{ nullptr, 0 };
+				return table[SizeClasses::index(n)](m_buckets, n, alignment_requirement);
+			}
+
+			void deallocate(Blk b) noexcept
+			{
+				using Fn = void(*)(Buckets&, Blk);
+				static constexpr Fn table[] = { &deallocateBucket<Is>... };
+
+				if (!b.ptr) return;
+				EXPECTS(SizeClasses::inRange(b.length));
+				table[SizeClasses::index(b.length)](m_buckets, b);
+			}
+
+			template<class Dummy = void, class = std::enable_if_t<and_<std::is_void<Dummy>, is_owning_allocator<Bucket<Is>>...>::value>>
+			bool owns(Blk b)
+			{
+				using Fn = bool(*)(Buckets&, Blk);
+				static constexpr Fn table[] = { &ownsBucket<Is>... };
+
+				return SizeClasses::inRange(b.length) && table[SizeClasses::index(b.length)](m_buckets, b);
+			}
+
+			template<class Dummy = void, class = std::enable_if_t<and_<std::is_void<Dummy>, has_op<Bucket<Is>, Private::try_deallocateAll>...>::value>>
+			void deallocateAll()
+			{
+				using swallow = int[];
+				(void)swallow{ 0, (std::get<Is>(m_buckets).deallocateAll(), 0)... };
+			}
+
+			// Only expands within the bucket of the block
+			bool expand(Blk& b, size_t delta)
+			{
+				using Fn = bool(*)(Buckets&, Blk&, size_t);
+				static constexpr Fn table[] = { &expandBucket<Is>... };
+
+				auto const n = b.length + delta;
+				if (!SizeClasses::inRange(n) || SizeClasses::index(n) != SizeClasses::index(b.length)) return false;
+				return table[SizeClasses::index(b.length)](m_buckets, b, delta);
+			}
+
+			// A block that changes size class is moved to the bucket of its new size
+			bool reallocate(Blk& b, size_t n)
+			{
+				using Fn = bool(*)(Buckets&, Blk&, size_t);
+				static constexpr Fn table[] = { &reallocateBucket<Is>... };
+
+				if (!SizeClasses::inRange(n)) return false;
+				if (SizeClasses::index(n) != SizeClasses::index(b.length)) return Private::MoveBlock(*this, *this, b, n);
+				return table[SizeClasses::index(n)](m_buckets, b, n);
+			}
+
+			// Index of the bucket handling allocations of size n, or bucket_count if none does
+			static size_t bucketIndex(size_t n) noexcept
+			{
+				return SizeClasses::inRange(n) ? SizeClasses::index(n) : bucket_count;
+			}
+
+		private:
+			template<size_t I>
+			static Blk allocateBucket(Buckets& buckets, size_t n) { return std::get<I>(buckets).allocate(n); }
+
+			template<size_t I>
+			static Blk allocateAlignedBucket(Buckets& buckets, size_t n, size_t a) { return std::get<I>(buckets).allocate(n, a); }
+
+			template<size_t I>
+			static void deallocateBucket(Buckets& buckets, Blk b) noexcept { std::get<I>(buckets).deallocate(b); }
+
+			template<size_t I>
+			static bool ownsBucket(Buckets& buckets, Blk b) { return std::get<I>(buckets).owns(b); }
+
+			template<size_t I>
+			static bool expandBucket(Buckets& buckets, Blk& b, size_t delta) { return Private::Expand(std::get<I>(buckets), b, delta); }
+
+			template<size_t I>
+			static bool reallocateBucket(Buckets& buckets, Blk& b, size_t n) { return Private::Reallocate(std::get<I>(buckets), b, n); }
+
+			Buckets m_buckets;
+		};
+	}
+
+	// Bucketizer
+	// Dispatches allocations of a size in (Min, Max] to one of (Max - Min) / Step allocators, each handling 
+	// a size class of Step bytes. BucketAllocator is an alias template taking the inclusive bounds of its size class, ex:
+	//   template<size_t BucketMin, size_t BucketMax> using Bucket = FreelistAllocator<MallocAllocator, BucketMin, BucketMax>;
+	//   Bucketizer<Bucket, 0, 256, 16> // 16 buckets, handling 1-16, 17-32, ..., 241-256
+	// Allocations out of (Min, Max] return a null block, so this is meant to be used under a SegregateAllocator or a FallbackAllocator
+	template<template<size_t, size_t> class BucketAllocator, size_t Min, size_t Max, size_t Step>
+	class Bucketizer : public Private::BucketizerImpl<BucketAllocator, Private::LinearSizeClasses<Min, Max, Step>>
+	{
+
+	};
+
+	// LogBucketizer
+	// Same as the Bucketizer, except the size classes grow in powers of 2: (Min, 2 * Min], (2 * Min, 4 * Min], ..., (Max / 2, Max]
+	// Trades some internal fragmentation for a lot fewer buckets over large size ranges
+	template<template<size_t, size_t> class BucketAllocator, size_t Min, size_t Max>
+	class LogBucketizer : public Private::BucketizerImpl<BucketAllocator, Private::Pow2SizeClasses<Min, Max>>
+	{
+
+	};
 }
\ No newline at end of file
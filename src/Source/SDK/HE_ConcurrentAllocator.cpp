@@ -0,0 +1,34 @@
+#include "HE_ConcurrentAllocator.h"
+
+#include <vector>
+
+namespace HE
+{
+	namespace Private
+	{
+		namespace
+		{
+			std::atomic<size_t> s_nNextThreadCacheSlot{ 0 };
+			thread_local std::vector<void*> t_threadCaches;
+		}
+
+		size_t AcquireThreadCacheSlot() noexcept
+		{
+			return s_nNextThreadCacheSlot.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void* FindThreadCache(size_t nSlot) noexcept
+		{
+			return nSlot < t_threadCaches.size() ? t_threadCaches[nSlot] : nullptr;
+		}
+
+		void SetThreadCache(size_t nSlot, void* pCache)
+		{
+			if (nSlot >= t_threadCaches.size())
+			{
+				t_threadCaches.resize(nSlot + 1, nullptr);
+			}
+			t_threadCaches[nSlot] = pCache;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,487 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+namespace HE
+{
+	namespace Private
+	{
+		// Every SharedAllocator gets a slot in the per-thread cache table on construction
+		// Slots are never reused, so SharedAllocators are meant to be few and long-lived
+		size_t AcquireThreadCacheSlot() noexcept;
+
+		// Returns the calling thread's cache for the slot, or a null pointer if the thread
+		// does not have one yet
+		void* FindThreadCache(size_t nSlot) noexcept;
+		void SetThreadCache(size_t nSlot, void* pCache);
+
+		// A pointer and a tag packed in 64 bits, so that both can be compare-and-swapped at once
+		// On 64-bit platforms, the pointer takes the 48 low bits (the size of user-space addresses) and the tag
+		// the 16 high bits. On 32-bit platforms, both take 32 bits
+		class TaggedPointer
+		{
+		public:
+			static constexpr int tag_shift = sizeof(void*) == 8 ? 48 : 32;
+			static constexpr std::uint64_t pointer_mask = (std::uint64_t{ 1 } << tag_shift) - 1;
+
+			constexpr TaggedPointer() noexcept : m_nValue{ 0 } {}
+			TaggedPointer(void* p, std::uint64_t nTag) noexcept
+				: m_nValue{ (static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p)) & pointer_mask) | (nTag << tag_shift) } {}
+
+			void* pointer() const noexcept { return reinterpret_cast<void*>(static_cast<std::uintptr_t>(m_nValue & pointer_mask)); }
+			std::uint64_t tag() const noexcept { return m_nValue >> tag_shift; }
+
+		private:
+			std::uint64_t m_nValue;
+		};
+	}
+
+	// An allocator that makes any Parent allocator usable from multiple threads
+	// Allocations in [MinSize, MaxSize] are served from a per-thread "magazine" of free nodes of MaxSize bytes
+	// without any lock. A node deallocated by the thread that allocated it goes back to that thread's magazine,
+	// while a node deallocated by another thread is pushed on a lock-free "remote free" list of its owning magazine,
+	// which the owning thread reclaims the next time its magazine is empty
+	// The Parent allocator is only used under a mutex: to refill a magazine with MagazineSize / 2 nodes,
+	// to flush half of a magazine holding more than 2 * MagazineSize nodes, and for out of range allocations
+	// Each node has a hidden prefix pointing to its owning magazine. The magazines themselves are allocated on the Parent,
+	// which throws std::bad_alloc if it fails. The magazines of threads that exited keep their nodes until the
+	// SharedAllocator is destroyed
+	template< class Parent,
+		size_t MinSize,
+		size_t MaxSize = MinSize,
+		size_t MagazineSize = 64,
+		class Enable = std::enable_if_t<is_allocator<Parent>::value>
+		>
+	class SharedAllocator
+		: private Parent
+	{
+		static_assert(MaxSize >= MinSize, "SharedAllocator's MaxSize should be higher or equal to MinSize");
+		static_assert(MaxSize >= sizeof(void*), "SharedAllocator's MaxSize should be higher or equal than sizeof(void*)");
+		static_assert(MagazineSize >= 2, "SharedAllocator's MagazineSize should be at least 2");
+
+	public:
+		static constexpr size_t alignment = Parent::alignment;
+
+		SharedAllocator() : m_nSlot{ Private::AcquireThreadCacheSlot() } {}
+		SharedAllocator(const SharedAllocator&) = delete;
+		void operator=(const SharedAllocator&) = delete;
+
+		// Returns the nodes cached in every magazine to the Parent
+		// Pre-condition: No other thread is using the allocator
+		~SharedAllocator()
+		{
+			auto pMagazine = m_pMagazines;
+			while (pMagazine)
+			{
+				releaseNodes(pMagazine->pLocal);
+				releaseNodes(pMagazine->pRemote.exchange(nullptr, std::memory_order_acquire));
+
+				auto const pNext = pMagazine->pNext;
+				pMagazine->~Magazine();
+				Parent::deallocate({ pMagazine, sizeof(Magazine) });
+				pMagazine = pNext;
+			}
+		}
+
+		Blk allocate(size_t n)
+		{
+			if (!inRange(n))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				return Parent::allocate(n);
+			}
+
+			auto& magazine = getMagazine();
+			if (!magazine.pLocal && !refill(magazine)) return{ nullptr, 0 };
+
+			auto const pNode = magazine.pLocal;
+			magazine.pLocal = pNode->next;
+			--magazine.nLocal;
+			return{ pNode, n };
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			if (!b.ptr) return;
+
+			if (!inRange(b.length))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				Parent::deallocate(b);
+				return;
+			}
+
+			auto const pNode = static_cast<Node*>(b.ptr);
+			auto const pOwner = owner(pNode);
+			if (pOwner == Private::FindThreadCache(m_nSlot))
+			{
+				pNode->next = pOwner->pLocal;
+				pOwner->pLocal = pNode;
+				if (++pOwner->nLocal > 2 * MagazineSize)
+				{
+					flush(*pOwner, MagazineSize);
+				}
+			}
+			else
+			{
+				// Only the owner takes nodes out of the remote list, and takes them all at once, so there is no ABA problem
+				auto pHead = pOwner->pRemote.load(std::memory_order_relaxed);
+				do
+				{
+					pNode->next = pHead;
+				} while (!pOwner->pRemote.compare_exchange_weak(pHead, pNode, std::memory_order_release, std::memory_order_relaxed));
+			}
+		}
+
+		template<class P = Parent, class = std::enable_if_t<is_owning_allocator<P>::value>>
+		bool owns(Blk b)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutParent };
+			return Parent::owns(inRange(b.length) ? actualAllocation(b.ptr) : b);
+		}
+
+		// Nodes have room for MaxSize bytes, so in range blocks can grow up to MaxSize in place
+		// Out of range blocks are expanded by the Parent, as long as they stay out of range
+		bool expand(Blk& b, size_t delta)
+		{
+			auto const n = b.length + delta;
+			if (inRange(b.length) != inRange(n)) return false;
+			if (!inRange(n))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				return Private::Expand(static_cast<Parent&>(*this), b, delta);
+			}
+
+			b.length = n;
+			return true;
+		}
+
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (inRange(b.length) != inRange(n)) return Private::MoveBlock(*this, *this, b, n);
+			if (!inRange(n))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				return Private::Reallocate(static_cast<Parent&>(*this), b, n);
+			}
+
+			b.length = n;
+			return true;
+		}
+
+	private:
+		struct Magazine;
+
+		struct Node
+		{
+			Node* next;
+		};
+
+		// Prefix of every node, keeping the alignment of the Parent for the node itself
+		static constexpr size_t node_prefix_size = Math::RoundUpToMultipleOf(sizeof(Magazine*), alignment);
+		static constexpr size_t node_allocation_size = node_prefix_size + MaxSize;
+
+		struct Magazine
+		{
+			// Only accessed by the owning thread
+			Node* pLocal{ nullptr };
+			size_t nLocal{ 0 };
+			char padding[PlatformCacheLineSize];
+			// Pushed on by other threads
+			std::atomic<Node*> pRemote{ nullptr };
+			// Accessed under the Parent mutex
+			Magazine* pNext{ nullptr };
+		};
+
+		size_t const m_nSlot;
+		std::mutex m_mutParent;
+		Magazine* m_pMagazines{ nullptr };
+
+		bool inRange(size_t n) const
+		{
+			if (MinSize == MaxSize) return n == MaxSize;
+
+			return (MinSize == 0 || n >= MinSize) && n <= MaxSize;
+		}
+
+		static Magazine*& owner(Node* pNode) noexcept
+		{
+			return *reinterpret_cast<Magazine**>(reinterpret_cast<char*>(pNode) - node_prefix_size);
+		}
+
+		static Blk actualAllocation(void* p) noexcept
+		{
+			return{ static_cast<char*>(p) - node_prefix_size, node_allocation_size };
+		}
+
+		Magazine& getMagazine()
+		{
+			auto pCache = Private::FindThreadCache(m_nSlot);
+			if (!pCache)
+			{
+				Magazine* pMagazine;
+				{
+					std::lock_guard<std::mutex> lock{ m_mutParent };
+					pMagazine = new (Private::AllocateFor<Magazine>(static_cast<Parent&>(*this), sizeof(Magazine)).ptr) Magazine;
+					pMagazine->pNext = m_pMagazines;
+					m_pMagazines = pMagazine;
+				}
+				Private::SetThreadCache(m_nSlot, pMagazine);
+				pCache = pMagazine;
+			}
+			return *static_cast<Magazine*>(pCache);
+		}
+
+		// Reclaims the nodes deallocated by other threads, or allocates new nodes on the Parent if there are none
+		bool refill(Magazine& magazine)
+		{
+			auto pRemote = magazine.pRemote.exchange(nullptr, std::memory_order_acquire);
+			if (pRemote)
+			{
+				magazine.pLocal = pRemote;
+				for (; pRemote; pRemote = pRemote->next)
+				{
+					++magazine.nLocal;
+				}
+				return true;
+			}
+
+			std::lock_guard<std::mutex> lock{ m_mutParent };
+			for (size_t i = 0; i < MagazineSize / 2; ++i)
+			{
+				auto const b = Parent::allocate(node_allocation_size);
+				if (!b.ptr) break;
+
+				auto const pNode = reinterpret_cast<Node*>(static_cast<char*>(b.ptr) + node_prefix_size);
+				owner(pNode) = &magazine;
+				pNode->next = magazine.pLocal;
+				magazine.pLocal = pNode;
+				++magazine.nLocal;
+			}
+			return magazine.pLocal != nullptr;
+		}
+
+		void flush(Magazine& magazine, size_t nCount) noexcept
+		{
+			std::lock_guard<std::mutex> lock{ m_mutParent };
+			for (size_t i = 0; i < nCount && magazine.pLocal; ++i)
+			{
+				auto const pNode = magazine.pLocal;
+				magazine.pLocal = pNode->next;
+				--magazine.nLocal;
+				Parent::deallocate(actualAllocation(pNode));
+			}
+		}
+
+		void releaseNodes(Node* pNode) noexcept
+		{
+			while (pNode)
+			{
+				auto const pNext = pNode->next;
+				Parent::deallocate(actualAllocation(pNode));
+				pNode = pNext;
+			}
+		}
+	};
+
+	// A FreelistAllocator whose freelist can be pushed to and popped from by any number of threads without a lock
+	// The head of the freelist is a tagged pointer, whose tag is incremented on every change, so that a compare-and-swap
+	// fails if the head was popped and pushed back in the meantime (ABA problem)
+	// The Parent allocator is only used under a mutex: for out of range allocations, misses of the freelist, and
+	// nodes deallocated past MaxNodes
+	// Important: Popping may read the "next" link of a node that another thread popped concurrently, and that may since
+	// have been deallocated to the Parent past MaxNodes. The tag makes the compare-and-swap fail so the value read is
+	// discarded, but the memory has to stay mapped: the Parent must never unmap the memory of in range blocks while the
+	// freelist is in use. Heap allocators like the MallocAllocator, and allocators that keep their memory until they are
+	// destroyed or trimmed like the StackAllocator or the VirtualRegionAllocator, are fine. The PageAllocator is only
+	// fine with an unbounded MaxNodes, since in range blocks then only go back to the Parent on deallocateAll
+	// The parameters are in the same order as FreelistAllocator's, but batches are not supported: BatchCount must be 1
+	template< class Parent,
+		size_t MinSize,
+		size_t MaxSize = MinSize,
+		size_t BatchCount = 1,
+		size_t MaxNodes = Allocator::unbounded,
+		class Enable = std::enable_if_t<is_allocator<Parent>::value>
+		>
+	class ConcurrentFreelistAllocator
+		: private Parent
+	{
+		static_assert(MaxSize >= MinSize, "ConcurrentFreelistAllocator's MaxSize should be higher or equal to MinSize");
+		static_assert(MaxSize >= sizeof(void*), "ConcurrentFreelistAllocator's MaxSize and MinSize should be higher or equal than sizeof(void*)");
+		static_assert(BatchCount == 1, "ConcurrentFreelistAllocator does not support batches, its BatchCount should be 1");
+
+	public:
+		static constexpr size_t alignment = Parent::alignment;
+
+		ConcurrentFreelistAllocator() = default;
+		ConcurrentFreelistAllocator(const ConcurrentFreelistAllocator&) = delete;
+		void operator=(const ConcurrentFreelistAllocator&) = delete;
+
+		Blk allocate(size_t n)
+		{
+			return allocateImpl(n);
+		}
+
+		template<class P = Parent, class = std::enable_if_t<is_aligned_allocator<P>::value>>
+		Blk allocate(size_t n, size_t alignment)
+		{
+			return allocateImpl(n, alignment);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			if (b.ptr && inRange(b.length) && reserveNode())
+			{
+				push(static_cast<Node*>(b.ptr));
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				Parent::deallocate(b);
+			}
+		}
+
+		// Only O(1) if the Parent allocator supports deallocateAll
+		// Otherwise, the nodes in the freelist are deallocated in O(n)
+		// Pre-condition: No other thread is using the allocator
+		void deallocateAll() noexcept
+		{
+			deallocateAllImpl(std::integral_constant<bool, has_fast_deallocateAll()>{});
+			m_head.store(Private::TaggedPointer{}, std::memory_order_relaxed);
+			m_nNodesCount.store(0, std::memory_order_relaxed);
+		}
+
+		static constexpr bool has_fast_deallocateAll() { return has_op<Parent, Private::try_deallocateAll>::value; }
+
+		template<class P = Parent, class = std::enable_if_t<is_owning_allocator<P>::value>>
+		bool owns(Blk b)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutParent };
+			return Parent::owns(b);
+		}
+
+		// Nodes have room for MaxSize bytes, so in range blocks can grow up to MaxSize in place
+		// Out of range blocks are expanded by the Parent, as long as they stay out of range
+		bool expand(Blk& b, size_t delta)
+		{
+			auto const n = b.length + delta;
+			if (inRange(b.length) != inRange(n)) return false;
+			if (!inRange(n))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				return Private::Expand(static_cast<Parent&>(*this), b, delta);
+			}
+
+			b.length = n;
+			return true;
+		}
+
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (inRange(b.length) != inRange(n)) return Private::MoveBlock(*this, *this, b, n);
+			if (!inRange(n))
+			{
+				std::lock_guard<std::mutex> lock{ m_mutParent };
+				return Private::Reallocate(static_cast<Parent&>(*this), b, n);
+			}
+
+			b.length = n;
+			return true;
+		}
+
+	private:
+		struct Node
+		{
+			std::atomic<Node*> next;
+		};
+
+		std::atomic<Private::TaggedPointer> m_head{ Private::TaggedPointer{} };
+		std::atomic<size_t> m_nNodesCount{ 0 };
+		std::mutex m_mutParent;
+
+		bool inRange(size_t n) const
+		{
+			if (MinSize == MaxSize) return n == MaxSize;
+
+			return (MinSize == 0 || n >= MinSize) && n <= MaxSize;
+		}
+
+		// Counts a node about to be pushed, unless the freelist already holds MaxNodes nodes
+		bool reserveNode() noexcept
+		{
+			if (MaxNodes == Allocator::unbounded)
+			{
+				m_nNodesCount.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			auto nCount = m_nNodesCount.load(std::memory_order_relaxed);
+			do
+			{
+				if (nCount >= MaxNodes) return false;
+			} while (!m_nNodesCount.compare_exchange_weak(nCount, nCount + 1, std::memory_order_relaxed));
+			return true;
+		}
+
+		void push(Node* pNode) noexcept
+		{
+			auto head = m_head.load(std::memory_order_relaxed);
+			Private::TaggedPointer newHead;
+			do
+			{
+				pNode->next.store(static_cast<Node*>(head.pointer()), std::memory_order_relaxed);
+				newHead = Private::TaggedPointer{ pNode, head.tag() + 1 };
+			} while (!m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		Node* pop() noexcept
+		{
+			auto head = m_head.load(std::memory_order_acquire);
+			while (auto const pNode = static_cast<Node*>(head.pointer()))
+			{
+				auto const pNext = pNode->next.load(std::memory_order_relaxed);
+				if (m_head.compare_exchange_weak(head, Private::TaggedPointer{ pNext, head.tag() + 1 }, std::memory_order_acquire, std::memory_order_acquire))
+				{
+					m_nNodesCount.fetch_sub(1, std::memory_order_relaxed);
+					return pNode;
+				}
+			}
+			return nullptr;
+		}
+
+		template<class... Args>
+		Blk allocateImpl(size_t n, Args... args)
+		{
+			if (inRange(n))
+			{
+				if (auto const pNode = pop()) return{ pNode, n };
+			}
+
+			std::lock_guard<std::mutex> lock{ m_mutParent };
+			if (!inRange(n)) return Parent::allocate(n, args...);
+
+			auto const b = Parent::allocate(MaxSize, args...);
+			return{ b.ptr, n };
+		}
+
+		void deallocateAllImpl(std::true_type) noexcept
+		{
+			Parent::deallocateAll();
+		}
+
+		void deallocateAllImpl(std::false_type) noexcept
+		{
+			auto pNode = static_cast<Node*>(m_head.load(std::memory_order_acquire).pointer());
+			while (pNode)
+			{
+				auto const pNext = pNode->next.load(std::memory_order_relaxed);
+				Parent::deallocate({ pNode, MaxSize });
+				pNode = pNext;
+			}
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,420 @@
+#pragma once
+
+#include "HE_Allocator.h"
+#include "HE_Math.h"
+#include "HE_Platform.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(PLATFORM_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace HE
+{
+	namespace Private
+	{
+		// Control byte of a slot of a FlatHashMap: the low 7 bits of the hash of a full slot, or empty
+		using HashControl = std::uint8_t;
+		constexpr HashControl hash_control_empty = 0x80;
+
+		// A window of 16 control bytes, compared in one instruction with SSE2
+		class HashGroup
+		{
+		public:
+			static constexpr size_t width = 16;
+
+			explicit HashGroup(const HashControl* pControl) noexcept
+			{
+#if defined(PLATFORM_SSE2)
+				m_controls = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pControl));
+#else
+				std::memcpy(m_controls, pControl, width);
+#endif
+			}
+
+			// Bit i is set if the control i is c
+			std::uint32_t match(HashControl c) const noexcept
+			{
+#if defined(PLATFORM_SSE2)
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_controls, _mm_set1_epi8(static_cast<char>(c)))));
+#else
+				std::uint32_t nMask = 0;
+				for (size_t i = 0; i < width; ++i) nMask |= std::uint32_t{ m_controls[i] == c } << i;
+				return nMask;
+#endif
+			}
+
+			std::uint32_t matchEmpty() const noexcept
+			{
+#if defined(PLATFORM_SSE2)
+				// Only the empty control has its high bit set
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(m_controls));
+#else
+				return match(hash_control_empty);
+#endif
+			}
+
+		private:
+#if defined(PLATFORM_SSE2)
+			__m128i m_controls;
+#else
+			HashControl m_controls[width];
+#endif
+		};
+	}
+
+	// An open addressing hash map, storing its entries in a single array allocated on the Allocator
+	// A slot is found by linear probing from the position given by the hash, comparing a group of 16 control bytes
+	// (7 bits of the hash of each slot) at a time, so that most keys that don't match are rejected without touching
+	// the entries. A lookup stops at the first empty slot
+	// Erasing shifts the following entries of the probe sequence back instead of leaving a tombstone, so lookups
+	// never slow down after many erasures
+	// Entries move on rehash and on erase, which invalidates iterators and references
+	// The hash is mixed before use, so an identity hash (ex: std::hash of an integer) is fine
+	// Entries are moved as std::pair<const K, V>, which copies the key: K must be nothrow copy constructible and V
+	// nothrow move constructible, since entries are moved without a way to roll back
+	// Insertions and reserve throw std::bad_alloc when the table can't grow
+	template<class K, class V, class Hash = std::hash<K>, class Allocator = MallocAllocator, class KeyEqual = std::equal_to<K>>
+	class FlatHashMap : private Allocator
+	{
+		static_assert(IsAllocator<Allocator>(), "FlatHashMap's Allocator does not meet the HE::Allocator concept");
+		static_assert(std::is_nothrow_move_constructible<std::pair<const K, V>>::value, "FlatHashMap's K should be nothrow copy constructible and V nothrow move constructible");
+
+		using Control = Private::HashControl;
+		using Group = Private::HashGroup;
+		static constexpr Control empty_control = Private::hash_control_empty;
+
+		template<bool Const>
+		class Iterator;
+
+	public:
+		using key_type = K;
+		using mapped_type = V;
+		using value_type = std::pair<const K, V>;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		FlatHashMap() = default;
+		FlatHashMap(const FlatHashMap&) = delete;
+		FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+		~FlatHashMap()
+		{
+			clear();
+			release();
+		}
+
+		// Inserts V(args...) if the key is not in the map. Returns the entry of the key, and whether it was inserted
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+		{
+			auto const nHash = hash(key);
+			auto const result = find(key, nHash);
+			if (result.second) return{ iteratorAt(result.first), false };
+
+			if (m_nSize + 1 > maxLoad(m_nCapacity))
+			{
+				// The key and the arguments may refer to an entry moved by the rehash, so the new entry is built before
+				value_type entry(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+				rehash(m_nCapacity == 0 ? Group::width : 2 * m_nCapacity);
+				auto const i = findEmpty(nHash);
+				new (m_pEntries + i) value_type(std::move(entry));
+				setControl(i, control(nHash));
+				++m_nSize;
+				return{ iteratorAt(i), true };
+			}
+
+			return{ iteratorAt(emplaceAt(result.first, nHash, key, std::forward<Args>(args)...)), true };
+		}
+
+		std::pair<iterator, bool> insert(const value_type& value)
+		{
+			return try_emplace(value.first, value.second);
+		}
+
+		// Inserts or assigns
+		template<class T>
+		std::pair<iterator, bool> insert_or_assign(const K& key, T&& value)
+		{
+			auto result = try_emplace(key, std::forward<T>(value));
+			if (!result.second) result.first->second = std::forward<T>(value);
+			return result;
+		}
+
+		V& operator[](const K& key)
+		{
+			return try_emplace(key).first->second;
+		}
+
+		iterator find(const K& key) noexcept
+		{
+			auto const result = find(key, hash(key));
+			return result.second ? iteratorAt(result.first) : end();
+		}
+
+		const_iterator find(const K& key) const noexcept
+		{
+			auto const result = find(key, hash(key));
+			return result.second ? const_iterator{ m_pControls + result.first, m_pEntries + result.first, m_pControls + m_nCapacity } : end();
+		}
+
+		bool contains(const K& key) const noexcept
+		{
+			return find(key, hash(key)).second;
+		}
+
+		size_t count(const K& key) const noexcept
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		// Returns the number of erased entries
+		size_t erase(const K& key)
+		{
+			auto const result = find(key, hash(key));
+			if (!result.second) return 0;
+
+			eraseAt(result.first);
+			return 1;
+		}
+
+		void clear() noexcept
+		{
+			for (size_t i = 0; i < m_nCapacity; ++i)
+			{
+				if (m_pControls[i] != empty_control)
+				{
+					m_pEntries[i].~value_type();
+					setControl(i, empty_control);
+				}
+			}
+			m_nSize = 0;
+		}
+
+		// Allocates room for n entries
+		void reserve(size_t n)
+		{
+			auto nCapacity = Math::Max(m_nCapacity, Group::width);
+			while (maxLoad(nCapacity) < n) nCapacity *= 2;
+			if (nCapacity != m_nCapacity) rehash(nCapacity);
+		}
+
+		iterator begin() noexcept { return iterator{ m_pControls, m_pEntries, m_pControls + m_nCapacity }.skipEmpty(); }
+		iterator end() noexcept { return{ m_pControls + m_nCapacity, m_pEntries + m_nCapacity, m_pControls + m_nCapacity }; }
+		const_iterator begin() const noexcept { return const_iterator{ m_pControls, m_pEntries, m_pControls + m_nCapacity }.skipEmpty(); }
+		const_iterator end() const noexcept { return{ m_pControls + m_nCapacity, m_pEntries + m_nCapacity, m_pControls + m_nCapacity }; }
+
+		size_t size() const noexcept { return m_nSize; }
+		bool empty() const noexcept { return m_nSize == 0; }
+		size_t capacity() const noexcept { return m_nCapacity; }
+		float load_factor() const noexcept { return m_nCapacity == 0 ? 0.f : static_cast<float>(m_nSize) / m_nCapacity; }
+
+	private:
+		// The control bytes of the first group are mirrored after the last slot, so that a group can be loaded from any slot
+		static constexpr size_t cloned_controls = Group::width - 1;
+
+		Blk m_block{ nullptr, 0 };
+		Control* m_pControls{ nullptr };
+		value_type* m_pEntries{ nullptr };
+		size_t m_nCapacity{ 0 };
+		size_t m_nSize{ 0 };
+
+		// Linear probing degrades quickly when the table gets full, so it is kept under 7/8
+		static size_t maxLoad(size_t nCapacity) noexcept { return nCapacity - nCapacity / 8; }
+
+		static size_t hash(const K& key) noexcept
+		{
+			// Fibonacci hashing spreads the bits of weak hashes, the high bits giving the position and the low 7 the control
+			auto const nHash = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(nHash ^ (nHash >> 32));
+		}
+
+		static Control control(size_t nHash) noexcept { return static_cast<Control>(nHash & 0x7F); }
+		size_t home(size_t nHash) const noexcept { return (nHash >> 7) & (m_nCapacity - 1); }
+
+		iterator iteratorAt(size_t i) noexcept { return{ m_pControls + i, m_pEntries + i, m_pControls + m_nCapacity }; }
+
+		void setControl(size_t i, Control c) noexcept
+		{
+			m_pControls[i] = c;
+			if (i < cloned_controls) m_pControls[m_nCapacity + i] = c;
+		}
+
+		// Returns the slot of the key and true if it is in the map, or the slot where it would be inserted and false otherwise
+		std::pair<size_t, bool> find(const K& key, size_t nHash) const noexcept
+		{
+			if (m_nCapacity == 0) return{ 0, false };
+
+			auto const nMask = m_nCapacity - 1;
+			auto const c = control(nHash);
+			auto nPosition = home(nHash);
+			for (;;)
+			{
+				Group const group{ m_pControls + nPosition };
+				for (auto nMatches = group.match(c); nMatches != 0; nMatches &= nMatches - 1)
+				{
+					auto const i = (nPosition + Math::CountTrailingZeros(nMatches)) & nMask;
+					if (KeyEqual{}(m_pEntries[i].first, key)) return{ i, true };
+				}
+
+				// Every key of the probe sequence is before its first empty slot
+				auto const nEmpty = group.matchEmpty();
+				if (nEmpty != 0) return{ (nPosition + Math::CountTrailingZeros(nEmpty)) & nMask, false };
+
+				nPosition = (nPosition + Group::width) & nMask;
+			}
+		}
+
+		size_t findEmpty(size_t nHash) const noexcept
+		{
+			auto const nMask = m_nCapacity - 1;
+			auto nPosition = home(nHash);
+			for (;;)
+			{
+				auto const nEmpty = Group{ m_pControls + nPosition }.matchEmpty();
+				if (nEmpty != 0) return (nPosition + Math::CountTrailingZeros(nEmpty)) & nMask;
+
+				nPosition = (nPosition + Group::width) & nMask;
+			}
+		}
+
+		template<class... Args>
+		size_t emplaceAt(size_t i, size_t nHash, const K& key, Args&&... args)
+		{
+			new (m_pEntries + i) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			setControl(i, control(nHash));
+			++m_nSize;
+			return i;
+		}
+
+		static void relocate(value_type* pDestination, value_type* pSource) noexcept
+		{
+			new (pDestination) value_type(std::move(*pSource));
+			pSource->~value_type();
+		}
+
+		// Backward shift deletion: the following entries of the probe sequence move back into the hole, as long as it
+		// does not take them before their home slot
+		void eraseAt(size_t i) noexcept
+		{
+			auto const nMask = m_nCapacity - 1;
+			m_pEntries[i].~value_type();
+			--m_nSize;
+
+			for (auto j = (i + 1) & nMask; m_pControls[j] != empty_control; j = (j + 1) & nMask)
+			{
+				auto const nHome = home(hash(m_pEntries[j].first));
+				if (((j - nHome) & nMask) < ((j - i) & nMask)) continue;
+
+				relocate(m_pEntries + i, m_pEntries + j);
+				setControl(i, m_pControls[j]);
+				i = j;
+			}
+			setControl(i, empty_control);
+		}
+
+		void rehash(size_t nCapacity)
+		{
+			auto const nEntriesOffset = Math::RoundUpToMultipleOf(nCapacity + cloned_controls, alignof(value_type));
+			auto const nBytes = nEntriesOffset + nCapacity * sizeof(value_type);
+			auto const b = Private::AllocateFor<value_type>(static_cast<Allocator&>(*this), nBytes);
+
+			auto const pOldControls = m_pControls;
+			auto const pOldEntries = m_pEntries;
+			auto const nOldCapacity = m_nCapacity;
+			auto const oldBlock = m_block;
+
+			m_block = b;
+			m_pControls = static_cast<Control*>(b.ptr);
+			m_pEntries = reinterpret_cast<value_type*>(static_cast<char*>(b.ptr) + nEntriesOffset);
+			m_nCapacity = nCapacity;
+			std::memset(m_pControls, empty_control, nCapacity + cloned_controls);
+
+			for (size_t i = 0; i < nOldCapacity; ++i)
+			{
+				if (pOldControls[i] == empty_control) continue;
+
+				auto const nHash = hash(pOldEntries[i].first);
+				auto const j = findEmpty(nHash);
+				relocate(m_pEntries + j, pOldEntries + i);
+				setControl(j, control(nHash));
+			}
+
+			if (oldBlock.ptr) Allocator::deallocate(oldBlock);
+		}
+
+		void release() noexcept
+		{
+			if (m_block.ptr) Allocator::deallocate(m_block);
+		}
+	};
+
+	template<class K, class V, class Hash, class Allocator, class KeyEqual>
+	template<bool Const>
+	class FlatHashMap<K, V, Hash, Allocator, KeyEqual>::Iterator
+	{
+		using Entry = std::conditional_t<Const, const typename FlatHashMap::value_type, typename FlatHashMap::value_type>;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename FlatHashMap::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Entry*;
+		using reference = Entry&;
+
+		Iterator() noexcept = default;
+
+		Iterator(const Control* pControl, Entry* pEntry, const Control* pEnd) noexcept : m_pControl{ pControl }, m_pEntry{ pEntry }, m_pEnd{ pEnd } {}
+
+		template<bool C = Const, class = std::enable_if_t<C>>
+		Iterator(const Iterator<false>& other) noexcept : m_pControl{ other.m_pControl }, m_pEntry{ other.m_pEntry }, m_pEnd{ other.m_pEnd } {}
+
+		reference operator*() const noexcept { return *m_pEntry; }
+		pointer operator->() const noexcept { return m_pEntry; }
+
+		Iterator& operator++() noexcept
+		{
+			++m_pControl;
+			++m_pEntry;
+			return skipEmpty();
+		}
+
+		Iterator operator++(int) noexcept
+		{
+			auto const copy = *this;
+			++*this;
+			return copy;
+		}
+
+		bool operator==(const Iterator& rhs) const noexcept { return m_pControl == rhs.m_pControl; }
+		bool operator!=(const Iterator& rhs) const noexcept { return m_pControl != rhs.m_pControl; }
+
+	private:
+		friend class FlatHashMap;
+		template<bool> friend class Iterator;
+
+		const Control* m_pControl{ nullptr };
+		Entry* m_pEntry{ nullptr };
+		const Control* m_pEnd{ nullptr };
+
+		// Moves to the next full slot
+		Iterator& skipEmpty() noexcept
+		{
+			while (m_pControl != m_pEnd && *m_pControl == empty_control)
+			{
+				++m_pControl;
+				++m_pEntry;
+			}
+			return *this;
+		}
+	};
+}
\ No newline at end of file
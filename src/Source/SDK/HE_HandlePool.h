@@ -0,0 +1,336 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+
+namespace HE
+{
+	// A reference to an object of a HandlePool<T>: the index of a slot, and the generation of the slot when the object was inserted
+	// Erasing the object changes the generation of its slot, so the pool rejects the handle even after the slot is reused
+	// Default constructed handles are null, and never refer to an object
+	template<class T>
+	struct Handle
+	{
+		std::uint32_t index{ 0 };
+		std::uint32_t generation{ 0 };
+
+		constexpr bool isNull() const noexcept { return generation == 0; }
+
+		// Packs the handle in 64 bits, ex: to store it in a user data pointer
+		constexpr std::uint64_t value() const noexcept { return (std::uint64_t{ generation } << 32) | index; }
+		static constexpr Handle fromValue(std::uint64_t v) noexcept { return{ static_cast<std::uint32_t>(v), static_cast<std::uint32_t>(v >> 32) }; }
+	};
+
+	template<class T>
+	constexpr bool operator==(Handle<T> lhs, Handle<T> rhs) noexcept
+	{
+		return lhs.index == rhs.index && lhs.generation == rhs.generation;
+	}
+
+	template<class T>
+	constexpr bool operator!=(Handle<T> lhs, Handle<T> rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+	// A container of T that hands out generational handles instead of pointers (a "slot map")
+	// The objects are kept densely packed in pages of PageSize objects: erasing an object moves the last one in its place,
+	// so iteration never skips holes. A handle goes to its object through its slot, which holds the current dense index
+	// of the object, so insertion, erasure and lookup are O(1), with no allocation per object
+	// Pages and page tables are allocated on the Allocator, and are only returned to it on destruction
+	// Objects move when another object is erased, so pointers to them are only stable until the next erase
+	// emplace and reserve throw std::bad_alloc when a page can't be allocated
+	template<class T, class Allocator = MallocAllocator, size_t PageSize = 256>
+	class HandlePool : private Allocator
+	{
+		static_assert(IsAllocator<Allocator>(), "HandlePool's Allocator does not meet the HE::Allocator concept");
+		static_assert(Math::IsPow2(PageSize), "HandlePool's PageSize should be a power of 2");
+
+		template<bool Const>
+		class Iterator;
+
+	public:
+		using value_type = T;
+		using handle_type = Handle<T>;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		HandlePool() = default;
+		HandlePool(const HandlePool&) = delete;
+		HandlePool& operator=(const HandlePool&) = delete;
+
+		~HandlePool()
+		{
+			destroyValues();
+			m_values.release(allocator(), value_page_size);
+			m_slots.release(allocator(), slot_page_size);
+		}
+
+		template<class... Args>
+		handle_type emplace(Args&&... args)
+		{
+			if (m_nSize == max_size()) throw std::length_error{ "HandlePool is full" };
+
+			// Everything that can fail is done before the object is constructed, and nothing is committed after, so that
+			// a failure leaves the pool untouched
+			if (m_nSize == m_values.count * PageSize) addValuePage();
+			if (m_slotList.full(m_slots.count * PageSize)) addSlotPage();
+
+			new (&valueAt(m_nSize)) T(std::forward<Args>(args)...);
+
+			auto const nSlot = m_slotList.pop(slotAccess());
+			auto& slot = slotAt(nSlot);
+			slot.dense = m_nSize;
+			slotIndexAt(m_nSize) = nSlot;
+			++m_nSize;
+
+			return{ nSlot, slot.generation };
+		}
+
+		handle_type insert(const T& value)
+		{
+			return emplace(value);
+		}
+
+		handle_type insert(T&& value)
+		{
+			return emplace(std::move(value));
+		}
+
+		// Returns false if the handle does not refer to an object of the pool
+		bool erase(handle_type h)
+		{
+			if (!contains(h)) return false;
+
+			auto const nDense = slotAt(h.index).dense;
+			auto const nLast = m_nSize - 1;
+			if (nDense != nLast)
+			{
+				valueAt(nDense) = std::move(valueAt(nLast));
+				auto const nMovedSlot = slotIndexAt(nLast);
+				slotIndexAt(nDense) = nMovedSlot;
+				slotAt(nMovedSlot).dense = nDense;
+			}
+			valueAt(nLast).~T();
+			--m_nSize;
+
+			m_slotList.push(slotAt(h.index), h.index);
+			return true;
+		}
+
+		// Erases every object, invalidating every handle
+		void clear() noexcept
+		{
+			destroyValues();
+			m_nSize = 0;
+		}
+
+		// Allocates the pages for n objects
+		void reserve(size_t n)
+		{
+			if (n > max_size()) throw std::length_error{ "HandlePool cannot hold that many objects" };
+
+			while (m_values.count * PageSize < n) addValuePage();
+			while (m_slots.count * PageSize < n) addSlotPage();
+		}
+
+		bool contains(handle_type h) const noexcept
+		{
+			return m_slotList.contains(h.index, h.generation, slotAccess());
+		}
+
+		// Returns nullptr if the handle does not refer to an object of the pool
+		T* get(handle_type h) noexcept
+		{
+			return contains(h) ? &valueAt(slotAt(h.index).dense) : nullptr;
+		}
+
+		const T* get(handle_type h) const noexcept
+		{
+			return contains(h) ? &valueAt(slotAt(h.index).dense) : nullptr;
+		}
+
+		T& operator[](handle_type h) noexcept
+		{
+			EXPECTS(contains(h));
+			return valueAt(slotAt(h.index).dense);
+		}
+
+		const T& operator[](handle_type h) const noexcept
+		{
+			EXPECTS(contains(h));
+			return valueAt(slotAt(h.index).dense);
+		}
+
+		// Returns the handle of the i-th object in iteration order
+		handle_type handleAt(size_t i) const noexcept
+		{
+			EXPECTS(i < m_nSize);
+			auto const nSlot = slotIndexAt(i);
+			return{ nSlot, slotAt(nSlot).generation };
+		}
+
+		iterator begin() noexcept { return{ this, 0 }; }
+		iterator end() noexcept { return{ this, m_nSize }; }
+		const_iterator begin() const noexcept { return{ this, 0 }; }
+		const_iterator end() const noexcept { return{ this, m_nSize }; }
+
+		size_t size() const noexcept { return m_nSize; }
+		bool empty() const noexcept { return m_nSize == 0; }
+		size_t capacity() const noexcept { return m_values.count * PageSize; }
+
+		Allocator& allocator() noexcept { return *this; }
+		const Allocator& allocator() const noexcept { return *this; }
+
+		// The last index is kept free to mark the end of the freelist
+		static constexpr size_t max_size() noexcept { return npos; }
+
+	private:
+		struct Slot
+		{
+			// Index of the object when the slot is live, index of the next free slot otherwise
+			std::uint32_t dense;
+			// Odd when the slot is live
+			std::uint32_t generation;
+		};
+
+		// An array of pages, grown geometrically
+		struct PageTable
+		{
+			Blk table{ nullptr, 0 };
+			size_t count{ 0 };
+
+			char* operator[](size_t i) const noexcept { return static_cast<char**>(table.ptr)[i]; }
+
+			void push(Allocator& a, void* pPage)
+			{
+				if (count * sizeof(void*) == table.length)
+				{
+					if (!HE::reallocate(a, table, Math::Max(size_t{ 4 }, 2 * count) * sizeof(void*))) throw std::bad_alloc{};
+				}
+				static_cast<void**>(table.ptr)[count++] = pPage;
+			}
+
+			void release(Allocator& a, size_t nPageSize) noexcept
+			{
+				for (size_t i = 0; i < count; ++i) a.deallocate({ (*this)[i], nPageSize });
+				if (table.ptr) a.deallocate(table);
+			}
+		};
+
+		using SlotList = Private::GenerationalSlots<Slot, &Slot::dense>;
+		static constexpr std::uint32_t npos = SlotList::npos;
+		static constexpr unsigned page_shift = Math::Log2(PageSize);
+
+		// A value page holds PageSize objects, followed by the slot index of each object
+		static constexpr size_t slot_indices_offset = Math::RoundUpToMultipleOf(PageSize * sizeof(T), alignof(std::uint32_t));
+		static constexpr size_t value_page_size = slot_indices_offset + PageSize * sizeof(std::uint32_t);
+		static constexpr size_t slot_page_size = PageSize * sizeof(Slot);
+
+		PageTable m_values;
+		PageTable m_slots;
+		std::uint32_t m_nSize{ 0 };
+		SlotList m_slotList;
+
+		T& valueAt(size_t i) const noexcept
+		{
+			return reinterpret_cast<T*>(m_values[i >> page_shift])[i & (PageSize - 1)];
+		}
+
+		std::uint32_t& slotIndexAt(size_t i) const noexcept
+		{
+			return reinterpret_cast<std::uint32_t*>(m_values[i >> page_shift] + slot_indices_offset)[i & (PageSize - 1)];
+		}
+
+		Slot& slotAt(size_t i) const noexcept
+		{
+			return reinterpret_cast<Slot*>(m_slots[i >> page_shift])[i & (PageSize - 1)];
+		}
+
+		void addValuePage()
+		{
+			pushPage(m_values, Private::AllocateFor<T>(allocator(), value_page_size));
+		}
+
+		void addSlotPage()
+		{
+			pushPage(m_slots, Private::AllocateFor<Slot>(allocator(), slot_page_size));
+		}
+
+		void pushPage(PageTable& pages, Blk b)
+		{
+			try
+			{
+				pages.push(allocator(), b.ptr);
+			}
+			catch (...)
+			{
+				allocator().deallocate(b);
+				throw;
+			}
+		}
+
+		// Gives m_slotList access to the slots
+		auto slotAccess() const noexcept
+		{
+			return [this](std::uint32_t i) -> Slot& { return slotAt(i); };
+		}
+
+		void destroyValues() noexcept
+		{
+			for (size_t i = 0; i < m_nSize; ++i)
+			{
+				valueAt(i).~T();
+				auto const nSlot = slotIndexAt(i);
+				m_slotList.push(slotAt(nSlot), nSlot);
+			}
+		}
+	};
+
+	template<class T, class Allocator, size_t PageSize>
+	template<bool Const>
+	class HandlePool<T, Allocator, PageSize>::Iterator
+	{
+		using Pool = std::conditional_t<Const, const HandlePool, HandlePool>;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, const T*, T*>;
+		using reference = std::conditional_t<Const, const T&, T&>;
+
+		Iterator() noexcept = default;
+		Iterator(Pool* pPool, size_t nIndex) noexcept : m_pPool{ pPool }, m_nIndex{ nIndex } {}
+
+		reference operator*() const noexcept { return m_pPool->valueAt(m_nIndex); }
+		pointer operator->() const noexcept { return &m_pPool->valueAt(m_nIndex); }
+
+		Iterator& operator++() noexcept
+		{
+			++m_nIndex;
+			return *this;
+		}
+
+		Iterator operator++(int) noexcept
+		{
+			auto const copy = *this;
+			++m_nIndex;
+			return copy;
+		}
+
+		// The handle of the current object
+		handle_type handle() const noexcept { return m_pPool->handleAt(m_nIndex); }
+
+		bool operator==(const Iterator& rhs) const noexcept { return m_nIndex == rhs.m_nIndex; }
+		bool operator!=(const Iterator& rhs) const noexcept { return m_nIndex != rhs.m_nIndex; }
+
+	private:
+		Pool* m_pPool{ nullptr };
+		size_t m_nIndex{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace HE
+{
+	template<class Signature, size_t N = 4 * sizeof(void*), class Parent = MallocAllocator>
+	class InplaceFunction;
+
+	// A std::function that keeps callables of up to N bytes inline, and only allocates on the Parent allocator beyond that
+	// The storage comes from a FallbackAllocator of a LightInlineAllocator and the Parent
+	// The Parent is held by value in every function, so it must be stateless
+	// Like std::function, the callable must be copy constructible. Moving a function moves an inline callable, but
+	// steals a heap one
+	// Throws std::bad_alloc when the Parent fails
+	template<class R, class... Args, size_t N, class Parent>
+	class InplaceFunction<R(Args...), N, Parent>
+	{
+		static_assert(N > 0, "InplaceFunction's N should be higher than 0");
+		static_assert(IsStatelessAllocator<Parent>(), "InplaceFunction's Parent does not meet the HE::StatelessAllocator concept");
+
+		using Allocator = FallbackAllocator<LightInlineAllocator<N>, Parent>;
+
+		struct Operations
+		{
+			R(*invoke)(void* pCallable, Args&&... args);
+			void(*copy)(void* pDestination, const void* pSource);
+			void(*move)(void* pDestination, void* pSource);
+			void(*destroy)(void* pCallable);
+		};
+
+		template<class F>
+		struct OperationsOf
+		{
+			static R invoke(void* pCallable, Args&&... args)
+			{
+				// Discards the result of the callable when R is void
+				return static_cast<R>((*static_cast<F*>(pCallable))(std::forward<Args>(args)...));
+			}
+
+			static void copy(void* pDestination, const void* pSource)
+			{
+				new (pDestination) F(*static_cast<const F*>(pSource));
+			}
+
+			static void move(void* pDestination, void* pSource) noexcept
+			{
+				new (pDestination) F(std::move(*static_cast<F*>(pSource)));
+			}
+
+			static void destroy(void* pCallable) noexcept
+			{
+				static_cast<F*>(pCallable)->~F();
+			}
+
+			static const Operations* get() noexcept
+			{
+				static const Operations table{ &invoke, &copy, &move, &destroy };
+				return &table;
+			}
+		};
+
+		// Like std::function, a function returning void accepts callables returning anything
+		template<class F>
+		using is_callable = or_<std::is_void<R>, std::is_convertible<decltype(std::declval<F&>()(std::declval<Args>()...)), R>>;
+
+	public:
+		InplaceFunction() noexcept = default;
+		InplaceFunction(std::nullptr_t) noexcept {}
+
+		template<class F, class = std::enable_if_t<and_<not_<std::is_same<std::decay_t<F>, InplaceFunction>>, is_callable<std::decay_t<F>>>::value>>
+		InplaceFunction(F&& f)
+		{
+			using Callable = std::decay_t<F>;
+			static_assert(alignof(Callable) <= Allocator::alignment, "InplaceFunction's callable is over-aligned");
+			static_assert(std::is_copy_constructible<Callable>::value, "InplaceFunction's callable should be copy constructible");
+			static_assert(std::is_nothrow_move_constructible<Callable>::value, "InplaceFunction's callable should be nothrow move constructible");
+
+			auto const b = allocate(sizeof(Callable));
+			try
+			{
+				new (b.ptr) Callable(std::forward<F>(f));
+			}
+			catch (...)
+			{
+				m_allocator.deallocate(b);
+				throw;
+			}
+			m_block = b;
+			m_pOperations = OperationsOf<Callable>::get();
+		}
+
+		InplaceFunction(const InplaceFunction& other)
+		{
+			if (!other) return;
+
+			auto const b = allocate(other.m_block.length);
+			try
+			{
+				other.m_pOperations->copy(b.ptr, other.m_block.ptr);
+			}
+			catch (...)
+			{
+				m_allocator.deallocate(b);
+				throw;
+			}
+			m_block = b;
+			m_pOperations = other.m_pOperations;
+		}
+
+		InplaceFunction(InplaceFunction&& other) noexcept
+		{
+			take(other);
+		}
+
+		InplaceFunction& operator=(const InplaceFunction& other)
+		{
+			if (this != &other)
+			{
+				InplaceFunction copy{ other };
+				reset();
+				take(copy);
+			}
+			return *this;
+		}
+
+		InplaceFunction& operator=(InplaceFunction&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				take(other);
+			}
+			return *this;
+		}
+
+		InplaceFunction& operator=(std::nullptr_t) noexcept
+		{
+			reset();
+			return *this;
+		}
+
+		~InplaceFunction()
+		{
+			reset();
+		}
+
+		R operator()(Args... args) const
+		{
+			EXPECTS(m_pOperations != nullptr);
+			return m_pOperations->invoke(m_block.ptr, std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const noexcept { return m_pOperations != nullptr; }
+
+		// True if the callable is in the inline buffer
+		bool isInline() const noexcept
+		{
+			auto const pBegin = reinterpret_cast<const char*>(&m_allocator);
+			auto const p = static_cast<const char*>(m_block.ptr);
+			return !std::less<const char*>{}(p, pBegin) && std::less<const char*>{}(p, pBegin + sizeof(m_allocator));
+		}
+
+	private:
+		Allocator m_allocator;
+		Blk m_block{ nullptr, 0 };
+		const Operations* m_pOperations{ nullptr };
+
+		Blk allocate(size_t n)
+		{
+			auto const b = m_allocator.allocate(n);
+			if (!b.ptr) throw std::bad_alloc{};
+			return b;
+		}
+
+		void reset() noexcept
+		{
+			if (!m_pOperations) return;
+
+			m_pOperations->destroy(m_block.ptr);
+			m_allocator.deallocate(m_block);
+			m_block = { nullptr, 0 };
+			m_pOperations = nullptr;
+		}
+
+		// Takes the callable of other, leaving it empty. This function must be empty
+		void take(InplaceFunction& other) noexcept
+		{
+			if (!other) return;
+
+			if (other.isInline())
+			{
+				m_block = m_allocator.allocate(other.m_block.length);
+				other.m_pOperations->move(m_block.ptr, other.m_block.ptr);
+				m_pOperations = other.m_pOperations;
+				other.reset();
+			}
+			else
+			{
+				m_block = other.m_block;
+				m_pOperations = other.m_pOperations;
+				other.m_block = { nullptr, 0 };
+				other.m_pOperations = nullptr;
+			}
+		}
+	};
+
+	template<class Signature, size_t N, class Parent>
+	bool operator==(const InplaceFunction<Signature, N, Parent>& f, std::nullptr_t) noexcept
+	{
+		return !f;
+	}
+
+	template<class Signature, size_t N, class Parent>
+	bool operator!=(const InplaceFunction<Signature, N, Parent>& f, std::nullptr_t) noexcept
+	{
+		return static_cast<bool>(f);
+	}
+}
\ No newline at end of file
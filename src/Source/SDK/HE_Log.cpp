@@ -0,0 +1,712 @@
+#include "HE_Log.h"
+
+#include "HE_Platform.h"
+#include "HE_RingBuffer.h"
+#include "HE_String.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+#if defined(PLATFORM_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace HE
+{
+	namespace
+	{
+		enum class LogStream : std::uint8_t
+		{
+			Out,
+			Error,
+		};
+
+		constexpr size_t log_slot_text_size = 244;
+
+		// Messages are split in fixed-size slots. The newline is part of the text of the last one
+		struct LogSlot
+		{
+			LogSlot() = default;
+
+			// The slot of psMsg's text starting at nOffset
+			LogSlot(LogStream s, std::uint64_t nSequence, const char* psMsg, size_t nMsg, size_t nOffset) noexcept
+				: sequence{ nSequence }
+				, stream{ s }
+			{
+				auto const nEnd = Math::Min(nOffset + log_slot_text_size, nMsg + 1);
+				auto const nCopy = Math::Min(nEnd, nMsg) - nOffset;
+				std::memcpy(text, psMsg + nOffset, nCopy);
+				bLast = nEnd == nMsg + 1;
+				if (bLast) text[nCopy] = '\n';
+				length = static_cast<std::uint16_t>(nEnd - nOffset);
+			}
+
+			std::uint64_t sequence;
+			std::uint16_t length;
+			LogStream stream;
+			bool bLast;
+			char text[log_slot_text_size];
+		};
+		static_assert(sizeof(LogSlot) == 256, "LogSlot should fill four cache lines");
+
+		constexpr size_t SlotCount(size_t nMsg) noexcept
+		{
+			return (nMsg + log_slot_text_size) / log_slot_text_size;
+		}
+
+		size_t ThreadSlotCount(size_t nBufferSize) noexcept
+		{
+			return Private::RingBufferCapacity(Math::Max(nBufferSize / sizeof(LogSlot), size_t{ 1 }));
+		}
+
+#if defined(PLATFORM_WINDOWS)
+		// Gathers the text of a batch, and writes it with one call per stream and buffer
+		// The CRT descriptors are used rather than the console handles, so that redirections of stdout and stderr apply
+		class LogOutput
+		{
+		public:
+			LogOutput() = default;
+			LogOutput(const LogOutput&) = delete;
+			LogOutput& operator=(const LogOutput&) = delete;
+			~LogOutput() { flush(); }
+
+			void add(LogStream stream, const char* p, size_t n) noexcept
+			{
+				if (stream != m_stream) flush();
+				m_stream = stream;
+
+				if (m_nBuffered + n > sizeof(m_buffer))
+				{
+					flush();
+					if (n > sizeof(m_buffer))
+					{
+						write(p, n);
+						return;
+					}
+				}
+				std::memcpy(m_buffer + m_nBuffered, p, n);
+				m_nBuffered += n;
+			}
+
+			void flush() noexcept
+			{
+				write(m_buffer, m_nBuffered);
+				m_nBuffered = 0;
+			}
+
+		private:
+			char m_buffer[4096];
+			size_t m_nBuffered{ 0 };
+			LogStream m_stream{ LogStream::Out };
+
+			void write(const char* p, size_t n) noexcept
+			{
+				auto const fd = m_stream == LogStream::Out ? 1 : 2;
+				while (n != 0)
+				{
+					auto const nWritten = _write(fd, p, static_cast<unsigned int>(Math::Min(n, size_t{ INT_MAX })));
+					if (nWritten <= 0) return;
+					p += nWritten;
+					n -= nWritten;
+				}
+			}
+		};
+#else
+#if defined(IOV_MAX)
+		constexpr int max_write_vectors = IOV_MAX < 256 ? IOV_MAX : 256;
+#else
+		constexpr int max_write_vectors = 16;
+#endif
+
+		// Gathers the text of a batch, and writes it with one writev per stream
+		class LogOutput
+		{
+		public:
+			LogOutput() = default;
+			LogOutput(const LogOutput&) = delete;
+			LogOutput& operator=(const LogOutput&) = delete;
+			~LogOutput() { flush(); }
+
+			void add(LogStream stream, const char* p, size_t n) noexcept
+			{
+				if (stream != m_stream || m_nVectors == max_write_vectors) flush();
+				m_stream = stream;
+				m_vectors[m_nVectors++] = { const_cast<char*>(p), n };
+			}
+
+			void flush() noexcept
+			{
+				auto pVectors = m_vectors;
+				auto nVectors = m_nVectors;
+				m_nVectors = 0;
+
+				auto const fd = m_stream == LogStream::Out ? STDOUT_FILENO : STDERR_FILENO;
+				while (nVectors != 0)
+				{
+					auto const nWritten = ::writev(fd, pVectors, nVectors);
+					if (nWritten < 0)
+					{
+						if (errno == EINTR) continue;
+						return;
+					}
+
+					// Skip what was written, in case of a partial write
+					auto nLeft = static_cast<size_t>(nWritten);
+					while (nVectors != 0 && nLeft >= pVectors->iov_len)
+					{
+						nLeft -= pVectors->iov_len;
+						++pVectors;
+						--nVectors;
+					}
+					if (nVectors != 0)
+					{
+						pVectors->iov_base = static_cast<char*>(pVectors->iov_base) + nLeft;
+						pVectors->iov_len -= nLeft;
+					}
+				}
+			}
+
+		private:
+			iovec m_vectors[max_write_vectors];
+			int m_nVectors{ 0 };
+			LogStream m_stream{ LogStream::Out };
+		};
+#endif
+
+		// The buffer of a thread. Buffers are never freed: when their thread exits, the writer keeps draining them, and
+		// a new thread can take them over
+		struct ThreadLog
+		{
+			explicit ThreadLog(size_t nSlots) : buffer{ nSlots } {}
+
+			SPSCRingBuffer<LogSlot> buffer;
+			std::atomic<bool> bOwned{ true };
+			ThreadLog* pNext{ nullptr };
+
+			// Slots left to pop in the current batch. Only used by the holder of the draining lock
+			size_t nBatch{ 0 };
+		};
+
+		constexpr size_t staging_slot_count = 256;
+
+		// Slots popped from the thread buffers, before they are written
+		// Slots of a message that was not entirely pushed yet are carried over to the next drain, so that the lines
+		// of other threads are not written in the middle of it
+		struct LogStaging
+		{
+			LogSlot slots[staging_slot_count];
+			std::uint16_t order[staging_slot_count];
+			bool carry[staging_slot_count];
+			size_t nCarried{ 0 };
+
+			// Pops the buffers, and writes the complete messages in the order they were logged. Returns the number of
+			// slots written. If bForce, the incomplete messages are also written. If bBatch, no more than the nBatch
+			// slots of each buffer are popped
+			size_t drain(ThreadLog* pThreadLogs, bool bForce, bool bBatch) noexcept
+			{
+				auto nCount = nCarried;
+				for (auto p = pThreadLogs; p && nCount < staging_slot_count; p = p->pNext)
+				{
+					auto const nMax = staging_slot_count - nCount;
+					auto const nPopped = p->buffer.tryPopBatch(slots + nCount, bBatch ? Math::Min(nMax, p->nBatch) : nMax);
+					if (bBatch) p->nBatch -= nPopped;
+					nCount += nPopped;
+				}
+				if (nCount == 0 || (nCount == nCarried && !bForce)) return 0;
+
+				// The slots of a message have the same sequence, and stay in the order they were popped
+				for (size_t i = 0; i < nCount; ++i) order[i] = static_cast<std::uint16_t>(i);
+				std::sort(order, order + nCount, [this](std::uint16_t a, std::uint16_t b)
+				{
+					return slots[a].sequence != slots[b].sequence ? slots[a].sequence < slots[b].sequence : a < b;
+				});
+
+				// A message is complete if its last slot was popped. A staging full of incomplete messages is written
+				// anyway, since it would not make room for the rest
+				size_t nIncomplete = 0;
+				bool bComplete = false;
+				for (auto i = nCount; i != 0; --i)
+				{
+					auto const& slot = slots[order[i - 1]];
+					if (i == nCount || slots[order[i]].sequence != slot.sequence) bComplete = bForce || slot.bLast;
+					carry[order[i - 1]] = !bComplete;
+					if (!bComplete) ++nIncomplete;
+				}
+				if (nIncomplete == staging_slot_count) std::fill(carry, carry + nCount, false);
+
+				{
+					LogOutput output;
+					for (size_t i = 0; i < nCount; ++i)
+					{
+						auto const& slot = slots[order[i]];
+						if (!carry[order[i]]) output.add(slot.stream, slot.text, slot.length);
+					}
+				}
+
+				size_t nNextCarried = 0;
+				for (size_t i = 0; i < nCount; ++i)
+				{
+					if (carry[i]) slots[nNextCarried++] = slots[i];
+				}
+				nCarried = nNextCarried;
+				return nCount - nCarried;
+			}
+		};
+
+		thread_local ThreadLog* t_pThreadLog = nullptr;
+		thread_local bool t_bThreadExiting = false;
+
+		// Gives the buffer of the thread back when it exits. Logging after that, from other thread_local destructors,
+		// is synchronous
+		struct ThreadLogRelease
+		{
+			~ThreadLogRelease()
+			{
+				t_bThreadExiting = true;
+				if (t_pThreadLog) t_pThreadLog->bOwned.store(false, std::memory_order_release);
+				t_pThreadLog = nullptr;
+			}
+		};
+
+		// How long the writer sleeps when the buffers are empty. Producers wake it up earlier if they see it asleep
+		constexpr std::chrono::milliseconds writer_sleep{ 10 };
+
+		// How many times a crash handler yields, waiting for the writer to finish its batch, before taking over
+		constexpr int crash_wait_yields = 10000;
+
+		class Logger
+		{
+		public:
+			Logger() noexcept;
+
+			Logger(const Logger&) = delete;
+			Logger& operator=(const Logger&) = delete;
+
+			void write(LogStream stream, const char* psMsg, size_t nMsg) noexcept;
+			void flush() noexcept;
+			void flushOnCrash() noexcept;
+			void shutdown() noexcept;
+
+			void setSettings(const LogSettings& settings) noexcept
+			{
+				m_nThreadBufferSize.store(settings.threadBufferSize, std::memory_order_relaxed);
+				m_overflow.store(settings.overflow, std::memory_order_relaxed);
+			}
+
+			LogSettings getSettings() const noexcept
+			{
+				return{ m_nThreadBufferSize.load(std::memory_order_relaxed), m_overflow.load(std::memory_order_relaxed) };
+			}
+
+			size_t dropped() const noexcept { return m_nDropped.load(std::memory_order_relaxed); }
+
+		private:
+			std::atomic<ThreadLog*> m_pThreadLogs{ nullptr };
+			std::atomic<size_t> m_nThreadBufferSize{ default_log_settings.threadBufferSize };
+			std::atomic<LogOverflow> m_overflow{ default_log_settings.overflow };
+			std::atomic<std::uint64_t> m_nNextSequence{ 0 };
+			std::atomic<size_t> m_nDropped{ 0 };
+
+			// Whether the writer thread takes the messages. Otherwise, they are written synchronously
+			std::atomic<bool> m_bRunning{ false };
+			std::atomic<bool> m_bStopping{ false };
+			std::thread m_writer;
+			std::thread::id m_writerId;
+
+			// Held by whoever pops the buffers and writes, since they are single consumer
+			std::atomic<bool> m_bDraining{ false };
+			LogStaging m_staging;
+			LogStaging m_crashStaging;
+
+			std::mutex m_mutWake;
+			std::condition_variable m_cvWake;
+			std::atomic<bool> m_bWriterSleeping{ false };
+
+			std::atomic<std::uint64_t> m_nFlushRequested{ 0 };
+			std::uint64_t m_nFlushed{ 0 };
+			std::mutex m_mutFlush;
+			std::condition_variable m_cvFlushed;
+
+			ThreadLog* threadLog() noexcept;
+			void run() noexcept;
+			bool hasPendingWork() const noexcept;
+			void drainAll(LogStaging& staging, bool bForce) noexcept;
+			void lockDraining() noexcept;
+			void writeSynchronously(LogStream stream, const char* psMsg, size_t nMsg) noexcept;
+			void wakeWriter() noexcept { m_cvWake.notify_one(); }
+		};
+
+		Logger* g_pLogger = nullptr;
+
+		void InstallCrashHandlers() noexcept;
+
+		void ShutdownLog()
+		{
+			g_pLogger->shutdown();
+		}
+
+		// Never destroyed, so that it stays usable from static destructors and late threads
+		Logger& GetLogger() noexcept
+		{
+			static std::aligned_storage_t<sizeof(Logger), alignof(Logger)> s_storage;
+			static Logger* const s_pLogger = new (&s_storage) Logger{};
+			return *s_pLogger;
+		}
+
+		Logger::Logger() noexcept
+		{
+			g_pLogger = this;
+
+			try
+			{
+				m_bRunning.store(true, std::memory_order_release);
+				m_writer = std::thread{ [this]() { run(); } };
+				m_writerId = m_writer.get_id();
+			}
+			catch (const std::system_error&)
+			{
+				m_bRunning.store(false, std::memory_order_release);
+				return;
+			}
+
+			InstallCrashHandlers();
+			std::atexit(ShutdownLog);
+		}
+
+		ThreadLog* Logger::threadLog() noexcept
+		{
+			if (t_pThreadLog || t_bThreadExiting) return t_pThreadLog;
+
+			static thread_local ThreadLogRelease t_release;
+			(void)t_release;
+
+			// Take over the buffer of an exited thread, if one has the current size
+			auto const nSlots = ThreadSlotCount(m_nThreadBufferSize.load(std::memory_order_relaxed));
+			auto pHead = m_pThreadLogs.load(std::memory_order_acquire);
+			for (auto p = pHead; p; p = p->pNext)
+			{
+				auto bOwned = false;
+				if (p->buffer.capacity() == nSlots && !p->bOwned.load(std::memory_order_relaxed)
+					&& p->bOwned.compare_exchange_strong(bOwned, true, std::memory_order_acquire))
+				{
+					return t_pThreadLog = p;
+				}
+			}
+
+			ThreadLog* pThreadLog;
+			try
+			{
+				pThreadLog = new ThreadLog{ nSlots };
+			}
+			catch (const std::bad_alloc&)
+			{
+				return nullptr;
+			}
+
+			pThreadLog->pNext = pHead;
+			while (!m_pThreadLogs.compare_exchange_weak(pThreadLog->pNext, pThreadLog, std::memory_order_release, std::memory_order_acquire)) {}
+			return t_pThreadLog = pThreadLog;
+		}
+
+		void Logger::write(LogStream stream, const char* psMsg, size_t nMsg) noexcept
+		{
+			auto const pThreadLog = m_bRunning.load(std::memory_order_acquire) ? threadLog() : nullptr;
+			if (!pThreadLog)
+			{
+				writeSynchronously(stream, psMsg, nMsg);
+				return;
+			}
+
+			// The producer's view of the size is never below the actual size, so the message is known to fit
+			auto& buffer = pThreadLog->buffer;
+			if (m_overflow.load(std::memory_order_relaxed) == LogOverflow::Drop && buffer.capacity() - buffer.sizeApprox() < SlotCount(nMsg))
+			{
+				m_nDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			auto const nSequence = m_nNextSequence.fetch_add(1, std::memory_order_relaxed);
+			for (size_t nOffset = 0; nOffset <= nMsg; nOffset += log_slot_text_size)
+			{
+				while (!buffer.tryEmplace(stream, nSequence, psMsg, nMsg, nOffset))
+				{
+					// Once the writer is stopped, the slots already pushed are popped here, and carried in the staging
+					// until the rest of the message is pushed, so that the message is still written in one piece
+					if (!m_bRunning.load(std::memory_order_acquire))
+					{
+						drainAll(m_staging, false);
+						continue;
+					}
+					wakeWriter();
+					std::this_thread::yield();
+				}
+			}
+
+			// Pairs with the fence in shutdown: either its last drain sees the message, or the message is drained here
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!m_bRunning.load(std::memory_order_relaxed))
+			{
+				drainAll(m_staging, false);
+				return;
+			}
+
+			if (m_bWriterSleeping.load(std::memory_order_relaxed)) wakeWriter();
+		}
+
+		void Logger::flush() noexcept
+		{
+			if (!m_bRunning.load(std::memory_order_acquire) || std::this_thread::get_id() == m_writerId)
+			{
+				drainAll(m_staging, true);
+				return;
+			}
+
+			try
+			{
+				auto const nRequest = m_nFlushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+				// Taking the lock orders the request with the writer's check before it sleeps
+				{
+					std::lock_guard<std::mutex> lock{ m_mutWake };
+				}
+				wakeWriter();
+
+				std::unique_lock<std::mutex> lock{ m_mutFlush };
+				m_cvFlushed.wait(lock, [this, nRequest]() { return m_nFlushed >= nRequest; });
+			}
+			catch (const std::system_error&)
+			{
+				// The messages will still be written by the writer thread, only not before returning
+			}
+		}
+
+		void Logger::flushOnCrash() noexcept
+		{
+			// The writer may be the crashing thread, or stuck on a full pipe: it only gets a bounded time to finish
+			// its batch. Otherwise, it keeps its staging, and the crash handler takes over the buffers with its own
+			auto bIdle = std::this_thread::get_id() != m_writerId;
+			for (int i = 0; bIdle && m_bDraining.exchange(true, std::memory_order_acquire); ++i)
+			{
+				if (i == crash_wait_yields) bIdle = false;
+				std::this_thread::yield();
+			}
+
+			auto& staging = bIdle ? m_staging : m_crashStaging;
+			while (staging.drain(m_pThreadLogs.load(std::memory_order_acquire), true, false) != 0) {}
+			if (bIdle) m_bDraining.store(false, std::memory_order_release);
+		}
+
+		void Logger::shutdown() noexcept
+		{
+			if (!m_bRunning.load(std::memory_order_acquire)) return;
+
+			{
+				std::lock_guard<std::mutex> lock{ m_mutWake };
+				m_bStopping.store(true, std::memory_order_release);
+			}
+			wakeWriter();
+			m_writer.join();
+			m_bRunning.store(false, std::memory_order_release);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			// Messages pushed while the writer was exiting, and flushes requested after its last batch. Messages
+			// pushed after this drain are drained by their thread
+			drainAll(m_staging, true);
+			{
+				std::lock_guard<std::mutex> lock{ m_mutFlush };
+				m_nFlushed = m_nFlushRequested.load(std::memory_order_acquire);
+			}
+			m_cvFlushed.notify_all();
+		}
+
+		void Logger::run() noexcept
+		{
+			for (;;)
+			{
+				// Whatever was logged before these loads is drained below
+				auto const nFlushRequested = m_nFlushRequested.load(std::memory_order_acquire);
+				auto const bStopping = m_bStopping.load(std::memory_order_acquire);
+
+				drainAll(m_staging, bStopping);
+
+				if (nFlushRequested != m_nFlushed)
+				{
+					{
+						std::lock_guard<std::mutex> lock{ m_mutFlush };
+						m_nFlushed = nFlushRequested;
+					}
+					m_cvFlushed.notify_all();
+				}
+
+				if (bStopping) return;
+
+				std::unique_lock<std::mutex> lock{ m_mutWake };
+				m_bWriterSleeping.store(true, std::memory_order_relaxed);
+				if (!hasPendingWork()) m_cvWake.wait_for(lock, writer_sleep);
+				m_bWriterSleeping.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		bool Logger::hasPendingWork() const noexcept
+		{
+			if (m_bStopping.load(std::memory_order_relaxed) || m_nFlushRequested.load(std::memory_order_relaxed) != m_nFlushed) return true;
+
+			for (auto p = m_pThreadLogs.load(std::memory_order_acquire); p; p = p->pNext)
+			{
+				if (p->buffer.sizeApprox() != 0) return true;
+			}
+			return false;
+		}
+
+		void Logger::drainAll(LogStaging& staging, bool bForce) noexcept
+		{
+			lockDraining();
+
+			// Only the slots pushed before the call are drained, so that threads that keep logging cannot hold the
+			// writer back from flush and stop requests
+			auto const pThreadLogs = m_pThreadLogs.load(std::memory_order_acquire);
+			for (auto p = pThreadLogs; p; p = p->pNext) p->nBatch = p->buffer.sizeApprox();
+			while (staging.drain(pThreadLogs, bForce, true) != 0) {}
+
+			m_bDraining.store(false, std::memory_order_release);
+		}
+
+		void Logger::lockDraining() noexcept
+		{
+			while (m_bDraining.exchange(true, std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		void Logger::writeSynchronously(LogStream stream, const char* psMsg, size_t nMsg) noexcept
+		{
+			lockDraining();
+			{
+				LogOutput output;
+				output.add(stream, psMsg, nMsg);
+				output.add(stream, "\n", 1);
+			}
+			m_bDraining.store(false, std::memory_order_release);
+		}
+
+		void FlushLogOnCrash() noexcept
+		{
+			if (g_pLogger) g_pLogger->flushOnCrash();
+		}
+
+		std::terminate_handler s_previousTerminate = nullptr;
+
+		[[noreturn]] void OnTerminate()
+		{
+			FlushLogOnCrash();
+			if (s_previousTerminate) s_previousTerminate();
+			std::abort();
+		}
+
+#if defined(PLATFORM_WINDOWS)
+		LPTOP_LEVEL_EXCEPTION_FILTER s_previousExceptionFilter = nullptr;
+		void(*s_previousAbortHandler)(int) = SIG_DFL;
+
+		LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* pException)
+		{
+			FlushLogOnCrash();
+			return s_previousExceptionFilter ? s_previousExceptionFilter(pException) : EXCEPTION_CONTINUE_SEARCH;
+		}
+
+		void OnAbort(int nSignal)
+		{
+			FlushLogOnCrash();
+			std::signal(nSignal, s_previousAbortHandler);
+			std::raise(nSignal);
+		}
+
+		void InstallCrashHandlers() noexcept
+		{
+			s_previousTerminate = std::set_terminate(OnTerminate);
+			s_previousExceptionFilter = SetUnhandledExceptionFilter(OnUnhandledException);
+			auto const previousAbortHandler = std::signal(SIGABRT, OnAbort);
+			if (previousAbortHandler != SIG_ERR) s_previousAbortHandler = previousAbortHandler;
+		}
+#else
+		constexpr int crash_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+		constexpr size_t crash_signal_count = sizeof(crash_signals) / sizeof(crash_signals[0]);
+		struct sigaction s_previousActions[crash_signal_count];
+
+		// Restores the previous handler and raises the signal again, which is delivered when this handler returns
+		void OnCrashSignal(int nSignal)
+		{
+			FlushLogOnCrash();
+			for (size_t i = 0; i < crash_signal_count; ++i)
+			{
+				if (crash_signals[i] == nSignal) sigaction(nSignal, &s_previousActions[i], nullptr);
+			}
+			std::raise(nSignal);
+		}
+
+		void InstallCrashHandlers() noexcept
+		{
+			s_previousTerminate = std::set_terminate(OnTerminate);
+
+			struct sigaction action{};
+			action.sa_handler = OnCrashSignal;
+			sigemptyset(&action.sa_mask);
+			for (size_t i = 0; i < crash_signal_count; ++i)
+			{
+				sigaction(crash_signals[i], &action, &s_previousActions[i]);
+			}
+		}
+#endif
+	}
+
+	void SetLogSettings(const LogSettings& settings)
+	{
+		EXPECTS(settings.threadBufferSize > 0);
+		GetLogger().setSettings(settings);
+	}
+
+	LogSettings GetLogSettings() noexcept
+	{
+		return GetLogger().getSettings();
+	}
+
+	void FlushLog() noexcept
+	{
+		GetLogger().flush();
+	}
+
+	size_t DroppedLogMessages() noexcept
+	{
+		return GetLogger().dropped();
+	}
+
+	void Log(const char* psMsg) noexcept
+	{
+		GetLogger().write(LogStream::Out, psMsg, std::strlen(psMsg));
+	}
+
+	void LogError(const char* psMsg) noexcept
+	{
+		GetLogger().write(LogStream::Error, psMsg, std::strlen(psMsg));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace HE
+{
+	// Log and LogError (see HE_String.h) are asynchronous: the message is copied in a lock-free buffer of the calling
+	// thread, and a background thread writes the buffers of all the threads to stdout and stderr, in batches merged
+	// in the order the messages were logged
+	// The messages still in the buffers are written on exit, on std::terminate and on fatal signals (ex: SIGSEGV).
+	// After exit, or if a buffer cannot be allocated, the messages are written synchronously
+
+	// What Log and LogError do when the buffer of the calling thread is full
+	enum class LogOverflow
+	{
+		Block, // Wait for the writer thread to make room
+		Drop, // Discard the message, and count it in DroppedLogMessages
+	};
+
+	struct LogSettings
+	{
+		size_t threadBufferSize; // In bytes. Only for the threads which log for the first time after the change
+		LogOverflow overflow;
+	};
+
+	constexpr LogSettings default_log_settings{ 64 * 1024, LogOverflow::Block };
+
+	void SetLogSettings(const LogSettings& settings);
+	LogSettings GetLogSettings() noexcept;
+
+	// Blocks until every message logged before the call is written
+	void FlushLog() noexcept;
+
+	// Messages discarded by LogOverflow::Drop since the start of the program
+	size_t DroppedLogMessages() noexcept;
+}
\ No newline at end of file
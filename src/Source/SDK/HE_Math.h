@@ -1,8 +1,14 @@
 #pragma once
 
 #include <type_traits>
+#include <cstdint>
 
 #include "TMP_Helper.h"
+#include "HE_Platform.h"
+
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
 
 namespace HE
 {
@@ -68,5 +74,60 @@ namespace HE
 		{
 			return (s % base) ? s + base - (s % base) : s;
 		}
+
+		// Floor of the base 2 logarithm. Should be used in statically evaluated contexts,
+		// otherwise see FloorLog2
+		template<class T, class Enable = std::enable_if_t<std::is_integral<T>::value>>
+		constexpr unsigned Log2(T a) noexcept
+		{
+			return a <= 1 ? 0 : 1 + Log2(a >> 1);
+		}
+
+		// Number of zero bits before the most significant set bit
+		// Pre-condition: a != 0
+		inline unsigned CountLeadingZeros(std::uint64_t a) noexcept
+		{
+#if defined(COMPILER_MSVC)
+			unsigned long nIndex;
+#if defined(_WIN64)
+			_BitScanReverse64(&nIndex, a);
+#else
+			if (_BitScanReverse(&nIndex, static_cast<unsigned long>(a >> 32))) nIndex += 32;
+			else _BitScanReverse(&nIndex, static_cast<unsigned long>(a));
+#endif
+			return 63 - nIndex;
+#else
+			return __builtin_clzll(a);
+#endif
+		}
+
+		// Number of zero bits below the least significant set bit
+		// Pre-condition: a != 0
+		inline unsigned CountTrailingZeros(std::uint64_t a) noexcept
+		{
+#if defined(COMPILER_MSVC)
+			unsigned long nIndex;
+#if defined(_WIN64)
+			_BitScanForward64(&nIndex, a);
+#else
+			if (_BitScanForward(&nIndex, static_cast<unsigned long>(a))) {}
+			else { _BitScanForward(&nIndex, static_cast<unsigned long>(a >> 32)); nIndex += 32; }
+#endif
+			return nIndex;
+#else
+			return __builtin_ctzll(a);
+#endif
+		}
+
+		// Pre-condition: a != 0
+		inline unsigned FloorLog2(std::uint64_t a) noexcept
+		{
+			return 63 - CountLeadingZeros(a);
+		}
+
+		inline unsigned CeilLog2(std::uint64_t a) noexcept
+		{
+			return a <= 1 ? 0 : 64 - CountLeadingZeros(a - 1);
+		}
 	}
 }
\ No newline at end of file
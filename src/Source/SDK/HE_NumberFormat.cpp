@@ -0,0 +1,456 @@
+#include "HE_NumberFormat.h"
+
+#include "HE_Assert.h"
+#include "HE_Math.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace HE
+{
+	namespace
+	{
+		constexpr char digit_pairs[] =
+			"0001020304050607080910111213141516171819"
+			"2021222324252627282930313233343536373839"
+			"4041424344454647484950515253545556575859"
+			"6061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+
+		template<class UInt>
+		unsigned CountDigits(UInt val) noexcept
+		{
+			unsigned n = 1;
+			for (;;)
+			{
+				if (val < 10) return n;
+				if (val < 100) return n + 1;
+				if (val < 1000) return n + 2;
+				if (val < 10000) return n + 3;
+				val /= 10000u;
+				n += 4;
+			}
+		}
+
+		// The digits are written from the end, two at a time
+		template<class UInt>
+		char* WriteUnsigned(char* pOut, UInt val) noexcept
+		{
+			auto const pEnd = pOut + CountDigits(val);
+			auto p = pEnd;
+			while (val >= 100)
+			{
+				auto const nPair = static_cast<size_t>(val % 100) * 2;
+				val /= 100;
+				p -= 2;
+				std::memcpy(p, digit_pairs + nPair, 2);
+			}
+
+			if (val >= 10)
+			{
+				std::memcpy(p - 2, digit_pairs + static_cast<size_t>(val) * 2, 2);
+			}
+			else
+			{
+				p[-1] = static_cast<char>('0' + val);
+			}
+			return pEnd;
+		}
+
+		template<class Int>
+		char* WriteSigned(char* pOut, Int val) noexcept
+		{
+			using UInt = std::make_unsigned_t<Int>;
+			auto nAbs = static_cast<UInt>(val);
+			if (val < 0)
+			{
+				*pOut++ = '-';
+				nAbs = 0 - nAbs;
+			}
+			return WriteUnsigned(pOut, nAbs);
+		}
+
+		// Grisu2, from Florian Loitsch's "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+		// A number is kept as f * 2^e in a 64-bit "do-it-yourself" floating point, and scaled by a cached power
+		// of ten so that its digits can be generated with integer operations only
+		struct DiyFp
+		{
+			std::uint64_t f;
+			int e;
+		};
+
+		DiyFp Subtract(DiyFp x, DiyFp y) noexcept
+		{
+			return{ x.f - y.f, x.e };
+		}
+
+		// Upper 64 bits of the 128-bit product, rounded
+		DiyFp Multiply(DiyFp x, DiyFp y) noexcept
+		{
+			auto const xLow = x.f & 0xFFFFFFFFu;
+			auto const xHigh = x.f >> 32;
+			auto const yLow = y.f & 0xFFFFFFFFu;
+			auto const yHigh = y.f >> 32;
+
+			auto const p0 = xLow * yLow;
+			auto const p1 = xLow * yHigh;
+			auto const p2 = xHigh * yLow;
+			auto const p3 = xHigh * yHigh;
+
+			auto nMiddle = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+			nMiddle += std::uint64_t{ 1 } << 31;
+			return{ p3 + (p1 >> 32) + (p2 >> 32) + (nMiddle >> 32), x.e + y.e + 64 };
+		}
+
+		DiyFp Normalize(DiyFp x) noexcept
+		{
+			auto const nShift = Math::CountLeadingZeros(x.f);
+			return{ x.f << nShift, x.e - static_cast<int>(nShift) };
+		}
+
+		DiyFp NormalizeTo(DiyFp x, int nExponent) noexcept
+		{
+			return{ x.f << (x.e - nExponent), nExponent };
+		}
+
+		// The value, and the boundaries halfway to its neighbours, all normalized to the same exponent
+		struct Boundaries
+		{
+			DiyFp w;
+			DiyFp minus;
+			DiyFp plus;
+		};
+
+		template<class Float>
+		Boundaries ComputeBoundaries(Float value) noexcept
+		{
+			using Bits = std::conditional_t<sizeof(Float) == 4, std::uint32_t, std::uint64_t>;
+			constexpr int precision = std::numeric_limits<Float>::digits;
+			constexpr int bias = std::numeric_limits<Float>::max_exponent - 1 + (precision - 1);
+			constexpr int min_exponent = 1 - bias;
+			constexpr std::uint64_t hidden_bit = std::uint64_t{ 1 } << (precision - 1);
+
+			Bits bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			auto const nBiasedExponent = static_cast<int>(bits >> (precision - 1));
+			auto const nFraction = static_cast<std::uint64_t>(bits) & (hidden_bit - 1);
+
+			auto const v = nBiasedExponent == 0 ? DiyFp{ nFraction, min_exponent } : DiyFp{ nFraction + hidden_bit, nBiasedExponent - bias };
+
+			// The lower neighbour is closer when the fraction is 0, except for the smallest normal number
+			auto const bLowerIsCloser = nFraction == 0 && nBiasedExponent > 1;
+			auto const plus = Normalize(DiyFp{ 2 * v.f + 1, v.e - 1 });
+			auto const minus = bLowerIsCloser ? DiyFp{ 4 * v.f - 1, v.e - 2 } : DiyFp{ 2 * v.f - 1, v.e - 1 };
+
+			return{ Normalize(v), NormalizeTo(minus, plus.e), plus };
+		}
+
+		// The scaled numbers have their binary exponent in [alpha, gamma], so that the integral part of the
+		// upper boundary fits in 32 bits
+		constexpr int grisu_alpha = -60;
+		constexpr int grisu_gamma = -32;
+
+		struct CachedPower
+		{
+			std::uint64_t f;
+			int e;
+			int k; // Decimal exponent
+		};
+
+		// 10^k normalized to 64 bits, for k in [-300, 324] by steps of 8
+		constexpr int cached_power_min_decimal_exponent = -300;
+		constexpr int cached_power_decimal_step = 8;
+		constexpr CachedPower cached_powers[] = {
+			{ 0xAB70FE17C79AC6CA, -1060, -300 },
+			{ 0xFF77B1FCBEBCDC4F, -1034, -292 },
+			{ 0xBE5691EF416BD60C, -1007, -284 },
+			{ 0x8DD01FAD907FFC3C, -980, -276 },
+			{ 0xD3515C2831559A83, -954, -268 },
+			{ 0x9D71AC8FADA6C9B5, -927, -260 },
+			{ 0xEA9C227723EE8BCB, -901, -252 },
+			{ 0xAECC49914078536D, -874, -244 },
+			{ 0x823C12795DB6CE57, -847, -236 },
+			{ 0xC21094364DFB5637, -821, -228 },
+			{ 0x9096EA6F3848984F, -794, -220 },
+			{ 0xD77485CB25823AC7, -768, -212 },
+			{ 0xA086CFCD97BF97F4, -741, -204 },
+			{ 0xEF340A98172AACE5, -715, -196 },
+			{ 0xB23867FB2A35B28E, -688, -188 },
+			{ 0x84C8D4DFD2C63F3B, -661, -180 },
+			{ 0xC5DD44271AD3CDBA, -635, -172 },
+			{ 0x936B9FCEBB25C996, -608, -164 },
+			{ 0xDBAC6C247D62A584, -582, -156 },
+			{ 0xA3AB66580D5FDAF6, -555, -148 },
+			{ 0xF3E2F893DEC3F126, -529, -140 },
+			{ 0xB5B5ADA8AAFF80B8, -502, -132 },
+			{ 0x87625F056C7C4A8B, -475, -124 },
+			{ 0xC9BCFF6034C13053, -449, -116 },
+			{ 0x964E858C91BA2655, -422, -108 },
+			{ 0xDFF9772470297EBD, -396, -100 },
+			{ 0xA6DFBD9FB8E5B88F, -369, -92 },
+			{ 0xF8A95FCF88747D94, -343, -84 },
+			{ 0xB94470938FA89BCF, -316, -76 },
+			{ 0x8A08F0F8BF0F156B, -289, -68 },
+			{ 0xCDB02555653131B6, -263, -60 },
+			{ 0x993FE2C6D07B7FAC, -236, -52 },
+			{ 0xE45C10C42A2B3B06, -210, -44 },
+			{ 0xAA242499697392D3, -183, -36 },
+			{ 0xFD87B5F28300CA0E, -157, -28 },
+			{ 0xBCE5086492111AEB, -130, -20 },
+			{ 0x8CBCCC096F5088CC, -103, -12 },
+			{ 0xD1B71758E219652C, -77, -4 },
+			{ 0x9C40000000000000, -50, 4 },
+			{ 0xE8D4A51000000000, -24, 12 },
+			{ 0xAD78EBC5AC620000, 3, 20 },
+			{ 0x813F3978F8940984, 30, 28 },
+			{ 0xC097CE7BC90715B3, 56, 36 },
+			{ 0x8F7E32CE7BEA5C70, 83, 44 },
+			{ 0xD5D238A4ABE98068, 109, 52 },
+			{ 0x9F4F2726179A2245, 136, 60 },
+			{ 0xED63A231D4C4FB27, 162, 68 },
+			{ 0xB0DE65388CC8ADA8, 189, 76 },
+			{ 0x83C7088E1AAB65DB, 216, 84 },
+			{ 0xC45D1DF942711D9A, 242, 92 },
+			{ 0x924D692CA61BE758, 269, 100 },
+			{ 0xDA01EE641A708DEA, 295, 108 },
+			{ 0xA26DA3999AEF774A, 322, 116 },
+			{ 0xF209787BB47D6B85, 348, 124 },
+			{ 0xB454E4A179DD1877, 375, 132 },
+			{ 0x865B86925B9BC5C2, 402, 140 },
+			{ 0xC83553C5C8965D3D, 428, 148 },
+			{ 0x952AB45CFA97A0B3, 455, 156 },
+			{ 0xDE469FBD99A05FE3, 481, 164 },
+			{ 0xA59BC234DB398C25, 508, 172 },
+			{ 0xF6C69A72A3989F5C, 534, 180 },
+			{ 0xB7DCBF5354E9BECE, 561, 188 },
+			{ 0x88FCF317F22241E2, 588, 196 },
+			{ 0xCC20CE9BD35C78A5, 614, 204 },
+			{ 0x98165AF37B2153DF, 641, 212 },
+			{ 0xE2A0B5DC971F303A, 667, 220 },
+			{ 0xA8D9D1535CE3B396, 694, 228 },
+			{ 0xFB9B7CD9A4A7443C, 720, 236 },
+			{ 0xBB764C4CA7A44410, 747, 244 },
+			{ 0x8BAB8EEFB6409C1A, 774, 252 },
+			{ 0xD01FEF10A657842C, 800, 260 },
+			{ 0x9B10A4E5E9913129, 827, 268 },
+			{ 0xE7109BFBA19C0C9D, 853, 276 },
+			{ 0xAC2820D9623BF429, 880, 284 },
+			{ 0x80444B5E7AA7CF85, 907, 292 },
+			{ 0xBF21E44003ACDD2D, 933, 300 },
+			{ 0x8E679C2F5E44FF8F, 960, 308 },
+			{ 0xD433179D9C8CB841, 986, 316 },
+			{ 0x9E19DB92B4E31BA9, 1013, 324 },
+		};
+
+		// Power of ten c such that the binary exponent of c * 2^nExponent is in [alpha, gamma]
+		CachedPower GetCachedPower(int nExponent) noexcept
+		{
+			// k = ceil((alpha - e - 1) * log10(2)), with log10(2) ~= 78913 / 2^18
+			auto const f = grisu_alpha - nExponent - 1;
+			auto const k = (f * 78913) / (1 << 18) + (f > 0);
+			auto const nIndex = (-cached_power_min_decimal_exponent + k + (cached_power_decimal_step - 1)) / cached_power_decimal_step;
+			ASSERT(nIndex >= 0 && static_cast<size_t>(nIndex) < sizeof(cached_powers) / sizeof(cached_powers[0]));
+
+			auto const& cached = cached_powers[nIndex];
+			ASSERT(grisu_alpha <= cached.e + nExponent + 64 && cached.e + nExponent + 64 <= grisu_gamma);
+			return cached;
+		}
+
+		// Largest power of ten not above n, which is below 10^10, and its number of digits
+		unsigned FindLargestPow10(std::uint32_t n, std::uint32_t& nPow10) noexcept
+		{
+			static constexpr std::uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+			unsigned nDigits = 10;
+			while (nDigits > 1 && n < pow10[nDigits - 1]) --nDigits;
+			nPow10 = pow10[nDigits - 1];
+			return nDigits;
+		}
+
+		// Moves the last digit towards w while it stays within the boundaries
+		void Round(char* pDigits, size_t nLength, std::uint64_t nDistance, std::uint64_t nDelta, std::uint64_t nRest, std::uint64_t nTenK) noexcept
+		{
+			while (nRest < nDistance && nDelta - nRest >= nTenK
+				&& (nRest + nTenK < nDistance || nDistance - nRest > nRest + nTenK - nDistance))
+			{
+				--pDigits[nLength - 1];
+				nRest += nTenK;
+			}
+		}
+
+		// Generates the digits of a number in (minus, plus), as close to w as possible
+		// The number is pDigits[0, nLength) * 10^nDecimalExponent
+		void GenerateDigits(char* pDigits, size_t& nLength, int& nDecimalExponent, DiyFp minus, DiyFp w, DiyFp plus) noexcept
+		{
+			auto nDelta = Subtract(plus, minus).f;
+			auto nDistance = Subtract(plus, w).f;
+
+			// Split plus in its integral part p1 and fractional part p2, with one = 2^-e
+			DiyFp const one{ std::uint64_t{ 1 } << -plus.e, plus.e };
+			auto p1 = static_cast<std::uint32_t>(plus.f >> -one.e);
+			auto p2 = plus.f & (one.f - 1);
+
+			std::uint32_t nPow10;
+			auto n = FindLargestPow10(p1, nPow10);
+			while (n > 0)
+			{
+				auto const nDigit = p1 / nPow10;
+				p1 %= nPow10;
+				pDigits[nLength++] = static_cast<char>('0' + nDigit);
+				--n;
+
+				auto const nRest = (std::uint64_t{ p1 } << -one.e) + p2;
+				if (nRest <= nDelta)
+				{
+					nDecimalExponent += static_cast<int>(n);
+					Round(pDigits, nLength, nDistance, nDelta, nRest, std::uint64_t{ nPow10 } << -one.e);
+					return;
+				}
+				nPow10 /= 10;
+			}
+
+			// The integral digits are not enough, continue with the fractional ones
+			int m = 0;
+			for (;;)
+			{
+				p2 *= 10;
+				pDigits[nLength++] = static_cast<char>('0' + (p2 >> -one.e));
+				p2 &= one.f - 1;
+				++m;
+
+				nDelta *= 10;
+				nDistance *= 10;
+				if (p2 <= nDelta) break;
+			}
+			nDecimalExponent -= m;
+			Round(pDigits, nLength, nDistance, nDelta, p2, one.f);
+		}
+
+		// Shortest digits of a finite and positive value: value ~= pDigits[0, nLength) * 10^nDecimalExponent
+		template<class Float>
+		void Grisu2(char* pDigits, size_t& nLength, int& nDecimalExponent, Float value) noexcept
+		{
+			auto const boundaries = ComputeBoundaries(value);
+			auto const cached = GetCachedPower(boundaries.plus.e);
+			DiyFp const c{ cached.f, cached.e };
+
+			auto const w = Multiply(boundaries.w, c);
+			auto const minus = Multiply(boundaries.minus, c);
+			auto const plus = Multiply(boundaries.plus, c);
+
+			// The products are within 1 ulp of the exact ones, so the boundaries are brought in by 1 ulp to stay safe
+			nLength = 0;
+			nDecimalExponent = -cached.k;
+			GenerateDigits(pDigits, nLength, nDecimalExponent, DiyFp{ minus.f + 1, minus.e }, w, DiyFp{ plus.f - 1, plus.e });
+		}
+
+		// Decimal point positions written without an exponent, as in JavaScript
+		constexpr int fixed_notation_min = -5;
+		constexpr int fixed_notation_max = 21;
+
+		char* WriteDigits(char* pOut, const char* pDigits, size_t nLength, int nDecimalExponent) noexcept
+		{
+			auto const k = static_cast<int>(nLength);
+			auto const n = k + nDecimalExponent; // Position of the decimal point from the first digit
+
+			if (k <= n && n <= fixed_notation_max)
+			{
+				// 1500
+				std::memcpy(pOut, pDigits, nLength);
+				std::memset(pOut + k, '0', static_cast<size_t>(n - k));
+				return pOut + n;
+			}
+
+			if (0 < n && n <= fixed_notation_max)
+			{
+				// 12.25
+				std::memcpy(pOut, pDigits, static_cast<size_t>(n));
+				pOut[n] = '.';
+				std::memcpy(pOut + n + 1, pDigits + n, static_cast<size_t>(k - n));
+				return pOut + k + 1;
+			}
+
+			if (fixed_notation_min <= n && n <= 0)
+			{
+				// 0.00125
+				pOut[0] = '0';
+				pOut[1] = '.';
+				std::memset(pOut + 2, '0', static_cast<size_t>(-n));
+				std::memcpy(pOut + 2 - n, pDigits, nLength);
+				return pOut + 2 - n + k;
+			}
+
+			// 1.25e+300
+			*pOut++ = pDigits[0];
+			if (k > 1)
+			{
+				*pOut++ = '.';
+				std::memcpy(pOut, pDigits + 1, nLength - 1);
+				pOut += k - 1;
+			}
+			*pOut++ = 'e';
+			*pOut++ = n - 1 < 0 ? '-' : '+';
+			return WriteUnsigned(pOut, static_cast<unsigned>(n - 1 < 0 ? 1 - n : n - 1));
+		}
+
+		template<class Float>
+		char* WriteFloat(char* pOut, Float val) noexcept
+		{
+			if (std::isnan(val))
+			{
+				std::memcpy(pOut, "nan", 3);
+				return pOut + 3;
+			}
+
+			if (std::signbit(val))
+			{
+				*pOut++ = '-';
+				val = -val;
+			}
+
+			if (std::isinf(val))
+			{
+				std::memcpy(pOut, "inf", 3);
+				return pOut + 3;
+			}
+
+			if (val == 0)
+			{
+				*pOut = '0';
+				return pOut + 1;
+			}
+
+			char digits[max_number_chars];
+			size_t nLength;
+			int nDecimalExponent;
+			Grisu2(digits, nLength, nDecimalExponent, val);
+			return WriteDigits(pOut, digits, nLength, nDecimalExponent);
+		}
+	}
+
+	char* WriteDecimal(char* pOut, int val) noexcept { return WriteSigned(pOut, val); }
+	char* WriteDecimal(char* pOut, unsigned int val) noexcept { return WriteUnsigned(pOut, val); }
+	char* WriteDecimal(char* pOut, long val) noexcept { return WriteSigned(pOut, val); }
+	char* WriteDecimal(char* pOut, unsigned long val) noexcept { return WriteUnsigned(pOut, val); }
+	char* WriteDecimal(char* pOut, long long val) noexcept { return WriteSigned(pOut, val); }
+	char* WriteDecimal(char* pOut, unsigned long long val) noexcept { return WriteUnsigned(pOut, val); }
+
+	char* WriteShortest(char* pOut, float val) noexcept { return WriteFloat(pOut, val); }
+	char* WriteShortest(char* pOut, double val) noexcept { return WriteFloat(pOut, val); }
+
+	char* WriteShortest(char* pOut, long double val) noexcept
+	{
+#if LDBL_MANT_DIG == DBL_MANT_DIG
+		return WriteFloat(pOut, static_cast<double>(val));
+#else
+		// Enough digits to round-trip, without the guarantee of being the shortest
+		auto const nResult = std::snprintf(pOut, max_number_chars, "%.*Lg", std::numeric_limits<long double>::max_digits10, val);
+		ASSERT(nResult > 0 && static_cast<size_t>(nResult) < max_number_chars);
+		return pOut + Math::Min(static_cast<size_t>(nResult > 0 ? nResult : 0), max_number_chars - 1);
+#endif
+	}
+}
\ No newline at end of file
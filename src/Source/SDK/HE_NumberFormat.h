@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace HE
+{
+	// Enough for the output of any WriteDecimal or WriteShortest
+	constexpr size_t max_number_chars = 32;
+
+	// Form: WriteDecimal(pOut, val) -> pEnd
+	// Writes val in base 10, with a '-' if it is negative, and returns the end of the output
+	// The digits are converted two at a time with a table, without snprintf or the locale
+	// Pre-condition: pOut has room for max_number_chars characters
+	char* WriteDecimal(char* pOut, int val) noexcept;
+	char* WriteDecimal(char* pOut, unsigned int val) noexcept;
+	char* WriteDecimal(char* pOut, long val) noexcept;
+	char* WriteDecimal(char* pOut, unsigned long val) noexcept;
+	char* WriteDecimal(char* pOut, long long val) noexcept;
+	char* WriteDecimal(char* pOut, unsigned long long val) noexcept;
+
+	// Form: WriteShortest(pOut, val) -> pEnd
+	// Writes the shortest decimal number that reads back as val, and returns the end of the output
+	// The digits come from Grisu2, which always round-trips and is the shortest in all but rare cases
+	// The notation is the same as JavaScript's Number.prototype.toString: "1500", "0.25", "0.000001", "1e-7",
+	// "1.5e+300". Infinities and NaN are written as "inf", "-inf" and "nan"
+	// long double goes through double when they have the same precision, and through snprintf otherwise
+	// Pre-condition: pOut has room for max_number_chars characters
+	char* WriteShortest(char* pOut, float val) noexcept;
+	char* WriteShortest(char* pOut, double val) noexcept;
+	char* WriteShortest(char* pOut, long double val) noexcept;
+}
\ No newline at end of file
@@ -21,6 +21,20 @@
 #define COMPILER_MSVC
 #endif
 
+// EMPTY_BASES
+// MSVC only applies the empty base optimization to one empty base of a class, unless it is marked with this
+// Goes between the class key and the class name
+#if defined(COMPILER_MSVC)
+#define EMPTY_BASES __declspec(empty_bases)
+#else
+#define EMPTY_BASES
+#endif
+
+// SSE2 is always available on x64
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define PLATFORM_SSE2
+#endif
+
 // ALIGNED_ALLOC
 // alignment must be a power of two
 #if defined(COMPILER_MSVC)
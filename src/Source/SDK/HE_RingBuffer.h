@@ -0,0 +1,320 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace HE
+{
+	namespace Private
+	{
+		// Capacities are rounded up to a power of two, so that positions wrap with a mask
+		inline size_t RingBufferCapacity(size_t nCapacity) noexcept
+		{
+			EXPECTS(nCapacity > 0);
+			return size_t{ 1 } << Math::CeilLog2(nCapacity);
+		}
+	}
+
+	// A bounded queue for exactly one producer thread and one consumer thread, without locks
+	// The producer only writes the tail and the consumer only writes the head, each on its own cache line. Both keep
+	// a cached copy of the other's index, so that they only read the other's cache line when the queue looks full or empty
+	// Batches publish all their elements with a single store
+	// The capacity is rounded up to a power of two. The storage is allocated on the Allocator on construction, which
+	// throws std::bad_alloc if it fails
+	template<class T, class Allocator = MallocAllocator>
+	class SPSCRingBuffer : private Allocator
+	{
+		static_assert(IsAllocator<Allocator>(), "SPSCRingBuffer's Allocator does not meet the HE::Allocator concept");
+		static_assert(std::is_nothrow_move_constructible<T>::value, "SPSCRingBuffer's T should be nothrow move constructible");
+
+		using Cell = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+	public:
+		explicit SPSCRingBuffer(size_t nCapacity) : m_nMask{ Private::RingBufferCapacity(nCapacity) - 1 }
+		{
+			m_block = Private::AllocateFor<Cell, Allocator>(*this, (m_nMask + 1) * sizeof(Cell));
+			m_pCells = static_cast<Cell*>(m_block.ptr);
+		}
+
+		SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+		SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+		~SPSCRingBuffer()
+		{
+			auto const nTail = m_nTail.load(std::memory_order_relaxed);
+			for (auto i = m_nHead.load(std::memory_order_relaxed); i != nTail; ++i) slot(i)->~T();
+			Allocator::deallocate(m_block);
+		}
+
+		// Producer only. Returns false if the queue is full, in which case nothing is constructed
+		template<class... Args>
+		bool tryEmplace(Args&&... args)
+		{
+			auto const nTail = m_nTail.load(std::memory_order_relaxed);
+			if (freeCount(nTail, 1) == 0) return false;
+
+			new (slot(nTail)) T(std::forward<Args>(args)...);
+			m_nTail.store(nTail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool tryPush(const T& value) { return tryEmplace(value); }
+		bool tryPush(T&& value) { return tryEmplace(std::move(value)); }
+
+		// Producer only. Pushes as many of the n elements from first as there is room for, and returns how many
+		template<class It>
+		size_t tryPushBatch(It first, size_t n) noexcept
+		{
+			static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value, "SPSCRingBuffer's batches should be constructed without throwing");
+
+			auto const nTail = m_nTail.load(std::memory_order_relaxed);
+			auto const nCount = freeCount(nTail, n);
+			for (size_t i = 0; i < nCount; ++i, ++first) new (slot(nTail + i)) T(*first);
+			if (nCount != 0) m_nTail.store(nTail + nCount, std::memory_order_release);
+			return nCount;
+		}
+
+		// Consumer only. Returns false if the queue is empty
+		bool tryPop(T& value)
+		{
+			auto const nHead = m_nHead.load(std::memory_order_relaxed);
+			if (readyCount(nHead, 1) == 0) return false;
+
+			auto const p = slot(nHead);
+			value = std::move(*p);
+			p->~T();
+			m_nHead.store(nHead + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only. Moves up to nMax elements to out, and returns how many
+		template<class OutIt>
+		size_t tryPopBatch(OutIt out, size_t nMax) noexcept
+		{
+			static_assert(noexcept(*out = std::declval<T&&>()), "SPSCRingBuffer's batches should be moved out without throwing");
+
+			auto const nHead = m_nHead.load(std::memory_order_relaxed);
+			auto const nCount = readyCount(nHead, nMax);
+			for (size_t i = 0; i < nCount; ++i, ++out)
+			{
+				auto const p = slot(nHead + i);
+				*out = std::move(*p);
+				p->~T();
+			}
+			if (nCount != 0) m_nHead.store(nHead + nCount, std::memory_order_release);
+			return nCount;
+		}
+
+		// Only exact when neither thread is using the queue
+		size_t sizeApprox() const noexcept
+		{
+			return m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire);
+		}
+
+		size_t capacity() const noexcept { return m_nMask + 1; }
+
+	private:
+		Blk m_block{ nullptr, 0 };
+		Cell* m_pCells{ nullptr };
+		size_t const m_nMask;
+		char m_padding0[PlatformCacheLineSize];
+		// Written by the producer
+		std::atomic<size_t> m_nTail{ 0 };
+		size_t m_nCachedHead{ 0 };
+		char m_padding1[PlatformCacheLineSize];
+		// Written by the consumer
+		std::atomic<size_t> m_nHead{ 0 };
+		size_t m_nCachedTail{ 0 };
+		char m_padding2[PlatformCacheLineSize];
+
+		T* slot(size_t i) const noexcept { return reinterpret_cast<T*>(m_pCells + (i & m_nMask)); }
+
+		// Number of slots the producer can fill, up to n
+		size_t freeCount(size_t nTail, size_t n) noexcept
+		{
+			auto nFree = capacity() - (nTail - m_nCachedHead);
+			if (nFree < n)
+			{
+				m_nCachedHead = m_nHead.load(std::memory_order_acquire);
+				nFree = capacity() - (nTail - m_nCachedHead);
+			}
+			return Math::Min(nFree, n);
+		}
+
+		// Number of elements the consumer can take, up to n
+		size_t readyCount(size_t nHead, size_t n) noexcept
+		{
+			auto nReady = m_nCachedTail - nHead;
+			if (nReady < n)
+			{
+				m_nCachedTail = m_nTail.load(std::memory_order_acquire);
+				nReady = m_nCachedTail - nHead;
+			}
+			return Math::Min(nReady, n);
+		}
+	};
+
+	// A bounded queue for any number of producer and consumer threads, without locks
+	// T must be nothrow move constructible and assignable, since a claimed cell cannot be given back
+	// Each cell has a sequence number telling whether it is ready to be written or read for the current lap of the
+	// ring (Dmitry Vyukov's bounded MPMC queue). Producers and consumers claim positions by compare-and-swap on their
+	// index, each on its own cache line, then only touch the cells they claimed
+	// A batch claims a range of consecutive ready cells with one compare-and-swap
+	// A thread preempted between claiming a cell and publishing it delays the threads that reach that cell on the
+	// next lap, but not the others
+	// The capacity is rounded up to a power of two. The storage is allocated on the Allocator on construction, which
+	// throws std::bad_alloc if it fails
+	template<class T, class Allocator = MallocAllocator>
+	class MPMCRingBuffer : private Allocator
+	{
+		static_assert(IsAllocator<Allocator>(), "MPMCRingBuffer's Allocator does not meet the HE::Allocator concept");
+		static_assert(std::is_nothrow_move_constructible<T>::value, "MPMCRingBuffer's T should be nothrow move constructible");
+
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+			T* value() noexcept { return reinterpret_cast<T*>(&storage); }
+		};
+
+	public:
+		explicit MPMCRingBuffer(size_t nCapacity) : m_nMask{ Private::RingBufferCapacity(nCapacity) - 1 }
+		{
+			m_block = Private::AllocateFor<Cell, Allocator>(*this, (m_nMask + 1) * sizeof(Cell));
+			m_pCells = static_cast<Cell*>(m_block.ptr);
+			for (size_t i = 0; i <= m_nMask; ++i) new (&m_pCells[i].sequence) std::atomic<size_t>{ i };
+		}
+
+		MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+		MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+		~MPMCRingBuffer()
+		{
+			auto const nTail = m_nTail.load(std::memory_order_relaxed);
+			for (auto i = m_nHead.load(std::memory_order_relaxed); i != nTail; ++i) cell(i).value()->~T();
+			Allocator::deallocate(m_block);
+		}
+
+		// Returns false if the queue is full
+		// The value is built before claiming a cell, since a claimed cell has to be published
+		template<class... Args>
+		bool tryEmplace(Args&&... args)
+		{
+			T value(std::forward<Args>(args)...);
+			return tryPush(std::move(value));
+		}
+
+		bool tryPush(const T& value)
+		{
+			T copy(value);
+			return tryPush(std::move(copy));
+		}
+
+		bool tryPush(T&& value) noexcept
+		{
+			auto const nTail = claim(m_nTail, 1, 0);
+			if (nTail.second == 0) return false;
+
+			auto& c = cell(nTail.first);
+			new (c.value()) T(std::move(value));
+			c.sequence.store(nTail.first + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Pushes as many of the n elements from first as there is room for, and returns how many
+		template<class It>
+		size_t tryPushBatch(It first, size_t n) noexcept
+		{
+			static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value, "MPMCRingBuffer's batches should be constructed without throwing");
+
+			auto const nTail = claim(m_nTail, n, 0);
+			for (size_t i = 0; i < nTail.second; ++i, ++first)
+			{
+				auto& c = cell(nTail.first + i);
+				new (c.value()) T(*first);
+				c.sequence.store(nTail.first + i + 1, std::memory_order_release);
+			}
+			return nTail.second;
+		}
+
+		// Returns false if the queue is empty
+		bool tryPop(T& value) noexcept
+		{
+			return tryPopBatch(&value, 1) == 1;
+		}
+
+		// Moves up to nMax elements to out, and returns how many
+		template<class OutIt>
+		size_t tryPopBatch(OutIt out, size_t nMax) noexcept
+		{
+			static_assert(noexcept(*out = std::declval<T&&>()), "MPMCRingBuffer's elements should be moved out without throwing");
+
+			auto const nHead = claim(m_nHead, nMax, 1);
+			for (size_t i = 0; i < nHead.second; ++i, ++out)
+			{
+				auto& c = cell(nHead.first + i);
+				auto const p = c.value();
+				*out = std::move(*p);
+				p->~T();
+				c.sequence.store(nHead.first + i + capacity(), std::memory_order_release);
+			}
+			return nHead.second;
+		}
+
+		// Only exact when no thread is using the queue
+		size_t sizeApprox() const noexcept
+		{
+			auto const nHead = m_nHead.load(std::memory_order_acquire);
+			auto const nTail = m_nTail.load(std::memory_order_acquire);
+			return nTail > nHead ? nTail - nHead : 0;
+		}
+
+		size_t capacity() const noexcept { return m_nMask + 1; }
+
+	private:
+		Blk m_block{ nullptr, 0 };
+		Cell* m_pCells{ nullptr };
+		size_t const m_nMask;
+		char m_padding0[PlatformCacheLineSize];
+		std::atomic<size_t> m_nTail{ 0 };
+		char m_padding1[PlatformCacheLineSize];
+		std::atomic<size_t> m_nHead{ 0 };
+		char m_padding2[PlatformCacheLineSize];
+
+		Cell& cell(size_t i) const noexcept { return m_pCells[i & m_nMask]; }
+
+		// Claims up to n consecutive cells from the index, and returns the first position and the number of cells
+		// A cell at position i is ready when its sequence is i + nLag: 0 for producers, 1 for consumers
+		// Only the thread that claims position i can change the sequence of a cell that is ready for it, so the cells
+		// checked before the compare-and-swap are still ready after it
+		std::pair<size_t, size_t> claim(std::atomic<size_t>& index, size_t n, size_t nLag) noexcept
+		{
+			auto nPosition = index.load(std::memory_order_relaxed);
+			if (n == 0) return{ nPosition, 0 };
+
+			for (;;)
+			{
+				size_t nCount = 0;
+				while (nCount < n && cell(nPosition + nCount).sequence.load(std::memory_order_acquire) == nPosition + nCount + nLag) ++nCount;
+
+				if (nCount == 0)
+				{
+					// The cell is behind: the queue is full for a producer, or empty for a consumer
+					auto const nSequence = cell(nPosition).sequence.load(std::memory_order_acquire);
+					if (static_cast<std::ptrdiff_t>(nSequence - (nPosition + nLag)) < 0) return{ nPosition, 0 };
+
+					// Another thread claimed the position
+					nPosition = index.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				if (index.compare_exchange_weak(nPosition, nPosition + nCount, std::memory_order_relaxed)) return{ nPosition, nCount };
+			}
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,264 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace HE
+{
+	// A vector that keeps its first N elements inline, and only allocates on the Parent allocator beyond that
+	// The storage comes from a FallbackAllocator of a LightInlineAllocator and the Parent. The vector only ever has
+	// one block, so the LightInlineAllocator handing out the same buffer every time is not a problem
+	// The Parent is held by value in every vector, so it must be stateless
+	// Inline elements are moved one by one when the vector is moved, but a heap block is stolen. Trivially copyable
+	// elements are grown with HE::reallocate, so that the Parent can resize the block in place
+	// Throws std::bad_alloc when the Parent fails
+	template<class T, size_t N, class Parent = MallocAllocator>
+	class SmallVector
+	{
+		static_assert(N > 0, "SmallVector's N should be higher than 0, or use a std::vector");
+		static_assert(IsStatelessAllocator<Parent>(), "SmallVector's Parent does not meet the HE::StatelessAllocator concept");
+
+		using Allocator = FallbackAllocator<LightInlineAllocator<N * sizeof(T)>, Parent>;
+		static_assert(alignof(T) <= Allocator::alignment, "SmallVector's T is over-aligned");
+
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		static constexpr size_t inline_capacity = N;
+
+		SmallVector() noexcept : m_block{ inlineBlock() } {}
+
+		SmallVector(std::initializer_list<T> values) : SmallVector{}
+		{
+			append(values.begin(), values.end());
+		}
+
+		SmallVector(const SmallVector& other) : SmallVector{}
+		{
+			append(other.begin(), other.end());
+		}
+
+		SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : SmallVector{}
+		{
+			take(other);
+		}
+
+		SmallVector& operator=(const SmallVector& other)
+		{
+			if (this != &other)
+			{
+				clear();
+				append(other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+		{
+			if (this != &other)
+			{
+				clear();
+				if (!isInline())
+				{
+					m_allocator.deallocate(m_block);
+					m_block = inlineBlock();
+				}
+				take(other);
+			}
+			return *this;
+		}
+
+		~SmallVector()
+		{
+			clear();
+			if (!isInline()) m_allocator.deallocate(m_block);
+		}
+
+		template<class... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (m_nSize == capacity())
+			{
+				// The arguments may refer to an element, so the new element is built before the storage moves
+				T value(std::forward<Args>(args)...);
+				grow(m_nSize + 1);
+				return *new (data() + m_nSize++) T(std::move(value));
+			}
+
+			return *new (data() + m_nSize++) T(std::forward<Args>(args)...);
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		void pop_back() noexcept
+		{
+			EXPECTS(m_nSize > 0);
+			data()[--m_nSize].~T();
+		}
+
+		// Erases the element, moving the following ones down
+		iterator erase(const_iterator position)
+		{
+			EXPECTS(position >= begin() && position < end());
+			auto const it = begin() + (position - begin());
+			std::move(it + 1, end(), it);
+			pop_back();
+			return it;
+		}
+
+		void clear() noexcept
+		{
+			destroy(data(), data() + m_nSize);
+			m_nSize = 0;
+		}
+
+		void reserve(size_t n)
+		{
+			if (n > capacity()) grow(n);
+		}
+
+		void resize(size_t n)
+		{
+			reserve(n);
+			while (m_nSize < n) new (data() + m_nSize++) T();
+			while (m_nSize > n) pop_back();
+		}
+
+		void resize(size_t n, const T& value)
+		{
+			reserve(n);
+			while (m_nSize < n) new (data() + m_nSize++) T(value);
+			while (m_nSize > n) pop_back();
+		}
+
+		T& operator[](size_t i) noexcept
+		{
+			EXPECTS(i < m_nSize);
+			return data()[i];
+		}
+
+		const T& operator[](size_t i) const noexcept
+		{
+			EXPECTS(i < m_nSize);
+			return data()[i];
+		}
+
+		T& front() noexcept { return (*this)[0]; }
+		const T& front() const noexcept { return (*this)[0]; }
+		T& back() noexcept { return (*this)[m_nSize - 1]; }
+		const T& back() const noexcept { return (*this)[m_nSize - 1]; }
+
+		T* data() noexcept { return static_cast<T*>(m_block.ptr); }
+		const T* data() const noexcept { return static_cast<const T*>(m_block.ptr); }
+
+		iterator begin() noexcept { return data(); }
+		iterator end() noexcept { return data() + m_nSize; }
+		const_iterator begin() const noexcept { return data(); }
+		const_iterator end() const noexcept { return data() + m_nSize; }
+		reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
+		reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
+
+		size_t size() const noexcept { return m_nSize; }
+		bool empty() const noexcept { return m_nSize == 0; }
+		size_t capacity() const noexcept { return m_block.length / sizeof(T); }
+
+		// True while the elements are in the inline buffer
+		bool isInline() const noexcept
+		{
+			auto const pBegin = reinterpret_cast<const char*>(&m_allocator);
+			auto const p = static_cast<const char*>(m_block.ptr);
+			return !std::less<const char*>{}(p, pBegin) && std::less<const char*>{}(p, pBegin + sizeof(m_allocator));
+		}
+
+	private:
+		Allocator m_allocator;
+		Blk m_block;
+		size_t m_nSize{ 0 };
+
+		Blk inlineBlock() noexcept
+		{
+			return m_allocator.allocate(N * sizeof(T));
+		}
+
+		template<class It>
+		void append(It first, It last)
+		{
+			reserve(m_nSize + std::distance(first, last));
+			for (; first != last; ++first) new (data() + m_nSize++) T(*first);
+		}
+
+		// Takes the elements of other, leaving it empty
+		void take(SmallVector& other)
+		{
+			if (other.isInline())
+			{
+				for (auto& value : other) new (data() + m_nSize++) T(std::move(value));
+				other.clear();
+			}
+			else
+			{
+				m_block = other.m_block;
+				m_nSize = other.m_nSize;
+				other.m_block = other.inlineBlock();
+				other.m_nSize = 0;
+			}
+		}
+
+		void grow(size_t n)
+		{
+			auto const nCapacity = Math::Max(n, 2 * capacity());
+			if (nCapacity > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_alloc{};
+
+			growImpl(nCapacity * sizeof(T), std::is_trivially_copyable<T>{});
+		}
+
+		void growImpl(size_t nBytes, std::true_type)
+		{
+			if (!reallocate(m_allocator, m_block, nBytes)) throw std::bad_alloc{};
+		}
+
+		void growImpl(size_t nBytes, std::false_type)
+		{
+			auto const b = m_allocator.allocate(nBytes);
+			if (!b.ptr) throw std::bad_alloc{};
+
+			auto const pNew = static_cast<T*>(b.ptr);
+			size_t i = 0;
+			try
+			{
+				for (; i < m_nSize; ++i) new (pNew + i) T(std::move_if_noexcept(data()[i]));
+			}
+			catch (...)
+			{
+				destroy(pNew, pNew + i);
+				m_allocator.deallocate(b);
+				throw;
+			}
+			destroy(data(), data() + m_nSize);
+
+			m_allocator.deallocate(m_block);
+			m_block = b;
+		}
+
+		static void destroy(T* first, T* last) noexcept
+		{
+			for (; first != last; ++first) first->~T();
+		}
+	};
+}
\ No newline at end of file
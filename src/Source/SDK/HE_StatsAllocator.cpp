@@ -0,0 +1,27 @@
+#include "HE_StatsAllocator.h"
+
+#include "HE_String.h"
+
+namespace HE
+{
+	std::string to_string(const AllocatorStats& stats)
+	{
+		auto s = Format(HE_FORMAT("allocations: {_} ({_} failed), deallocations: {_}, in use: {_} bytes, peak: {_} bytes"),
+			stats.allocations, stats.failedAllocations, stats.deallocations, stats.bytesInUse, stats.peakBytes);
+
+		for (size_t i = 0; i < AllocatorStats::histogram_size; ++i)
+		{
+			if (stats.histogram[i] == 0) continue;
+
+			if (i + 1 == AllocatorStats::histogram_size)
+			{
+				s += Format(HE_FORMAT("\n  > {_} bytes: {_}"), size_t{ 1 } << (i - 1), stats.histogram[i]);
+			}
+			else
+			{
+				s += Format(HE_FORMAT("\n  <= {_} bytes: {_}"), size_t{ 1 } << i, stats.histogram[i]);
+			}
+		}
+		return s;
+	}
+}
\ No newline at end of file
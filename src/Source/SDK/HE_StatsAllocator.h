@@ -0,0 +1,263 @@
+#pragma once
+
+#include "HE_Allocator.h"
+#include "HE_Platform.h"
+
+#include <string>
+
+namespace HE
+{
+	// Counters a StatsAllocator can collect, to combine in its Flags
+	// Counters that are not selected take no space and no time
+	namespace StatsFlags
+	{
+		enum : unsigned
+		{
+			Allocations = 1 << 0, // Number of successful and failed allocations
+			Deallocations = 1 << 1,
+			BytesInUse = 1 << 2, // Sum of the sizes of the live blocks, as requested by the client
+			PeakBytes = 1 << 3, // Highest BytesInUse reached
+			SizeHistogram = 1 << 4, // Number of allocations per power of 2 size class
+			CallSites = 1 << 5, // Stores the call site of each allocation in a prefix of the block
+
+			Counters = Allocations | Deallocations | BytesInUse | PeakBytes,
+			All = Counters | SizeHistogram | CallSites,
+		};
+	}
+
+	// Location of the code making an allocation
+	struct CallSite
+	{
+		const char* file;
+		int line;
+	};
+
+#define HE_CALL_SITE ::HE::CallSite{ __FILE__, __LINE__ }
+
+	// Snapshot of the counters of a StatsAllocator. The counters that were not selected are 0
+	struct AllocatorStats
+	{
+		// Bucket 0 counts allocations of 0 or 1 byte, bucket i counts allocations in (2^(i-1), 2^i], 
+		// and the last bucket counts everything bigger
+		static constexpr size_t histogram_size = 32;
+
+		size_t allocations;
+		size_t failedAllocations;
+		size_t deallocations;
+		size_t bytesInUse;
+		size_t peakBytes;
+		size_t histogram[histogram_size];
+
+		// Multi-line human readable dump, meant for HE::Log
+		friend std::string to_string(const AllocatorStats& stats);
+	};
+
+	namespace Private
+	{
+		template<int Id, bool Enabled>
+		class StatsCounter
+		{
+		public:
+			void add(size_t n) noexcept { m_nValue += n; }
+			void subtract(size_t n) noexcept { m_nValue -= n; }
+			void raise(size_t n) noexcept { if (n > m_nValue) m_nValue = n; }
+			void set(size_t n) noexcept { m_nValue = n; }
+			size_t value() const noexcept { return m_nValue; }
+
+		private:
+			size_t m_nValue{ 0 };
+		};
+
+		template<int Id>
+		class StatsCounter<Id, false>
+		{
+		public:
+			void add(size_t) noexcept {}
+			void subtract(size_t) noexcept {}
+			void raise(size_t) noexcept {}
+			void set(size_t) noexcept {}
+			size_t value() const noexcept { return 0; }
+		};
+
+		template<bool Enabled>
+		class StatsHistogram
+		{
+		public:
+			void record(size_t n) noexcept
+			{
+				auto const nBucket = n <= 1 ? 0 : Math::CeilLog2(n);
+				++m_buckets[nBucket < AllocatorStats::histogram_size ? nBucket : AllocatorStats::histogram_size - 1];
+			}
+
+			void reset() noexcept
+			{
+				for (auto& n : m_buckets) n = 0;
+			}
+
+			void copyTo(size_t(&buckets)[AllocatorStats::histogram_size]) const noexcept
+			{
+				for (size_t i = 0; i < AllocatorStats::histogram_size; ++i) buckets[i] = m_buckets[i];
+			}
+
+		private:
+			size_t m_buckets[AllocatorStats::histogram_size] = {};
+		};
+
+		template<>
+		class StatsHistogram<false>
+		{
+		public:
+			void record(size_t) noexcept {}
+			void reset() noexcept {}
+			void copyTo(size_t(&buckets)[AllocatorStats::histogram_size]) const noexcept
+			{
+				for (auto& n : buckets) n = 0;
+			}
+		};
+
+		template<class Parent, unsigned Flags>
+		using StatsParent = std::conditional_t<(Flags & StatsFlags::CallSites) != 0, AffixAllocator<Parent, CallSite>, Parent>;
+	}
+
+	// An allocator adaptor counting the operations made on its Parent, to find out which part of an allocator
+	// composition is hot. Give each subsystem its own StatsAllocator to get per-subsystem counters
+	// The counters are selected at compile-time with StatsFlags, ex:
+	//   StatsAllocator<FreelistAllocator<MallocAllocator, 16>, StatsFlags::Allocations | StatsFlags::PeakBytes>
+	// With StatsFlags::CallSites, each block is prefixed with the CallSite given to allocate(n, HE_CALL_SITE),
+	// which can be read back with callSite(b)
+	// Not thread-safe, like its Parent
+	template<class Parent, unsigned Flags = StatsFlags::Counters>
+	class EMPTY_BASES StatsAllocator
+		: private Private::StatsParent<Parent, Flags>
+		, private Private::StatsCounter<0, (Flags & StatsFlags::Allocations) != 0>
+		, private Private::StatsCounter<1, (Flags & StatsFlags::Allocations) != 0>
+		, private Private::StatsCounter<2, (Flags & StatsFlags::Deallocations) != 0>
+		, private Private::StatsCounter<3, (Flags & (StatsFlags::BytesInUse | StatsFlags::PeakBytes)) != 0>
+		, private Private::StatsCounter<4, (Flags & StatsFlags::PeakBytes) != 0>
+		, private Private::StatsHistogram<(Flags & StatsFlags::SizeHistogram) != 0>
+	{
+		static_assert(IsAllocator<Parent>(), "StatsAllocator's Parent does not meet the HE::Allocator concept");
+
+		using Inner = Private::StatsParent<Parent, Flags>;
+		using AllocationCount = Private::StatsCounter<0, (Flags & StatsFlags::Allocations) != 0>;
+		using FailureCount = Private::StatsCounter<1, (Flags & StatsFlags::Allocations) != 0>;
+		using DeallocationCount = Private::StatsCounter<2, (Flags & StatsFlags::Deallocations) != 0>;
+		using BytesInUse = Private::StatsCounter<3, (Flags & (StatsFlags::BytesInUse | StatsFlags::PeakBytes)) != 0>;
+		using PeakBytes = Private::StatsCounter<4, (Flags & StatsFlags::PeakBytes) != 0>;
+		using Histogram = Private::StatsHistogram<(Flags & StatsFlags::SizeHistogram) != 0>;
+
+	public:
+		static constexpr size_t alignment = Inner::alignment;
+		static constexpr unsigned flags = Flags;
+
+		Blk allocate(size_t n)
+		{
+			return record(Inner::allocate(n), n);
+		}
+
+		template<unsigned F = Flags, class = std::enable_if_t<(F & StatsFlags::CallSites) != 0>>
+		Blk allocate(size_t n, CallSite site)
+		{
+			auto b = allocate(n);
+			if (b.ptr) Inner::Prefix(b) = site;
+			return b;
+		}
+
+		template<class P = Inner, class = std::enable_if_t<is_aligned_allocator<P>::value>>
+		Blk allocate(size_t n, size_t alignment_requirement)
+		{
+			return record(Inner::allocate(n, alignment_requirement), n);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			if (!b.ptr) return;
+			DeallocationCount::add(1);
+			BytesInUse::subtract(b.length);
+			Inner::deallocate(b);
+		}
+
+		bool expand(Blk& b, size_t delta)
+		{
+			if (!Private::Expand(static_cast<Inner&>(*this), b, delta)) return false;
+
+			BytesInUse::add(delta);
+			PeakBytes::raise(BytesInUse::value());
+			return true;
+		}
+
+		bool reallocate(Blk& b, size_t n)
+		{
+			auto const nLength = b.length;
+			if (!Private::Reallocate(static_cast<Inner&>(*this), b, n)) return false;
+
+			BytesInUse::subtract(nLength);
+			BytesInUse::add(n);
+			PeakBytes::raise(BytesInUse::value());
+			return true;
+		}
+
+		template<class P = Inner, class = std::enable_if_t<has_op<P, Private::try_deallocateAll>::value>>
+		void deallocateAll()
+		{
+			BytesInUse::set(0);
+			Inner::deallocateAll();
+		}
+
+		template<class P = Inner, class = std::enable_if_t<is_owning_allocator<P>::value>>
+		bool owns(Blk b)
+		{
+			return Inner::owns(b);
+		}
+
+		// Call site given on allocation, or a null file if none was given
+		// Pre-condition: b was allocated by this allocator
+		template<unsigned F = Flags, class = std::enable_if_t<(F & StatsFlags::CallSites) != 0>>
+		static CallSite callSite(Blk b)
+		{
+			return Inner::Prefix(b);
+		}
+
+		AllocatorStats stats() const noexcept
+		{
+			AllocatorStats s;
+			s.allocations = AllocationCount::value();
+			s.failedAllocations = FailureCount::value();
+			s.deallocations = DeallocationCount::value();
+			s.bytesInUse = (Flags & StatsFlags::BytesInUse) ? BytesInUse::value() : 0;
+			s.peakBytes = PeakBytes::value();
+			Histogram::copyTo(s.histogram);
+			return s;
+		}
+
+		// Resets every counter, except the bytes in use. The peak restarts from the bytes in use
+		void resetStats() noexcept
+		{
+			AllocationCount::set(0);
+			FailureCount::set(0);
+			DeallocationCount::set(0);
+			PeakBytes::set(BytesInUse::value());
+			Histogram::reset();
+		}
+
+	private:
+		Blk record(Blk b, size_t n) noexcept
+		{
+			if (!b.ptr)
+			{
+				FailureCount::add(1);
+				return b;
+			}
+
+			setCallSite(b, CallSite{ nullptr, 0 }, std::integral_constant<bool, (Flags & StatsFlags::CallSites) != 0>{});
+			AllocationCount::add(1);
+			BytesInUse::add(n);
+			PeakBytes::raise(BytesInUse::value());
+			Histogram::record(n);
+			return b;
+		}
+
+		static void setCallSite(Blk b, CallSite site, std::true_type) noexcept { Inner::Prefix(b) = site; }
+		static void setCallSite(Blk, CallSite, std::false_type) noexcept {}
+	};
+}
\ No newline at end of file
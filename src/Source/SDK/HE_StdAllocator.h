@@ -0,0 +1,100 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <new>
+#include <limits>
+
+namespace HE
+{
+	namespace Private
+	{
+		template<class A>
+		using is_singleton_allocator = and_<is_stateless_allocator<A>, has_op<A, try_it>>;
+
+		// A stateful allocator is referred to by pointer
+		template<class A, bool Singleton = is_singleton_allocator<A>::value>
+		class StdAllocatorStorage
+		{
+		public:
+			explicit StdAllocatorStorage(A& a) noexcept : m_pAllocator{ &a } {}
+
+			A& allocator() const noexcept { return *m_pAllocator; }
+
+		private:
+			A* m_pAllocator;
+		};
+
+		// A stateless allocator is referred to through its singleton, so the storage is empty
+		template<class A>
+		class StdAllocatorStorage<A, true>
+		{
+		public:
+			StdAllocatorStorage() noexcept = default;
+			explicit StdAllocatorStorage(A&) noexcept {}
+
+			static A& allocator() noexcept { return A::it; }
+		};
+	}
+
+	// Adapts an HE allocator to the standard Allocator requirements, so that standard containers can use it
+	// Stateless allocators are used through their singleton (A::it), and the adaptor can be default constructed
+	// Stateful allocators are used by reference, so they must outlive the containers using them, ex:
+	//   StackAllocator<4096> stack;
+	//   std::vector<int, StdAllocator<int, StackAllocator<4096>>> v{ StdAllocator<int, StackAllocator<4096>>{ stack } };
+	// The allocator follows the container on copy, move and swap
+	// Types aligned beyond A::alignment are allocated with the aligned allocate, which A must then support
+	// allocate throws std::bad_alloc when A fails, as the standard requires
+	template<class T, class A>
+	class StdAllocator : private Private::StdAllocatorStorage<A>
+	{
+		static_assert(IsAllocator<A>(), "StdAllocator's A does not meet the HE::Allocator concept");
+
+		using Storage = Private::StdAllocatorStorage<A>;
+
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+		using is_always_equal = Private::is_singleton_allocator<A>;
+
+		template<class U>
+		struct rebind
+		{
+			using other = StdAllocator<U, A>;
+		};
+
+		StdAllocator() = default;
+		explicit StdAllocator(A& a) noexcept : Storage{ a } {}
+
+		template<class U>
+		StdAllocator(const StdAllocator<U, A>& other) noexcept : Storage{ other.allocator() } {}
+
+		T* allocate(size_t n)
+		{
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_alloc{};
+
+			return static_cast<T*>(Private::AllocateFor<T>(allocator(), n * sizeof(T)).ptr);
+		}
+
+		void deallocate(T* p, size_t n) noexcept
+		{
+			allocator().deallocate({ p, n * sizeof(T) });
+		}
+
+		using Storage::allocator;
+	};
+
+	template<class T, class U, class A>
+	bool operator==(const StdAllocator<T, A>& lhs, const StdAllocator<U, A>& rhs) noexcept
+	{
+		return &lhs.allocator() == &rhs.allocator();
+	}
+
+	template<class T, class U, class A>
+	bool operator!=(const StdAllocator<T, A>& lhs, const StdAllocator<U, A>& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+}
\ No newline at end of file
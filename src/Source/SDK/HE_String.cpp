@@ -1,55 +1,86 @@
 #include "HE_String.h"
 
-#include <mutex>
+#include <algorithm>
 #include <cstdarg>
 #include <cctype>
+#include <cstdio>
+#include <cstring>
 
 namespace
 {
+	bool IsLengthModifier(char c)
+	{
+		return c == 'h' || c == 'l' || c == 'L' || c == 'j' || c == 'z' || c == 't' || c == 'q';
+	}
+
+	constexpr size_t printf_format_capacity = 64;
+
+	// Builds "%<flags, width and precision><sLength><conversion>" from a to_string format specifier
+	// The conversion is the last letter of the specifier, or cDefaultConversion. A length modifier can be
+	// given before or after the conversion, but is always replaced by sLength
+	void MakePrintfFormat(char(&format)[printf_format_capacity], const char* pSpecifier, size_t nSpecifier, const char* sLength, char cDefaultConversion)
+	{
+		auto nBody = nSpecifier;
+		while (nBody != 0 && IsLengthModifier(pSpecifier[nBody - 1])) --nBody;
+
+		auto cConversion = cDefaultConversion;
+		if (nBody != 0 && std::isalpha(static_cast<unsigned char>(pSpecifier[nBody - 1])))
+		{
+			cConversion = pSpecifier[--nBody];
+		}
+		while (nBody != 0 && IsLengthModifier(pSpecifier[nBody - 1])) --nBody;
+
+		auto const nLength = std::strlen(sLength);
+		ASSERT_MSG(nBody + nLength + 3 <= printf_format_capacity, "Format specifier \""s + std::string(pSpecifier, nSpecifier) + "\" is too long");
+		nBody = std::min(nBody, printf_format_capacity - nLength - 3);
+
+		format[0] = '%';
+		std::memcpy(format + 1, pSpecifier, nBody);
+		std::memcpy(format + 1 + nBody, sLength, nLength);
+		format[1 + nBody + nLength] = cConversion;
+		format[2 + nBody + nLength] = '\0';
+	}
+
 	template< class T >
-	std::string to_string_impl(T arg, const std::string& sFormat)
+	size_t PrintFormat(char* pBuffer, size_t nSize, T val, const char* pSpecifier, size_t nSpecifier, const char* sLength, char cDefaultConversion)
 	{
-		using namespace std::string_literals;
+		char format[printf_format_capacity];
+		MakePrintfFormat(format, pSpecifier, nSpecifier, sLength, cDefaultConversion);
 
-		auto const sFormatSpecifier = "%" + sFormat;
-		auto const nStringSize = snprintf(nullptr, 0, sFormatSpecifier.c_str(), arg);
-		std::string sOutput(nStringSize + 1, '\0');
-		auto const nResult = snprintf(&sOutput[0], nStringSize + 1, sFormatSpecifier.c_str(), arg);
-		sOutput.resize(nStringSize);
-		ASSERT(nStringSize == nResult);
+		auto const nResult = std::snprintf(pBuffer, nSize, format, val);
+		ASSERT(nResult >= 0);
+		return nResult < 0 ? 0 : static_cast<size_t>(nResult);
+	}
 
-		return sOutput;
+	template< class T >
+	std::string to_string_decimal(T val)
+	{
+		char buffer[HE::max_number_chars];
+		return{ buffer, HE::WriteDecimal(buffer, val) };
 	}
 
 	template< class T >
-	std::string to_string_default(T val, const std::string& sFormat, const char sDefaultSpecifier[])
+	std::string to_string_shortest(T val)
 	{
-		if (std::isalpha(*rbegin(sFormat)))
-		{
-			return to_string_impl(val, sFormat);
-		}
-		else
-		{
-			return to_string_impl(val, sFormat + sDefaultSpecifier);
-		}
+		char buffer[HE::max_number_chars];
+		return{ buffer, HE::WriteShortest(buffer, val) };
 	}
 
 	template< class T >
-	std::string to_string_default(T val, const std::string& sFormat, const char sDefaultSpecifier[], const std::string& sDefaultArgumentType)
+	std::string to_string_format(T val, const std::string& sFormat)
 	{
-		auto const lastFormatChar = *rbegin(sFormat);
-		if (lastFormatChar == *crbegin(sDefaultArgumentType))
+		// Most conversions fit on the stack, and only the longer ones are printed twice
+		char buffer[HE::Private::print_format_buffer_size];
+		auto const nSize = HE::Private::PrintFormatArg(buffer, sizeof(buffer), val, sFormat.data(), sFormat.size());
+		if (nSize < sizeof(buffer))
 		{
-			return to_string_impl(val, sFormat);
-		}
-		else if (std::isalpha(lastFormatChar))
-		{
-			return to_string_impl(val, sFormat + sDefaultArgumentType);
-		}
-		else
-		{
-			return to_string_impl(val, sFormat + sDefaultSpecifier);
+			return{ buffer, nSize };
 		}
+
+		std::string sOutput(nSize + 1, '\0');
+		HE::Private::PrintFormatArg(&sOutput[0], nSize + 1, val, sFormat.data(), sFormat.size());
+		sOutput.resize(nSize);
+		return sOutput;
 	}
 }
 
@@ -88,96 +119,236 @@ std::string to_string(const std::exception& e)
 	return sOutput;
 }
 
+std::string to_string(int val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(unsigned int val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(long val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(unsigned long val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(long long val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(unsigned long long val)
+{
+	return to_string_decimal(val);
+}
+
+std::string to_string(float f)
+{
+	return to_string_shortest(f);
+}
+
+std::string to_string(double f)
+{
+	return to_string_shortest(f);
+}
+
+std::string to_string(long double f)
+{
+	return to_string_shortest(f);
+}
+
 std::string to_string(void* p)
 {
-	return to_string_impl(p, "p");
+	return to_string_format(p, {});
 }
 
 std::string to_string(int val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "d");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(unsigned int val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "u");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(long val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "dl", "l");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(unsigned long val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "ul", "l");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(long long val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "dll", "ll");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(unsigned long long val, const std::string& sFormat)
 {
-	return to_string_default(val, sFormat, "ull", "ll");
+	return to_string_format(val, sFormat);
 }
 
 std::string to_string(float f, const std::string& sFormat)
 {
-	return to_string_default(f, sFormat, "f");
+	return to_string_format(f, sFormat);
 }
 
 
 std::string to_string(double f, const std::string& sFormat)
 {
-	return to_string_default(f, sFormat, "f");
+	return to_string_format(f, sFormat);
 }
 
 std::string to_string(long double f, const std::string& sFormat)
 {
-	return to_string_default(f, sFormat, "fL");
+	return to_string_format(f, sFormat);
 }
 
 std::string to_string(void* p, const std::string& sFormat)
 {
-	return to_string_default(p, sFormat, "p");
+	return to_string_format(p, sFormat);
 }
 
 namespace HE
 {
-	namespace
+	namespace Private
 	{
-		std::mutex s_mutLog;
-		std::mutex s_mutLogError;
-	}
+		namespace
+		{
+			// Index of a format token in [pFirst, pLast): digits, or "_" for nNextArg
+			size_t ParseFormatArgIndex(const char* pFirst, const char* pLast, size_t nNextArg)
+			{
+				if (pLast - pFirst == 1 && *pFirst == '_')
+				{
+					return nNextArg;
+				}
 
-	void Log(const char* psMsg) noexcept
-	{
-		try
+				ASSERT_MSG(pFirst != pLast, "Format token index should be digits or '_'");
+				size_t nIndex = 0;
+				for (; pFirst != pLast; ++pFirst)
+				{
+					ASSERT_MSG(*pFirst >= '0' && *pFirst <= '9', "Format token index should be digits or '_'");
+					nIndex = nIndex * 10 + static_cast<size_t>(*pFirst - '0');
+				}
+				return nIndex;
+			}
+		}
+
+		void FormatErased(FormatSink& sink, const char* pFormat, size_t nFormat, const FormatArg* pArgs, size_t nArgs)
 		{
-			std::lock_guard<std::mutex> lock{ s_mutLog };
-			std::puts(psMsg);
+			size_t nNextArg = 0;
+			size_t i = 0;
+			while (i < nFormat)
+			{
+				// Find the next format token
+				auto const pToken = static_cast<const char*>(std::memchr(pFormat + i, '{', nFormat - i));
+
+				// Add to the output all the characters up until the next format token (or the end)
+				// and process the format token if necessary
+				if (!pToken)
+				{
+					sink.write(pFormat + i, nFormat - i);
+					break;
+				}
+
+				auto const posToken = static_cast<size_t>(pToken - pFormat);
+				// The sequence "\{" is not a token start, and outputs a '{'
+				if (posToken != 0 && pFormat[posToken - 1] == '\\')
+				{
+					sink.write(pFormat + i, posToken - 1 - i);
+					sink.write("{", 1);
+					i = posToken + 1;
+					continue;
+				}
+
+				// Otherwise, we have a format token
+				sink.write(pFormat + i, posToken - i); // Add everything before the token
+
+				auto const pEndToken = static_cast<const char*>(std::memchr(pToken, '}', nFormat - posToken));
+				ASSERT_MSG(pEndToken != nullptr, "Token error in string format \"" + std::string(pFormat, nFormat) + "\"");
+				if (!pEndToken) break;
+
+				// Find the index of the current arg for this token, and the specifier after the ':'
+				auto const pColon = static_cast<const char*>(std::memchr(pToken, ':', static_cast<size_t>(pEndToken - pToken)));
+				auto const argPos = ParseFormatArgIndex(pToken + 1, pColon ? pColon : pEndToken, nNextArg);
+				nNextArg = argPos + 1;
+				i = static_cast<size_t>(pEndToken - pFormat) + 1;
+
+				ASSERT_MSG(argPos < nArgs, "String format token number was higher than the number of arguments");
+				if (argPos >= nArgs) continue;
+
+				// Add the formatted argument to the output
+				auto const& arg = pArgs[argPos];
+				if (pColon)
+				{
+					arg.pWrite(sink, arg.pArg, pColon + 1, static_cast<size_t>(pEndToken - pColon - 1));
+				}
+				else
+				{
+					arg.pWrite(sink, arg.pArg, nullptr, 0);
+				}
+			}
 		}
-		catch (const std::system_error& e)
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, int val, const char* pSpecifier, size_t nSpecifier)
 		{
-			// Desperate attempt at logging the exception despite the lack of lock
-			LogError(Format("Error while attempting to log \"{_}\". The returned error was {_}", psMsg, e));
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "", 'd');
 		}
-	}
 
-	void LogError(const char* psMsg) noexcept
-	{
-		try
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned int val, const char* pSpecifier, size_t nSpecifier)
 		{
-			std::lock_guard<std::mutex> lock{ s_mutLog };
-			std::fputs(psMsg, stderr);
-			std::fputs("\n", stderr);
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "", 'u');
 		}
-		catch (const std::system_error& e)
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "l", 'd');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned long val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "l", 'u');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long long val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "ll", 'd');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned long long val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "ll", 'u');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, float val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "", 'f');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, double val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "", 'f');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long double val, const char* pSpecifier, size_t nSpecifier)
+		{
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "L", 'f');
+		}
+
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, void* val, const char* pSpecifier, size_t nSpecifier)
 		{
-			// Desperate attempt at logging the exception despite the lack of lock
-			std::fputs(Format("Error while attempting to log \"{_}\". The returned error was {_}\n", psMsg, e).c_str(), stderr);
+			return PrintFormat(pBuffer, nSize, val, pSpecifier, nSpecifier, "", 'p');
 		}
 	}
 }
\ No newline at end of file
@@ -2,11 +2,18 @@
 
 #include <gsl.h>
 #include <string>
+#include <algorithm>
+#include <array>
 #include <cstdarg>
+#include <cstring>
 #include <typeinfo>
 #include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
 
 #include "HE_Assert.h"
+#include "HE_NumberFormat.h"
 #include "TMP_Helper.h"
 
 // Utility function that calls the right variadic formatting functions and returns an RAII string
@@ -14,8 +21,18 @@ std::string CStringFormat(const char* sFormat, va_list args);
 std::string CStringFormat(const char* sFormat, ...);
 
 // Default to_string functions
-using std::to_string;
+// The numbers are written by WriteDecimal and WriteShortest (see HE_NumberFormat.h) instead of snprintf: the
+// floating-point numbers get the shortest digits that read back to the same value, ex: "0.1" instead of "0.100000"
 using gsl::to_string;
+std::string to_string(int val);
+std::string to_string(unsigned int val);
+std::string to_string(long val);
+std::string to_string(unsigned long val);
+std::string to_string(long long val);
+std::string to_string(unsigned long long val);
+std::string to_string(float val);
+std::string to_string(double val);
+std::string to_string(long double val);
 std::string to_string(const std::exception& e);
 std::string to_string(void* p);
 
@@ -33,21 +50,28 @@ inline std::string to_string(const char* s) { return{ s }; }
 // default specifier for the type will be used (ex: d for int, u for unsigned, f for float, etc...)
 // On top of that, for long sized types, only the conversion specifier without the argument type can be
 // supplied. For example, for unsigned long, the format could be " .4o", which will be converted to
-// " .4ol". Supplying " .4ol" itself would also work
+// " .4lo". Supplying " .4lo" or " .4ol" itself would also work
 std::string to_string(int val, const std::string& sFormat); // Defaults to %[sFormat]d
 std::string to_string(unsigned int val, const std::string& sFormat); // Defaults to %[sFormat]u
-std::string to_string(long val, const std::string& sFormat); // Defaults to %[sFormat]dl
-std::string to_string(unsigned long val, const std::string& sFormat); // Defaults to %[sFormat]ul
-std::string to_string(long long val, const std::string& sFormat); // Defaults to %[sFormat]dll
-std::string to_string(unsigned long long val, const std::string& sFormat); // Defaults to %[sFormat]ull
+std::string to_string(long val, const std::string& sFormat); // Defaults to %[sFormat]ld
+std::string to_string(unsigned long val, const std::string& sFormat); // Defaults to %[sFormat]lu
+std::string to_string(long long val, const std::string& sFormat); // Defaults to %[sFormat]lld
+std::string to_string(unsigned long long val, const std::string& sFormat); // Defaults to %[sFormat]llu
 std::string to_string(float val, const std::string& sFormat); // Defaults to %[sFormat]f
 std::string to_string(double val, const std::string& sFormat); // Defaults to %[sFormat]f
-std::string to_string(long double val, const std::string& sFormat); // Defaults to %[sFormat]fL
+std::string to_string(long double val, const std::string& sFormat); // Defaults to %[sFormat]Lf
 std::string to_string(void* val, const std::string& sFormat); // Defaults to %[sFormat]p
 
 
 namespace HE
 {
+	// Result of FormatTo into a buffer
+	struct FormatToResult
+	{
+		char* out; // Past the last character written
+		size_t size; // Size of the whole formatted string, greater than the buffer's if the output was truncated
+	};
+
 	namespace Private
 	{
 		template<class T>
@@ -62,65 +86,228 @@ namespace HE
 		template<class T>
 		using has_format_specifier = has_op<T, try_format_specifier >;
 
-		template< typename Arg >
-		std::string FormatIthArgN(size_t i, size_t n, Arg&& arg)
+		// Prints val in the buffer with snprintf, in the same format as to_string(val, sSpecifier)
+		// An empty specifier uses the default conversion. Returns the size of the whole conversion, like snprintf
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, int val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned int val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned long val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long long val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, unsigned long long val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, float val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, double val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, long double val, const char* pSpecifier, size_t nSpecifier);
+		size_t PrintFormatArg(char* pBuffer, size_t nSize, void* val, const char* pSpecifier, size_t nSpecifier);
+
+		// Arguments printed with PrintFormatArg instead of a temporary string
+		template<class T>
+		using is_print_format_arg = or_<std::is_same<T, int>, std::is_same<T, unsigned int>, std::is_same<T, long>, std::is_same<T, unsigned long>,
+			std::is_same<T, long long>, std::is_same<T, unsigned long long>, std::is_same<T, float>, std::is_same<T, double>,
+			std::is_same<T, long double>, std::is_same<T, void*>>;
+
+		// Arguments written as they are
+		template<class T>
+		using is_string_format_arg = or_<std::is_same<T, std::string>, std::is_same<T, const char*>, std::is_same<T, char*>>;
+
+		// Format output appended to a string
+		class FormatStringWriter
 		{
-			ASSERT_MSG(i == n, "String format token number was higher than the number of arguments");
-			return to_string(std::forward<Arg>(arg));
-		}
+		public:
+			explicit FormatStringWriter(std::string& sOutput) noexcept : m_sOutput(sOutput) {}
+
+			void write(const char* p, size_t n) { m_sOutput.append(p, n); }
+
+		private:
+			std::string& m_sOutput;
+		};
+
+		// Format output written through an output iterator
+		template<class OutputIt>
+		class FormatIteratorWriter
+		{
+		public:
+			explicit FormatIteratorWriter(OutputIt out) : m_out(out) {}
+
+			void write(const char* p, size_t n) { m_out = std::copy(p, p + n, m_out); }
+			OutputIt out() const { return m_out; }
+
+		private:
+			OutputIt m_out;
+		};
+
+		// Format output written in a buffer up to its capacity. What does not fit is only counted
+		class FormatBufferWriter
+		{
+		public:
+			FormatBufferWriter(char* pBuffer, size_t nCapacity) noexcept : m_pBuffer(pBuffer), m_nCapacity(nCapacity) {}
+
+			void write(const char* p, size_t n) noexcept
+			{
+				if (m_nSize < m_nCapacity)
+				{
+					auto const nCopy = n < m_nCapacity - m_nSize ? n : m_nCapacity - m_nSize;
+					std::memcpy(m_pBuffer + m_nSize, p, nCopy);
+				}
+				m_nSize += n;
+			}
+
+			char* out() const noexcept { return m_pBuffer + (m_nSize < m_nCapacity ? m_nSize : m_nCapacity); }
+			size_t size() const noexcept { return m_nSize; }
+
+		private:
+			char* m_pBuffer;
+			size_t m_nCapacity;
+			size_t m_nSize{ 0 };
+		};
 
-		template< typename Arg1, typename... Args >
-		std::string FormatIthArgN(size_t i, size_t n, Arg1&& arg, Args&&... args)
+		// Most conversions fit in this, and the others go through a string
+		constexpr size_t print_format_buffer_size = 128;
+
+		template<class Writer, class T>
+		void WritePrintFormatArg(Writer& writer, T val, const char* pSpecifier, size_t nSpecifier)
 		{
-			if (i == n)
+			char buffer[print_format_buffer_size];
+			auto const nSize = PrintFormatArg(buffer, print_format_buffer_size, val, pSpecifier, nSpecifier);
+			if (nSize < print_format_buffer_size)
 			{
-				return to_string(std::forward<Arg1>(arg));
+				writer.write(buffer, nSize);
 			}
 			else
 			{
-				return FormatIthArgN(i, n + 1, std::forward<Args>(args)...);
+				std::string sOutput(nSize + 1, '\0');
+				PrintFormatArg(&sOutput[0], nSize + 1, val, pSpecifier, nSpecifier);
+				writer.write(sOutput.data(), nSize);
 			}
 		}
 
-		template< typename Arg>
-		auto FormatIthArgFN(size_t i, size_t n, const std::string& format, Arg&& arg)
-			-> std::enable_if_t<has_format_specifier<Arg>::value, std::string>
+		template<class Writer, class T>
+		auto WriteNumberFormatArg(Writer& writer, T val)
+			-> std::enable_if_t<std::is_integral<T>::value>
+		{
+			char buffer[max_number_chars];
+			writer.write(buffer, static_cast<size_t>(WriteDecimal(buffer, val) - buffer));
+		}
+
+		template<class Writer, class T>
+		auto WriteNumberFormatArg(Writer& writer, T val)
+			-> std::enable_if_t<std::is_floating_point<T>::value>
+		{
+			char buffer[max_number_chars];
+			writer.write(buffer, static_cast<size_t>(WriteShortest(buffer, val) - buffer));
+		}
+
+		template<class Writer>
+		void WriteNumberFormatArg(Writer& writer, void* p)
+		{
+			WritePrintFormatArg(writer, p, "", 0);
+		}
+
+		template<class Writer>
+		void WriteFormatString(Writer& writer, const std::string& s) { writer.write(s.data(), s.size()); }
+
+		template<class Writer>
+		void WriteFormatString(Writer& writer, const char* s) { writer.write(s, std::strlen(s)); }
+
+		// Writes to_string(arg), without a temporary string for the built-in numbers and strings
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer& writer, Arg&& arg)
+			-> std::enable_if_t<is_print_format_arg<std::decay_t<Arg>>::value>
+		{
+			WriteNumberFormatArg(writer, static_cast<std::decay_t<Arg>>(arg));
+		}
+
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer& writer, Arg&& arg)
+			-> std::enable_if_t<is_string_format_arg<std::decay_t<Arg>>::value>
+		{
+			WriteFormatString(writer, arg);
+		}
+
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer& writer, Arg&& arg)
+			-> std::enable_if_t<!is_print_format_arg<std::decay_t<Arg>>::value && !is_string_format_arg<std::decay_t<Arg>>::value>
+		{
+			auto&& sArg = to_string(std::forward<Arg>(arg));
+			writer.write(sArg.data(), sArg.size());
+		}
+
+		// Writes to_string(arg, sSpecifier)
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer& writer, Arg&& arg, const char* pSpecifier, size_t nSpecifier)
+			-> std::enable_if_t<is_print_format_arg<std::decay_t<Arg>>::value>
+		{
+			WritePrintFormatArg(writer, arg, pSpecifier, nSpecifier);
+		}
+
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer& writer, Arg&& arg, const char* pSpecifier, size_t nSpecifier)
+			-> std::enable_if_t<!is_print_format_arg<std::decay_t<Arg>>::value && has_format_specifier<Arg>::value>
 		{
-			ASSERT_MSG(i == n, "String format token number was higher than the number of arguments");
-			return to_string(std::forward<Arg>(arg), format);
+			auto&& sArg = to_string(std::forward<Arg>(arg), std::string(pSpecifier, nSpecifier));
+			writer.write(sArg.data(), sArg.size());
 		}
 
-		template< typename Arg >
-		auto FormatIthArgFN(size_t i, size_t n, const std::string& format, Arg&& arg)
-			-> std::enable_if_t<!has_format_specifier<Arg>::value, std::string>
+		template<class Writer, class Arg>
+		auto WriteFormatArg(Writer&, Arg&&, const char*, size_t)
+			-> std::enable_if_t<!has_format_specifier<Arg>::value>
 		{
-			ASSERT_MSG(false , "A format specifier was supplied with type "s + typeid(Arg).name() + " which that does not support it");
-			return "";
+			ASSERT_MSG(false, "A format specifier was supplied with type "s + typeid(Arg).name() + " which that does not support it");
 		}
 
-		template< typename Arg1, typename... Args >
-		std::string FormatIthArgFN(size_t i, size_t n, const std::string& format, Arg1&& arg, Args&&... args)
+		// A writer behind a function pointer, so that the run-time format strings are parsed by a single function
+		class FormatSink
+		{
+		public:
+			template<class Writer, class = std::enable_if_t<!std::is_same<Writer, FormatSink>::value>>
+			explicit FormatSink(Writer& writer) noexcept : m_pWriter(&writer), m_pWrite(&WriteTo<Writer>) {}
+
+			void write(const char* p, size_t n) { m_pWrite(m_pWriter, p, n); }
+
+		private:
+			template<class Writer>
+			static void WriteTo(void* pWriter, const char* p, size_t n) { static_cast<Writer*>(pWriter)->write(p, n); }
+
+			void* m_pWriter;
+			void(*m_pWrite)(void*, const char*, size_t);
+		};
+
+		// An argument of a run-time format, and the function writing it with an optional specifier
+		struct FormatArg
 		{
-			if (i == n)
+			const void* pArg;
+			void(*pWrite)(FormatSink& sink, const void* pArg, const char* pSpecifier, size_t nSpecifier);
+		};
+
+		template<class Arg>
+		void WriteErasedFormatArg(FormatSink& sink, const void* pArg, const char* pSpecifier, size_t nSpecifier)
+		{
+			auto& arg = *static_cast<Arg*>(const_cast<void*>(pArg));
+			if (pSpecifier)
 			{
-				return FormatIthArgFN(i, n, format, std::forward<Arg1>(arg));
+				WriteFormatArg(sink, arg, pSpecifier, nSpecifier);
 			}
 			else
 			{
-				return FormatIthArgFN(i, n + 1, format, std::forward<Args>(args)...);
+				WriteFormatArg(sink, arg);
 			}
 		}
 
-		template< typename... Args >
-		std::string FormatIthArg(size_t i, Args&&... args)
+		template<class Arg>
+		FormatArg MakeFormatArg(Arg& arg) noexcept
 		{
-			return FormatIthArgN(i, 0, std::forward<Args>(args)...);
+			return{ std::addressof(arg), &WriteErasedFormatArg<Arg> };
 		}
 
-		template< typename... Args >
-		std::string FormatIthArgF(size_t i, const std::string& format, Args&&... args)
+		// Formats a run-time format string to the sink, where each token writes pArgs[index]
+		void FormatErased(FormatSink& sink, const char* pFormat, size_t nFormat, const FormatArg* pArgs, size_t nArgs);
+
+		// The arguments are erased once, so that each token is an indexed call instead of a walk through the pack
+		template<class Writer, typename... Args>
+		void FormatToWriter(Writer& writer, const char* pFormat, size_t nFormat, Args&... args)
 		{
-			return FormatIthArgFN(i, 0, format, std::forward<Args>(args)...);
+			FormatSink sink{ writer };
+			std::array<FormatArg, sizeof...(Args)> const formatArgs = { { MakeFormatArg(args)... } };
+			FormatErased(sink, pFormat, nFormat, formatArgs.data(), formatArgs.size());
 		}
 	}
 
@@ -165,100 +352,58 @@ namespace HE
 	{
 		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
 
-		using namespace HE::Private;
-
 		std::string sOutput;
-		size_t nNextArg = 0;
-		for (size_t i = 0; i < sFormat.size(); ++i)
-		{
-			// Find the next format token
-			auto const posToken = sFormat.find_first_of('{', i);
-
-			// Add to the output all the characters up until the next format token (or the end)
-			// and process the format token if necessary
-			if (posToken == std::string::npos)
-			{
-				sOutput += sFormat.substr(i);
-				break;
-			}
-			// The sequence "\{" is not a token start, so we continue as if it was a normal character
-			else if (posToken != 0 && sFormat[posToken - 1] == '\\')
-			{
-				sOutput += sFormat.substr(i, posToken - i);
-				i = posToken;
-				continue;
-			}
-			// Otherwise, we have a format token
-			else
-			{
-				sOutput += sFormat.substr(i, posToken - i); // Add everything before the token
-
-				auto const endToken = sFormat.find_first_of('}', posToken);
-				i = endToken;
-				ASSERT_MSG(endToken != std::string::npos, "Token error in string format \"" + sFormat + "\"");
-
-				// Find the index token inside the whole token
-				auto const sFormatToken = sFormat.substr(posToken + 1, (endToken - 1) - posToken);
-				auto const nSpecifierSentinel = sFormatToken.find_first_of(':');
-				auto const sIndexToken = [sFormatToken, nSpecifierSentinel]() {
-					if (nSpecifierSentinel == std::string::npos)
-					{
-						return sFormatToken;
-					}
-					else
-					{
-						return sFormatToken.substr(0, nSpecifierSentinel);
-					}
-				}();
-				
-				// Find the index of the current arg for this token
-				auto const argPos = [sIndexToken, nNextArg]() -> size_t {
-					if (sIndexToken == "_")
-					{
-						return nNextArg;
-					}
-					else
-					{
-						return std::stoi(sIndexToken);
-					}
-				}();
-				nNextArg = argPos + 1;
-				
-				// Add the formatted argument to the output
-				if (nSpecifierSentinel == std::string::npos)
-				{	
-					sOutput += FormatIthArg(argPos, std::forward<Args>(args)...);
-				}
-				else
-				{
-					auto const sSpecifierToken = sFormatToken.substr(nSpecifierSentinel + 1);
-					sOutput += FormatIthArgF(argPos, sSpecifierToken, std::forward<Args>(args)...);
-				}
-			}
-		}
-
+		Private::FormatStringWriter writer{ sOutput };
+		Private::FormatToWriter(writer, sFormat.data(), sFormat.size(), args...);
 		return sOutput;
 	}
-	
-	// Thread-safe logging
-	void Log(const char* psMsg) noexcept;
-	inline void Log(const std::string& sMsg) noexcept { Log(sMsg.c_str()); }
-	void LogError(const char* psMsg) noexcept;
-	inline void LogError(const std::string& sMsg) noexcept { LogError(sMsg.c_str()); }
-	
 
+	// Form: FormatTo(buffer, sFormat, args...) -> { out, size }
+	// Formats like Format, but into a buffer supplied by the caller instead of a new string
+	// The output is truncated to the size of the buffer, and is not null-terminated
+	// The built-in numbers and strings are written without allocating, so that formatting into a stack buffer
+	// does not touch the heap. Other arguments still go through their to_string
 	template< typename... Args>
-	void Log(const std::string& sFormat, Args&&... args)
+	FormatToResult FormatTo(gsl::span<char> buffer, gsl::czstring<> sFormat, Args&&... args)
 	{
-		Log(Format(sFormat, std::forward<Args>(args)...));
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		Private::FormatBufferWriter writer{ buffer.data(), static_cast<size_t>(buffer.size()) };
+		Private::FormatToWriter(writer, sFormat, std::strlen(sFormat), args...);
+		return{ writer.out(), writer.size() };
 	}
 
+	// Form: FormatTo(out, sFormat, args...) -> out
+	// Writes through an output iterator, ex: std::back_inserter(vector), and returns the iterator past the output
+	// Pointers have no bound, and are not accepted: use a gsl::span<char> instead
+	template<class OutputIt, typename... Args>
+	auto FormatTo(OutputIt out, gsl::czstring<> sFormat, Args&&... args)
+		-> std::enable_if_t<!std::is_pointer<OutputIt>::value && !std::is_convertible<OutputIt, gsl::span<char>>::value, OutputIt>
+	{
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		Private::FormatIteratorWriter<OutputIt> writer{ out };
+		Private::FormatToWriter(writer, sFormat, std::strlen(sFormat), args...);
+		return writer.out();
+	}
+
+	// Size of Format(sFormat, args...), without writing it
 	template< typename... Args>
-	void LogError(const std::string& sFormat, Args&&... args)
+	size_t FormattedSize(gsl::czstring<> sFormat, Args&&... args)
 	{
-		LogError(Format(sFormat, std::forward<Args>(args)...));
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		Private::FormatBufferWriter writer{ nullptr, 0 };
+		Private::FormatToWriter(writer, sFormat, std::strlen(sFormat), args...);
+		return writer.size();
 	}
 
+	// Thread-safe logging
+	void Log(const char* psMsg) noexcept;
+	inline void Log(const std::string& sMsg) noexcept { Log(sMsg.c_str()); }
+	void LogError(const char* psMsg) noexcept;
+	inline void LogError(const std::string& sMsg) noexcept { LogError(sMsg.c_str()); }
+
 	// Constexpr-friendly string
 	template<class Char = char>
 	class basic_constexpr_string
@@ -274,6 +419,7 @@ namespace HE
 		}
 
 		constexpr size_t size() const noexcept { return m_nSize; }
+		constexpr const Char* data() const noexcept { return m_pStr; }
 
 	private:
 		const Char* const m_pStr;
@@ -284,4 +430,232 @@ namespace HE
 	using constexpr_wstring = basic_constexpr_string<wchar_t>;
 	using constexpr_u16string = basic_constexpr_string<char16_t>;
 	using constexpr_u32string = basic_constexpr_string<char32_t>;
-}
\ No newline at end of file
+
+	// A format string parsed during compilation, made with HE_FORMAT
+	// S is a type with a static constexpr function value() returning the string as a constexpr_string
+	template<class S>
+	struct FormatString {};
+
+	template<class S>
+	constexpr FormatString<S> MakeFormatString(S) noexcept { return{}; }
+
+	namespace Private
+	{
+		constexpr size_t format_invalid_index = static_cast<size_t>(-1);
+
+		// Position of the first c in [nFirst, nLast), or nLast if there is none
+		// The range is split in halves, so that the recursion depth is logarithmic
+		constexpr size_t FindFormatChar(constexpr_string s, size_t nFirst, size_t nLast, char c);
+
+		constexpr size_t FindFormatCharInSecondHalf(size_t nFound, constexpr_string s, size_t nMiddle, size_t nLast, char c)
+		{
+			return nFound != nMiddle ? nFound : FindFormatChar(s, nMiddle, nLast, c);
+		}
+
+		constexpr size_t FindFormatChar(constexpr_string s, size_t nFirst, size_t nLast, char c)
+		{
+			return nLast - nFirst == 0 ? nLast
+				: nLast - nFirst == 1 ? (s[nFirst] == c ? nFirst : nLast)
+				: FindFormatCharInSecondHalf(FindFormatChar(s, nFirst, nFirst + (nLast - nFirst) / 2, c), s, nFirst + (nLast - nFirst) / 2, nLast, c);
+		}
+
+		constexpr size_t ParseFormatDigits(constexpr_string s, size_t nFirst, size_t nLast, size_t nValue)
+		{
+			return nFirst == nLast ? nValue
+				: s[nFirst] >= '0' && s[nFirst] <= '9' ? ParseFormatDigits(s, nFirst + 1, nLast, nValue * 10 + (s[nFirst] - '0'))
+				: format_invalid_index;
+		}
+
+		// Index of the token in [nFirst, nLast): digits, or "_" for nNextArg
+		constexpr size_t ParseFormatIndex(constexpr_string s, size_t nFirst, size_t nLast, size_t nNextArg)
+		{
+			return nFirst == nLast ? format_invalid_index
+				: nLast - nFirst == 1 && s[nFirst] == '_' ? nNextArg
+				: ParseFormatDigits(s, nFirst, nLast, 0);
+		}
+
+		enum class FormatStepKind { End, Escape, Token, TokenWithSpecifier };
+
+		// One step of the parsing of S: the literal text from LiteralBegin, followed by the end of the string,
+		// an escaped '{', or a token
+		template<class S, size_t LiteralBegin, size_t SearchFrom, size_t NextArg>
+		struct FormatStep
+		{
+			static constexpr size_t size = S::value().size();
+			static constexpr size_t open = FindFormatChar(S::value(), SearchFrom, size, '{');
+			static constexpr bool is_end = open == size;
+			static constexpr bool is_escape = !is_end && open != 0 && S::value()[open - 1] == '\\';
+			static constexpr bool is_token = !is_end && !is_escape;
+			static constexpr size_t close = is_token ? FindFormatChar(S::value(), open + 1, size, '}') : open;
+			static_assert(!is_token || close != size, "Format token is missing its closing '}'");
+
+			static constexpr size_t colon = is_token ? FindFormatChar(S::value(), open + 1, close, ':') : open;
+			static constexpr size_t index = is_token ? ParseFormatIndex(S::value(), open + 1, colon, NextArg) : 0;
+			static_assert(!is_token || index != format_invalid_index, "Format token index should be digits or '_'");
+
+			static constexpr FormatStepKind kind = is_end ? FormatStepKind::End
+				: is_escape ? FormatStepKind::Escape
+				: colon == close ? FormatStepKind::Token
+				: FormatStepKind::TokenWithSpecifier;
+
+			static constexpr size_t literal_end = is_escape ? open - 1 : open;
+			static constexpr size_t next_literal_begin = is_escape ? open : close + 1;
+			static constexpr size_t next_search = is_escape ? open + 1 : close + 1;
+			static constexpr size_t next_arg = is_token ? index + 1 : NextArg;
+		};
+
+		template<FormatStepKind Kind>
+		using format_step_kind = std::integral_constant<FormatStepKind, Kind>;
+
+		template<class S, size_t LiteralBegin, size_t SearchFrom, size_t NextArg, class Writer, class Tuple>
+		void AppendFormat(Writer& writer, Tuple& args);
+
+		template<class S, class Step, class Writer, class Tuple>
+		void AppendFormatStep(Writer&, Tuple&, format_step_kind<FormatStepKind::End>) {}
+
+		template<class S, class Step, class Writer, class Tuple>
+		void AppendFormatStep(Writer& writer, Tuple& args, format_step_kind<FormatStepKind::Escape>)
+		{
+			AppendFormat<S, Step::next_literal_begin, Step::next_search, Step::next_arg>(writer, args);
+		}
+
+		template<class S, class Step, class Writer, class Tuple>
+		void AppendFormatStep(Writer& writer, Tuple& args, format_step_kind<FormatStepKind::Token>)
+		{
+			static_assert(Step::index < std::tuple_size<Tuple>::value, "Format token index is higher than the number of arguments");
+			constexpr size_t index = Step::index < std::tuple_size<Tuple>::value ? Step::index : 0;
+
+			WriteFormatArg(writer, std::get<index>(args));
+			AppendFormat<S, Step::next_literal_begin, Step::next_search, Step::next_arg>(writer, args);
+		}
+
+		template<class S, class Step, class Writer, class Tuple>
+		void AppendFormatStep(Writer& writer, Tuple& args, format_step_kind<FormatStepKind::TokenWithSpecifier>)
+		{
+			static_assert(Step::index < std::tuple_size<Tuple>::value, "Format token index is higher than the number of arguments");
+			constexpr size_t index = Step::index < std::tuple_size<Tuple>::value ? Step::index : 0;
+			static_assert(has_format_specifier<std::tuple_element_t<index, Tuple>>::value, "A format specifier was supplied to an argument that does not support it");
+
+			WriteFormatArg(writer, std::get<index>(args), S::value().data() + Step::colon + 1, Step::close - Step::colon - 1);
+			AppendFormat<S, Step::next_literal_begin, Step::next_search, Step::next_arg>(writer, args);
+		}
+
+		template<class S, size_t LiteralBegin, size_t SearchFrom, size_t NextArg, class Writer, class Tuple>
+		void AppendFormat(Writer& writer, Tuple& args)
+		{
+			using Step = FormatStep<S, LiteralBegin, SearchFrom, NextArg>;
+			if (Step::literal_end != LiteralBegin) writer.write(S::value().data() + LiteralBegin, Step::literal_end - LiteralBegin);
+			AppendFormatStep<S, Step>(writer, args, format_step_kind<Step::kind>{});
+		}
+
+		// Messages formatted by Log and LogError up to this size are formatted on the stack
+		constexpr size_t log_buffer_size = 512;
+
+		// Only the messages that do not fit in the stack buffer allocate
+		template<class FormatT, typename... Args>
+		void LogFormat(void(*pLog)(const char*), const FormatT& sFormat, const Args&... args)
+		{
+			char buffer[log_buffer_size];
+			auto const result = FormatTo(gsl::span<char>{ buffer, log_buffer_size - 1 }, sFormat, args...);
+			if (result.size < log_buffer_size)
+			{
+				*result.out = '\0';
+				pLog(buffer);
+			}
+			else
+			{
+				pLog(Format(sFormat, args...).c_str());
+			}
+		}
+	}
+
+	// Format with a format string parsed during compilation, ex: Format(HE_FORMAT("{_} + {_}"), a, b)
+	// The tokens are the same as with a run-time format string, but an invalid token or argument index fails
+	// to compile, and the formatting is a straight sequence of appends
+	template<class S, typename... Args>
+	std::string Format(FormatString<S>, Args&&... args)
+	{
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		auto argsTuple = std::forward_as_tuple(std::forward<Args>(args)...);
+		std::string sOutput;
+		Private::FormatStringWriter writer{ sOutput };
+		Private::AppendFormat<S, 0, 0, 0>(writer, argsTuple);
+		return sOutput;
+	}
+
+	template<class S, typename... Args>
+	FormatToResult FormatTo(gsl::span<char> buffer, FormatString<S>, Args&&... args)
+	{
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		auto argsTuple = std::forward_as_tuple(std::forward<Args>(args)...);
+		Private::FormatBufferWriter writer{ buffer.data(), static_cast<size_t>(buffer.size()) };
+		Private::AppendFormat<S, 0, 0, 0>(writer, argsTuple);
+		return{ writer.out(), writer.size() };
+	}
+
+	template<class OutputIt, class S, typename... Args>
+	auto FormatTo(OutputIt out, FormatString<S>, Args&&... args)
+		-> std::enable_if_t<!std::is_pointer<OutputIt>::value && !std::is_convertible<OutputIt, gsl::span<char>>::value, OutputIt>
+	{
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		auto argsTuple = std::forward_as_tuple(std::forward<Args>(args)...);
+		Private::FormatIteratorWriter<OutputIt> writer{ out };
+		Private::AppendFormat<S, 0, 0, 0>(writer, argsTuple);
+		return writer.out();
+	}
+
+	template<class S, typename... Args>
+	size_t FormattedSize(FormatString<S>, Args&&... args)
+	{
+		static_assert(HasFormat<Args...>(), "An argument cannot be formatted (HasFormat returns false)");
+
+		auto argsTuple = std::forward_as_tuple(std::forward<Args>(args)...);
+		Private::FormatBufferWriter writer{ nullptr, 0 };
+		Private::AppendFormat<S, 0, 0, 0>(writer, argsTuple);
+		return writer.size();
+	}
+
+	// Logging with a format, which does not allocate for messages shorter than Private::log_buffer_size
+	// and arguments written without a to_string (see FormatTo)
+	template< typename... Args>
+	void Log(gsl::czstring<> sFormat, Args&&... args)
+	{
+		Private::LogFormat(Log, sFormat, args...);
+	}
+
+	template< typename... Args>
+	void Log(const std::string& sFormat, Args&&... args)
+	{
+		Private::LogFormat(Log, sFormat.c_str(), args...);
+	}
+
+	template<class S, typename... Args>
+	void Log(FormatString<S> sFormat, Args&&... args)
+	{
+		Private::LogFormat(Log, sFormat, args...);
+	}
+
+	template< typename... Args>
+	void LogError(gsl::czstring<> sFormat, Args&&... args)
+	{
+		Private::LogFormat(LogError, sFormat, args...);
+	}
+
+	template< typename... Args>
+	void LogError(const std::string& sFormat, Args&&... args)
+	{
+		Private::LogFormat(LogError, sFormat.c_str(), args...);
+	}
+
+	template<class S, typename... Args>
+	void LogError(FormatString<S> sFormat, Args&&... args)
+	{
+		Private::LogFormat(LogError, sFormat, args...);
+	}
+}
+
+// Makes a FormatString from a string literal
+#define HE_FORMAT(s) ::HE::MakeFormatString([] { struct HE_FormatString { static constexpr ::HE::constexpr_string value() { return s; } }; return HE_FormatString{}; }())
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "HE_TrackingAllocator.h"
+
+#include "HE_Platform.h"
+#include "HE_String.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#if defined(PLATFORM_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define HE_HAS_EXECINFO
+#endif
+
+namespace HE
+{
+	namespace
+	{
+		std::mutex g_mutBacktraces;
+		std::unordered_map<std::uint32_t, Backtrace> g_backtraces;
+
+		// Hashes recently registered by this thread, so that the registry is only locked for new call stacks
+		constexpr size_t recent_hash_count = 64;
+		thread_local std::uint32_t t_recentHashes[recent_hash_count] = {};
+
+#if defined(HE_HAS_EXECINFO)
+		std::uint32_t HashFrames(void* const* pFrames, size_t nCount) noexcept
+		{
+			// FNV-1a
+			std::uint32_t nHash = 2166136261u;
+			for (size_t i = 0; i < nCount; ++i)
+			{
+				auto nFrame = reinterpret_cast<std::uintptr_t>(pFrames[i]);
+				for (size_t b = 0; b < sizeof(nFrame); ++b, nFrame >>= 8)
+				{
+					nHash ^= static_cast<std::uint32_t>(nFrame & 0xFF);
+					nHash *= 16777619u;
+				}
+			}
+			return nHash;
+		}
+#endif
+
+		void Register(std::uint32_t nHash, const Backtrace& backtrace) noexcept
+		{
+			auto& nRecent = t_recentHashes[nHash % recent_hash_count];
+			if (nRecent == nHash) return;
+
+			try
+			{
+				std::lock_guard<std::mutex> lock{ g_mutBacktraces };
+				g_backtraces.emplace(nHash, backtrace);
+				nRecent = nHash;
+			}
+			catch (const std::bad_alloc&)
+			{
+				// The frames of this call stack are lost, but the allocation is still counted under its hash
+			}
+		}
+	}
+
+	std::uint32_t CurrentThreadId() noexcept
+	{
+		static std::atomic<std::uint32_t> s_nNextId{ 1 };
+		thread_local std::uint32_t const t_nId = s_nNextId++;
+		return t_nId;
+	}
+
+	bool FindBacktrace(std::uint32_t nHash, Backtrace& backtrace)
+	{
+		std::lock_guard<std::mutex> lock{ g_mutBacktraces };
+		auto const it = g_backtraces.find(nHash);
+		if (it == g_backtraces.end()) return false;
+
+		backtrace = it->second;
+		return true;
+	}
+
+	std::string to_string(const Backtrace& backtrace)
+	{
+		std::string s;
+		for (size_t i = 0; i < backtrace.count; ++i)
+		{
+			if (i != 0) s += '\n';
+			s += Format(HE_FORMAT("  {_}"), backtrace.frames[i]);
+		}
+		return s;
+	}
+
+	std::string to_string(const CallSiteReport& report)
+	{
+		auto s = Format(HE_FORMAT("call stack {_:08x}: {_} bytes in {_} live allocations, peak: {_} bytes, total allocations: {_}"),
+			report.backtraceHash, report.liveBytes, report.liveAllocations, report.peakBytes, report.totalAllocations);
+
+		Backtrace backtrace;
+		if (FindBacktrace(report.backtraceHash, backtrace)) s += '\n' + to_string(backtrace);
+		return s;
+	}
+
+	namespace Private
+	{
+		std::uint32_t CaptureBacktrace(unsigned nSkip) noexcept
+		{
+			Backtrace backtrace;
+			// This function is skipped as well
+#if defined(PLATFORM_WINDOWS)
+			ULONG nWindowsHash = 0;
+			backtrace.count = RtlCaptureStackBackTrace(nSkip + 1, static_cast<DWORD>(Backtrace::max_frames), backtrace.frames, &nWindowsHash);
+			auto const nHash = static_cast<std::uint32_t>(nWindowsHash);
+#elif defined(HE_HAS_EXECINFO)
+			void* frames[2 * Backtrace::max_frames];
+			auto const nCaptured = static_cast<size_t>(::backtrace(frames, static_cast<int>(Math::Min(Backtrace::max_frames + nSkip + 1, 2 * Backtrace::max_frames))));
+			auto const nFirst = Math::Min(static_cast<size_t>(nSkip) + 1, nCaptured);
+			backtrace.count = Math::Min(nCaptured - nFirst, size_t{ Backtrace::max_frames });
+			std::copy(frames + nFirst, frames + nFirst + backtrace.count, backtrace.frames);
+			auto const nHash = HashFrames(backtrace.frames, backtrace.count);
+#else
+			backtrace.count = 0;
+			std::uint32_t const nHash = 0;
+#endif
+			if (backtrace.count == 0) return 0;
+
+			// 0 is kept for unknown call stacks
+			auto const nNonZeroHash = nHash != 0 ? nHash : 1;
+			Register(nNonZeroHash, backtrace);
+			return nNonZeroHash;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "HE_Allocator.h"
+#include "HE_FlatHashMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace HE
+{
+	// Hidden prefix of every block of a TrackingAllocator
+	struct AllocationRecord
+	{
+		AllocationRecord* prev;
+		AllocationRecord* next;
+		size_t size; // As requested by the client
+		std::uint64_t timestamp; // Nanoseconds of std::chrono::steady_clock
+		std::uint32_t threadId; // Small sequential id, see CurrentThreadId
+		std::uint32_t backtraceHash; // 0 if the platform cannot capture backtraces
+
+		void* block() const noexcept { return const_cast<AllocationRecord*>(this + 1); }
+	};
+
+	// Frames of the first backtrace seen with a hash
+	struct Backtrace
+	{
+		static constexpr size_t max_frames = 16;
+
+		void* frames[max_frames];
+		size_t count;
+
+		// One frame address per line, to be resolved with the debugger or a symbolizer
+		friend std::string to_string(const Backtrace& backtrace);
+	};
+
+	// Memory of the live allocations made from one call stack
+	struct CallSiteReport
+	{
+		std::uint32_t backtraceHash;
+		size_t liveAllocations;
+		size_t liveBytes;
+		size_t peakBytes; // Highest liveBytes reached since the last resetPeak
+		size_t totalAllocations;
+
+		friend std::string to_string(const CallSiteReport& report);
+	};
+
+	// Id of the calling thread, numbered from 1 in order of first use
+	std::uint32_t CurrentThreadId() noexcept;
+
+	// Returns the frames of the backtrace with the hash, if it was captured by this process
+	bool FindBacktrace(std::uint32_t nHash, Backtrace& backtrace);
+
+	namespace Private
+	{
+		// Captures the call stack of the caller, skipping nSkip frames, and returns its hash
+		// The frames of each hash are kept the first time it is seen, for FindBacktrace
+		std::uint32_t CaptureBacktrace(unsigned nSkip) noexcept;
+
+		struct CallSiteCounters
+		{
+			size_t liveAllocations;
+			size_t liveBytes;
+			size_t peakBytes;
+			size_t totalAllocations;
+		};
+	}
+
+	// An allocator adaptor recording every live block of its Parent, to find leaks and what makes the memory peak
+	// Each block gets an AllocationRecord prefix (through an AffixAllocator) with its size, time, thread and the hash
+	// of its call stack. The records form an intrusive list, walked by forEachLive to dump the live blocks
+	// Live and peak bytes are also counted per call stack, and report() returns them sorted by live bytes
+	// Capturing the call stack costs a few microseconds per allocation: much less than an external heap profiler,
+	// but still meant for development builds
+	// Thread-safe: the Parent is only used under a lock
+	template<class Parent>
+	class TrackingAllocator : private AffixAllocator<Parent, AllocationRecord>
+	{
+		static_assert(IsAllocator<Parent>(), "TrackingAllocator's Parent does not meet the HE::Allocator concept");
+
+		using Inner = AffixAllocator<Parent, AllocationRecord>;
+
+	public:
+		static constexpr size_t alignment = Inner::alignment;
+
+		TrackingAllocator() = default;
+		TrackingAllocator(const TrackingAllocator&) = delete;
+		TrackingAllocator& operator=(const TrackingAllocator&) = delete;
+
+		Blk allocate(size_t n)
+		{
+			auto const nHash = Private::CaptureBacktrace(1);
+
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			auto b = Inner::allocate(n);
+			if (!b.ptr) return b;
+
+			try
+			{
+				auto& counters = m_callSites[nHash];
+				++counters.liveAllocations;
+				++counters.totalAllocations;
+				counters.liveBytes += n;
+				counters.peakBytes = Math::Max(counters.peakBytes, counters.liveBytes);
+			}
+			catch (const std::bad_alloc&)
+			{
+				Inner::deallocate(b);
+				return{ nullptr, 0 };
+			}
+
+			auto& record = Inner::Prefix(b);
+			record.size = n;
+			record.timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+			record.threadId = CurrentThreadId();
+			record.backtraceHash = nHash;
+			link(record);
+
+			m_nBytesInUse += n;
+			m_nPeakBytes = Math::Max(m_nPeakBytes, m_nBytesInUse);
+			return b;
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			if (!b.ptr) return;
+
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			auto& record = Inner::Prefix(b);
+			unlink(record);
+			release(record.backtraceHash, record.size);
+			Inner::deallocate(b);
+		}
+
+		// The block moves with its record, so the record is unlinked around the reallocation
+		template<class P = Inner, class = std::enable_if_t<has_op<P, Private::try_reallocate>::value>>
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (!b.ptr) return false;
+
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			auto const nLength = b.length;
+			unlink(Inner::Prefix(b));
+			auto const bSuccess = Private::Reallocate(static_cast<Inner&>(*this), b, n);
+			auto& record = Inner::Prefix(b);
+			link(record);
+			if (!bSuccess) return false;
+
+			record.size = n;
+			resize(record.backtraceHash, nLength, n);
+			return true;
+		}
+
+		template<class P = Inner, class = std::enable_if_t<is_owning_allocator<P>::value>>
+		bool owns(Blk b)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return Inner::owns(b);
+		}
+
+		// Calls f(const AllocationRecord&) on every live block, from the most recent one
+		// The allocator is locked during the walk, so f must not use it
+		template<class F>
+		void forEachLive(F&& f) const
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			for (auto pRecord = m_pHead; pRecord != nullptr; pRecord = pRecord->next) f(static_cast<const AllocationRecord&>(*pRecord));
+		}
+
+		// Call stacks with live blocks or a peak, sorted by live bytes, then by peak bytes
+		std::vector<CallSiteReport> report() const
+		{
+			std::vector<CallSiteReport> result;
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				result.reserve(m_callSites.size());
+				for (auto const& site : m_callSites)
+				{
+					auto const& c = site.second;
+					if (c.liveBytes != 0 || c.peakBytes != 0) result.push_back({ site.first, c.liveAllocations, c.liveBytes, c.peakBytes, c.totalAllocations });
+				}
+			}
+
+			std::sort(result.begin(), result.end(), [](const CallSiteReport& lhs, const CallSiteReport& rhs) {
+				return lhs.liveBytes != rhs.liveBytes ? lhs.liveBytes > rhs.liveBytes : lhs.peakBytes > rhs.peakBytes;
+			});
+			return result;
+		}
+
+		size_t bytesInUse() const
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_nBytesInUse;
+		}
+
+		size_t peakBytes() const
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_nPeakBytes;
+		}
+
+		// Restarts the peaks from the bytes in use, ex: before loading a level
+		void resetPeak()
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_nPeakBytes = m_nBytesInUse;
+			for (auto& site : m_callSites) site.second.peakBytes = site.second.liveBytes;
+		}
+
+		// Record of a live block
+		// Pre-condition: b was allocated by this allocator
+		static const AllocationRecord& record(Blk b) noexcept
+		{
+			return Inner::Prefix(b);
+		}
+
+	private:
+		mutable std::mutex m_mutex;
+		AllocationRecord* m_pHead{ nullptr };
+		FlatHashMap<std::uint32_t, Private::CallSiteCounters> m_callSites;
+		size_t m_nBytesInUse{ 0 };
+		size_t m_nPeakBytes{ 0 };
+
+		void link(AllocationRecord& record) noexcept
+		{
+			record.prev = nullptr;
+			record.next = m_pHead;
+			if (m_pHead) m_pHead->prev = &record;
+			m_pHead = &record;
+		}
+
+		void unlink(AllocationRecord& record) noexcept
+		{
+			if (record.prev) record.prev->next = record.next;
+			else m_pHead = record.next;
+			if (record.next) record.next->prev = record.prev;
+		}
+
+		void release(std::uint32_t nHash, size_t n) noexcept
+		{
+			auto& counters = m_callSites.find(nHash)->second;
+			--counters.liveAllocations;
+			counters.liveBytes -= n;
+			m_nBytesInUse -= n;
+		}
+
+		void resize(std::uint32_t nHash, size_t nOld, size_t nNew) noexcept
+		{
+			auto& counters = m_callSites.find(nHash)->second;
+			counters.liveBytes = counters.liveBytes - nOld + nNew;
+			counters.peakBytes = Math::Max(counters.peakBytes, counters.liveBytes);
+			m_nBytesInUse = m_nBytesInUse - nOld + nNew;
+			m_nPeakBytes = Math::Max(m_nPeakBytes, m_nBytesInUse);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "HE_VirtualMemory.h"
+
+#include "HE_Assert.h"
+#include "HE_Platform.h"
+
+#if defined(PLATFORM_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+namespace HE
+{
+	PageAllocator PageAllocator::it;
+
+	namespace VirtualMemory
+	{
+		namespace
+		{
+			size_t QueryPageSize() noexcept
+			{
+#if defined(PLATFORM_WINDOWS)
+				SYSTEM_INFO info;
+				GetSystemInfo(&info);
+				return info.dwPageSize;
+#else
+				return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+			}
+
+			size_t QueryHugePageSize() noexcept
+			{
+#if defined(PLATFORM_WINDOWS)
+				return GetLargePageMinimum();
+#elif defined(__linux__)
+				auto const pFile = std::fopen("/proc/meminfo", "r");
+				if (!pFile) return 0;
+
+				size_t nSize = 0;
+				char line[256];
+				while (std::fgets(line, sizeof(line), pFile))
+				{
+					unsigned long nKiB;
+					if (std::sscanf(line, "Hugepagesize: %lu kB", &nKiB) == 1)
+					{
+						nSize = static_cast<size_t>(nKiB) * 1024;
+						break;
+					}
+				}
+				std::fclose(pFile);
+				return nSize;
+#else
+				return 0;
+#endif
+			}
+
+#if !defined(PLATFORM_WINDOWS)
+			void* MapNone(size_t n, int nFlags) noexcept
+			{
+				auto const p = mmap(nullptr, n, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | nFlags, -1, 0);
+				return p == MAP_FAILED ? nullptr : p;
+			}
+
+			// Explicit huge pages come from a pool the system administrator sets up. Without MAP_NORESERVE, the
+			// mapping takes its pages from the pool up front, and fails when the pool is too small, instead of
+			// raising SIGBUS when the pages are touched
+			void* ReserveHugeTlb(size_t n) noexcept
+			{
+#if defined(MAP_HUGETLB)
+				auto const nHugePageSize = GetHugePageSize();
+				if (nHugePageSize == 0 || n % nHugePageSize != 0) return nullptr;
+				return MapNone(n, MAP_HUGETLB);
+#else
+				(void)n;
+				return nullptr;
+#endif
+			}
+
+			// Hints that the range should be backed by transparent huge pages once committed
+			HugePageBacking AdviseHugePages(void* p, size_t n) noexcept
+			{
+#if defined(MADV_HUGEPAGE)
+				return madvise(p, n, MADV_HUGEPAGE) == 0 ? HugePageBacking::Transparent : HugePageBacking::None;
+#else
+				(void)p;
+				(void)n;
+				return HugePageBacking::None;
+#endif
+			}
+#endif
+
+			void SetBacking(HugePageBacking* pBacking, HugePageBacking backing) noexcept
+			{
+				if (pBacking) *pBacking = backing;
+			}
+		}
+
+		size_t GetPageSize() noexcept
+		{
+			static size_t const s_nPageSize = QueryPageSize();
+			return s_nPageSize;
+		}
+
+		size_t GetHugePageSize() noexcept
+		{
+			static size_t const s_nHugePageSize = QueryHugePageSize();
+			return s_nHugePageSize;
+		}
+
+		void* Reserve(size_t n, bool bHugePages, HugePageBacking* pBacking) noexcept
+		{
+			SetBacking(pBacking, HugePageBacking::None);
+			if (n > std::numeric_limits<size_t>::max() - GetPageSize()) return nullptr;
+
+			n = Math::RoundUpToMultipleOf(n, GetPageSize());
+#if defined(PLATFORM_WINDOWS)
+			// Large pages on Windows have to be committed on reservation, and need a privilege. The hint is ignored
+			(void)bHugePages;
+			return VirtualAlloc(nullptr, n, MEM_RESERVE, PAGE_NOACCESS);
+#else
+			auto const p = MapNone(n, MAP_NORESERVE);
+			if (p && bHugePages) SetBacking(pBacking, AdviseHugePages(p, n));
+			return p;
+#endif
+		}
+
+		void* ReserveAligned(size_t n, size_t alignment, bool bHugePages, HugePageBacking* pBacking) noexcept
+		{
+			EXPECTS(Math::IsPow2(alignment));
+			if (alignment <= GetPageSize()) return Reserve(n, bHugePages, pBacking);
+
+			SetBacking(pBacking, HugePageBacking::None);
+			if (n > std::numeric_limits<size_t>::max() - alignment) return nullptr;
+
+			n = Math::RoundUpToMultipleOf(n, GetPageSize());
+			auto const nPadded = n + alignment - GetPageSize();
+#if defined(PLATFORM_WINDOWS)
+			// Part of a reservation can't be released, so reserve a padded range to find an aligned address,
+			// then release it and reserve at the address. Another thread could reserve it in between, so retry a few times
+			(void)bHugePages;
+			for (int i = 0; i < 8; ++i)
+			{
+				auto const p = VirtualAlloc(nullptr, nPadded, MEM_RESERVE, PAGE_NOACCESS);
+				if (!p) return nullptr;
+				auto const pAligned = reinterpret_cast<void*>(Math::RoundUpToMultipleOf(reinterpret_cast<size_t>(p), alignment));
+				VirtualFree(p, 0, MEM_RELEASE);
+				if (auto const pResult = VirtualAlloc(pAligned, n, MEM_RESERVE, PAGE_NOACCESS)) return pResult;
+			}
+			return nullptr;
+#else
+			// Explicit huge pages can only be committed by whole huge pages, which the caller does when it commits by
+			// steps of the alignment. They are naturally aligned on their size
+			if (bHugePages && alignment == GetHugePageSize())
+			{
+				if (auto const p = ReserveHugeTlb(n))
+				{
+					SetBacking(pBacking, HugePageBacking::Explicit);
+					return p;
+				}
+			}
+
+			auto const p = static_cast<char*>(MapNone(nPadded, MAP_NORESERVE));
+			if (!p) return nullptr;
+
+			auto const pAligned = reinterpret_cast<char*>(Math::RoundUpToMultipleOf(reinterpret_cast<size_t>(p), alignment));
+			auto const nHead = static_cast<size_t>(pAligned - p);
+			auto const nTail = nPadded - nHead - n;
+			if (nHead) munmap(p, nHead);
+			if (nTail) munmap(pAligned + n, nTail);
+
+			if (bHugePages) SetBacking(pBacking, AdviseHugePages(pAligned, n));
+			return pAligned;
+#endif
+		}
+
+		bool Commit(void* p, size_t n) noexcept
+		{
+#if defined(PLATFORM_WINDOWS)
+			return VirtualAlloc(p, n, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+			return mprotect(p, n, PROT_READ | PROT_WRITE) == 0;
+#endif
+		}
+
+		void Decommit(void* p, size_t n) noexcept
+		{
+#if defined(PLATFORM_WINDOWS)
+			VirtualFree(p, n, MEM_DECOMMIT);
+#else
+			madvise(p, n, MADV_DONTNEED);
+			mprotect(p, n, PROT_NONE);
+#endif
+		}
+
+		void Release(void* p, size_t n) noexcept
+		{
+#if defined(PLATFORM_WINDOWS)
+			(void)n;
+			VirtualFree(p, 0, MEM_RELEASE);
+#else
+			munmap(p, Math::RoundUpToMultipleOf(n, GetPageSize()));
+#endif
+		}
+	}
+
+	Blk PageAllocator::allocate(size_t n)
+	{
+		auto const p = VirtualMemory::Reserve(n);
+		if (!p) return{ nullptr, 0 };
+		if (!VirtualMemory::Commit(p, Math::RoundUpToMultipleOf(n, VirtualMemory::GetPageSize())))
+		{
+			VirtualMemory::Release(p, n);
+			return{ nullptr, 0 };
+		}
+		return{ p, n };
+	}
+
+	Blk PageAllocator::allocate(size_t n, size_t a)
+	{
+		EXPECTS(Math::IsPow2(a) && a >= alignment);
+		auto const p = VirtualMemory::ReserveAligned(n, a);
+		if (!p) return{ nullptr, 0 };
+		if (!VirtualMemory::Commit(p, Math::RoundUpToMultipleOf(n, VirtualMemory::GetPageSize())))
+		{
+			VirtualMemory::Release(p, n);
+			return{ nullptr, 0 };
+		}
+		return{ p, n };
+	}
+
+	void PageAllocator::deallocate(Blk b) noexcept
+	{
+		if (b.ptr) VirtualMemory::Release(b.ptr, b.length);
+	}
+
+	bool PageAllocator::expand(Blk& b, size_t delta)
+	{
+		auto const nPageSize = VirtualMemory::GetPageSize();
+		if (Math::RoundUpToMultipleOf(b.length + delta, nPageSize) != Math::RoundUpToMultipleOf(b.length, nPageSize)) return false;
+
+		b.length += delta;
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "HE_Allocator.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace HE
+{
+	// Smallest page size of the supported platforms. The actual page size, given by VirtualMemory::GetPageSize,
+	// is a multiple of it
+	constexpr size_t PlatformPageSize = 4096;
+
+	// Largest address space a process can have: the 47 bits of user space of x64 systems, or half of the address 
+	// space on 32-bit targets
+	constexpr size_t PlatformMaxAddressSpace = sizeof(void*) == 8 ? static_cast<size_t>(std::uint64_t{ 1 } << 47) : std::numeric_limits<size_t>::max() / 2;
+
+	// Wrappers over the platform's virtual memory API
+	// Sizes and addresses must be multiples of the page size, except for Reserve which rounds the size up
+	namespace VirtualMemory
+	{
+		// What backs a reservation that asked for huge pages
+		enum class HugePageBacking
+		{
+			None, // Regular pages
+			Transparent, // The system was asked to use transparent huge pages, which it does when it can
+			Explicit, // Huge pages from the pool set up by the system administrator
+		};
+
+		size_t GetPageSize() noexcept;
+
+		// Size of a huge page, or 0 if huge pages are not supported
+		size_t GetHugePageSize() noexcept;
+
+		// Reserves address space, without any memory backing it
+		// Sizes that overflow once rounded up to the page size fail
+		// With bHugePages, asks for transparent huge pages. The hint is ignored if they are not supported
+		// pBacking, if not null, receives what backs the reservation
+		// Returns a null pointer on failure
+		void* Reserve(size_t n, bool bHugePages = false, HugePageBacking* pBacking = nullptr) noexcept;
+
+		// Same as Reserve, with a start address aligned on a power of 2 higher than the page size
+		// With bHugePages and an alignment of exactly GetHugePageSize(), uses explicit huge pages (MAP_HUGETLB) when
+		// the system has enough for the whole range, and the range must then be committed and decommitted by steps of
+		// the alignment. The huge pages are taken from the system's pool on reservation, not on commit
+		void* ReserveAligned(size_t n, size_t alignment, bool bHugePages = false, HugePageBacking* pBacking = nullptr) noexcept;
+
+		// Makes reserved pages usable. The memory of committed pages is zeroed, and only gets resident on first access
+		bool Commit(void* p, size_t n) noexcept;
+
+		// Returns the memory of committed pages to the system, keeping the address space reserved
+		void Decommit(void* p, size_t n) noexcept;
+
+		// Releases a whole reservation
+		void Release(void* p, size_t n) noexcept;
+	}
+
+	// An allocator that reserves and commits whole pages on every allocation
+	// Meant to be the Parent of allocators managing large chunks, not to be used directly
+	class PageAllocator
+	{
+	public:
+		static constexpr size_t alignment = PlatformPageSize;
+		static PageAllocator it;
+
+		Blk allocate(size_t n);
+		Blk allocate(size_t n, size_t alignment);
+		void deallocate(Blk b) noexcept;
+
+		// Only within the last page of the block
+		bool expand(Blk& b, size_t delta);
+	};
+
+	namespace Private
+	{
+		template<bool HugePages>
+		class VirtualRegion;
+	}
+
+	// Implementation of the VirtualRegionAllocator and the HugePageArena, with a size given at run-time
+	// An allocator that reserves address space on construction, and allocates from it by bumping an offset.
+	// Pages are only committed when an allocation reaches them, by steps of commit_granularity, so a very large
+	// reservation costs nothing until used
+	// Like the StackAllocator, only the last allocation can be deallocated. deallocateAll decommits every page,
+	// while trim only decommits the pages past the last allocation
+	// With HugePages, pages are committed by steps of 2 MiB, and the reservation asks for huge pages. Explicit huge
+	// pages are only used when the system's huge pages are 2 MiB, transparent huge pages otherwise
+	template<bool HugePages>
+	class Private::VirtualRegion
+	{
+	public:
+		static constexpr size_t alignment = PlatformMaxAlignment;
+		static constexpr size_t commit_granularity = HugePages ? 2 * 1024 * 1024 : 64 * 1024;
+
+		explicit VirtualRegion(size_t nReserveSize) noexcept
+			: m_nReserved{ nReserveSize <= std::numeric_limits<size_t>::max() - commit_granularity ? Math::RoundUpToMultipleOf(nReserveSize, commit_granularity) : 0 }
+			, m_pBegin{ m_nReserved != 0 ? static_cast<char*>(VirtualMemory::ReserveAligned(m_nReserved, commit_granularity, HugePages, &m_backing)) : nullptr }
+		{
+
+		}
+
+		~VirtualRegion()
+		{
+			if (m_pBegin) VirtualMemory::Release(m_pBegin, m_nReserved);
+		}
+
+		VirtualRegion(const VirtualRegion&) = delete;
+		void operator=(const VirtualRegion&) = delete;
+
+		Blk allocate(size_t n)
+		{
+			return allocate(n, alignment);
+		}
+
+		Blk allocate(size_t n, size_t a)
+		{
+			EXPECTS(Math::IsPow2(a) && a >= alignment);
+			if (!m_pBegin) return{ nullptr, 0 };
+
+			auto const nBegin = reinterpret_cast<size_t>(m_pBegin);
+			auto const nOffset = Math::RoundUpToMultipleOf(nBegin + m_nTop, a) - nBegin;
+			if (nOffset > m_nReserved || n > m_nReserved - nOffset) return{ nullptr, 0 };
+			auto const nAllocationSize = Math::RoundUpToMultipleOf(n, alignment);
+			if (nAllocationSize > m_nReserved - nOffset) return{ nullptr, 0 };
+			if (!commitUpTo(nOffset + nAllocationSize)) return{ nullptr, 0 };
+
+			m_nTop = nOffset + nAllocationSize;
+			return{ m_pBegin + nOffset, n };
+		}
+
+		// Only the last allocated block is actually deallocated. Its pages stay committed until a trim
+		void deallocate(Blk b) noexcept
+		{
+			if (isLast(b))
+			{
+				m_nTop = static_cast<char*>(b.ptr) - m_pBegin;
+			}
+		}
+
+		// Only the last allocated block can grow, committing pages as needed
+		bool expand(Blk& b, size_t delta)
+		{
+			return isLast(b) && resizeLast(b, b.length + delta);
+		}
+
+		// The last allocated block is resized in place. Other blocks shrink in place, leaving their tail unused until
+		// deallocateAll, and grow by moving to a new allocation unless their rounded size stays the same
+		bool reallocate(Blk& b, size_t n)
+		{
+			if (isLast(b)) return resizeLast(b, n);
+			if (n <= b.length || Math::RoundUpToMultipleOf(n, alignment) == Math::RoundUpToMultipleOf(b.length, alignment))
+			{
+				b.length = n;
+				return true;
+			}
+			return Private::MoveBlock(*this, *this, b, n);
+		}
+
+		void deallocateAll() noexcept
+		{
+			m_nTop = 0;
+			trim();
+		}
+
+		// Decommits the pages past the last allocation
+		void trim() noexcept
+		{
+			auto const nCommitted = Math::RoundUpToMultipleOf(m_nTop, commit_granularity);
+			if (nCommitted < m_nCommitted)
+			{
+				VirtualMemory::Decommit(m_pBegin + nCommitted, m_nCommitted - nCommitted);
+				m_nCommitted = nCommitted;
+			}
+		}
+
+		bool owns(Blk b) const
+		{
+			return m_pBegin && b.begin() >= m_pBegin && b.end() <= m_pBegin + m_nReserved;
+		}
+
+		size_t size() const noexcept { return m_nTop; }
+		size_t committed() const noexcept { return m_nCommitted; }
+		size_t reserved() const noexcept { return m_pBegin ? m_nReserved : 0; }
+		VirtualMemory::HugePageBacking backing() const noexcept { return m_pBegin ? m_backing : VirtualMemory::HugePageBacking::None; }
+
+	private:
+		VirtualMemory::HugePageBacking m_backing{ VirtualMemory::HugePageBacking::None };
+		size_t const m_nReserved;
+		char* const m_pBegin;
+		size_t m_nTop{ 0 };
+		size_t m_nCommitted{ 0 };
+
+		bool isLast(Blk b) const noexcept
+		{
+			return b.ptr && static_cast<char*>(b.ptr) + Math::RoundUpToMultipleOf(b.length, alignment) == m_pBegin + m_nTop;
+		}
+
+		bool resizeLast(Blk& b, size_t n) noexcept
+		{
+			auto const nOffset = static_cast<size_t>(static_cast<char*>(b.ptr) - m_pBegin);
+			if (n > m_nReserved - nOffset) return false;
+			auto const nAllocationSize = Math::RoundUpToMultipleOf(n, alignment);
+			if (nAllocationSize > m_nReserved - nOffset || !commitUpTo(nOffset + nAllocationSize)) return false;
+
+			m_nTop = nOffset + nAllocationSize;
+			b.length = n;
+			return true;
+		}
+
+		bool commitUpTo(size_t nEnd) noexcept
+		{
+			if (nEnd <= m_nCommitted) return true;
+
+			auto const nCommitted = Math::Min(Math::RoundUpToMultipleOf(nEnd, commit_granularity), m_nReserved);
+			if (!VirtualMemory::Commit(m_pBegin + m_nCommitted, nCommitted - m_nCommitted)) return false;
+
+			m_nCommitted = nCommitted;
+			return true;
+		}
+	};
+
+	// See Private::VirtualRegion, ReserveSize bytes are reserved
+	template<size_t ReserveSize, bool HugePages = false>
+	class VirtualRegionAllocator : public Private::VirtualRegion<HugePages>
+	{
+		static_assert(ReserveSize > 0, "VirtualRegionAllocator's ReserveSize should be higher than 0");
+
+	public:
+		VirtualRegionAllocator() noexcept : Private::VirtualRegion<HugePages>{ ReserveSize } {}
+	};
+
+	// A virtual region of huge pages, whose size is given on construction, ex: from the command line
+	// The region is aligned on 2 MiB and committed by steps of 2 MiB, so that each step can be a huge page. It asks for
+	// explicit huge pages first if the system's are 2 MiB, then transparent ones, and falls back to regular pages.
+	// backing() tells which it got. Explicit huge pages are taken from the system's pool for the whole size on
+	// construction, other pages only when committed
+	// Meant for large arrays, ex: the component arrays of the entities, where regular pages cause TLB misses
+	// On Windows, large pages have to be committed on reservation and need a privilege, so the arena has regular pages
+	class HugePageArena : public Private::VirtualRegion<true>
+	{
+	public:
+		explicit HugePageArena(size_t nReserveSize) noexcept : Private::VirtualRegion<true>{ nReserveSize } {}
+	};
+}
\ No newline at end of file
@@ -14,7 +14,7 @@ namespace vk
 	{ }
 
 	ResultErrorException::ResultErrorException(VkResult e, gsl::cstring_span<> sContext)
-		: m_sMessage{ HE::Format("Vulkan returned error {0} from: {1}", e, sContext) }
+		: m_sMessage{ HE::Format(HE_FORMAT("Vulkan returned error {0} from: {1}"), e, sContext) }
 	{ }
 
 	const char* ResultErrorException::what() const
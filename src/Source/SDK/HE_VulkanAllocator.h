@@ -0,0 +1,178 @@
+#pragma once
+
+#include <vulkan\vulkan.h>
+
+#include <cstring>
+#include <limits>
+
+#include "HE_Allocator.h"
+
+namespace vk
+{
+	// Pair of allocators for MakeAllocationCallbacks: host allocations of VK_SYSTEM_ALLOCATION_SCOPE_COMMAND,
+	// which only live for the duration of a Vulkan command, go to the transient allocator (ex: a FrameAllocator),
+	// while every other scope goes to the persistent allocator
+	template<class Persistent, class Transient>
+	struct ScopedAllocator
+	{
+		Persistent& persistent;
+		Transient& transient;
+	};
+
+	namespace Private
+	{
+		// Vulkan frees a pointer without its size, so every allocation is preceded by the block it was carved from
+		struct HostAllocationHeader
+		{
+			HE::Blk block;
+			bool bTransient;
+		};
+
+		template<class Allocator>
+		struct HostAllocators
+		{
+			using Persistent = Allocator;
+			using Transient = Allocator;
+
+			static Persistent& persistent(void* pUserData) noexcept { return *static_cast<Allocator*>(pUserData); }
+			static Transient& transient(void* pUserData) noexcept { return *static_cast<Allocator*>(pUserData); }
+		};
+
+		template<class P, class T>
+		struct HostAllocators<ScopedAllocator<P, T>>
+		{
+			using Persistent = P;
+			using Transient = T;
+
+			static Persistent& persistent(void* pUserData) noexcept { return static_cast<ScopedAllocator<P, T>*>(pUserData)->persistent; }
+			static Transient& transient(void* pUserData) noexcept { return static_cast<ScopedAllocator<P, T>*>(pUserData)->transient; }
+		};
+
+		template<class UserData>
+		class HostAllocationCallbacks
+		{
+			using Allocators = HostAllocators<UserData>;
+
+		public:
+			static void* VKAPI_CALL Allocate(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope) noexcept
+			{
+				if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND)
+					return allocate(Allocators::transient(pUserData), size, alignment, true);
+				else
+					return allocate(Allocators::persistent(pUserData), size, alignment, false);
+			}
+
+			// Grows the block in place through the allocator's expand when it can, otherwise allocates a new block
+			// in the requested scope and copies the content
+			static void* VKAPI_CALL Reallocate(void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope scope) noexcept
+			{
+				if (!pOriginal) return Allocate(pUserData, size, alignment, scope);
+				if (size == 0)
+				{
+					Free(pUserData, pOriginal);
+					return nullptr;
+				}
+
+				auto& header = getHeader(pOriginal);
+				auto const nUsable = usableSize(pOriginal);
+				if (size <= nUsable) return pOriginal;
+				if (size > std::numeric_limits<size_t>::max() - sizeof(HostAllocationHeader) - HE::Math::Max(alignment, alignof(HostAllocationHeader))) return nullptr;
+
+				auto block = header.block;
+				auto const bExpanded = header.bTransient
+					? HE::Private::Expand(Allocators::transient(pUserData), block, size - nUsable)
+					: HE::Private::Expand(Allocators::persistent(pUserData), block, size - nUsable);
+				if (bExpanded)
+				{
+					header.block = block;
+					return pOriginal;
+				}
+
+				auto const pResult = Allocate(pUserData, size, alignment, scope);
+				if (!pResult) return nullptr;
+
+				std::memcpy(pResult, pOriginal, nUsable);
+				Free(pUserData, pOriginal);
+				return pResult;
+			}
+
+			static void VKAPI_CALL Free(void* pUserData, void* pMemory) noexcept
+			{
+				if (!pMemory) return;
+
+				auto const header = getHeader(pMemory);
+				if (header.bTransient)
+					Allocators::transient(pUserData).deallocate(header.block);
+				else
+					Allocators::persistent(pUserData).deallocate(header.block);
+			}
+
+		private:
+			template<class Allocator>
+			static void* allocate(Allocator& a, size_t size, size_t alignment, bool bTransient) noexcept
+			{
+				auto const nAlignment = HE::Math::Max(alignment, alignof(HostAllocationHeader));
+				if (size > std::numeric_limits<size_t>::max() - sizeof(HostAllocationHeader) - nAlignment) return nullptr;
+
+				auto const b = a.allocate(sizeof(HostAllocationHeader) + size + nAlignment);
+				if (!b.ptr) return nullptr;
+
+				auto const p = reinterpret_cast<void*>(HE::Math::RoundUpToMultipleOf(reinterpret_cast<size_t>(b.ptr) + sizeof(HostAllocationHeader), nAlignment));
+				getHeader(p) = { b, bTransient };
+				return p;
+			}
+
+			static HostAllocationHeader& getHeader(void* p) noexcept
+			{
+				return reinterpret_cast<HostAllocationHeader*>(p)[-1];
+			}
+
+			// Bytes from p to the end of its block
+			static size_t usableSize(void* p) noexcept
+			{
+				auto const& block = getHeader(p).block;
+				return static_cast<char*>(block.end()) - static_cast<char*>(p);
+			}
+		};
+	}
+
+	// Makes allocation callbacks that allocate the driver's host memory on an HE allocator, ex:
+	//   HE::StatsAllocator<HE::MallocAllocator> allocator;
+	//   auto const callbacks = vk::MakeAllocationCallbacks(allocator);
+	//   auto const instance = vk::CreateInstance(createInfo, &callbacks);
+	// The allocator must outlive every object created with the callbacks, and be thread-safe if
+	// Vulkan is used from multiple threads
+	// Each allocation carries a small header and up to alignment bytes of padding
+	template<class Allocator, class Enable = std::enable_if_t<HE::is_allocator<Allocator>::value>>
+	VkAllocationCallbacks MakeAllocationCallbacks(Allocator& allocator) noexcept
+	{
+		using Callbacks = Private::HostAllocationCallbacks<Allocator>;
+
+		VkAllocationCallbacks callbacks;
+		callbacks.pUserData = &allocator;
+		callbacks.pfnAllocation = &Callbacks::Allocate;
+		callbacks.pfnReallocation = &Callbacks::Reallocate;
+		callbacks.pfnFree = &Callbacks::Free;
+		callbacks.pfnInternalAllocation = nullptr;
+		callbacks.pfnInternalFree = nullptr;
+		return callbacks;
+	}
+
+	// Same as above, routing VK_SYSTEM_ALLOCATION_SCOPE_COMMAND allocations to allocators.transient
+	// The ScopedAllocator must outlive every object created with the callbacks
+	template<class Persistent, class Transient>
+	VkAllocationCallbacks MakeAllocationCallbacks(ScopedAllocator<Persistent, Transient>& allocators) noexcept
+	{
+		static_assert(HE::IsAllocator<Persistent, Transient>(), "ScopedAllocator's allocators do not meet the HE::Allocator concept");
+		using Callbacks = Private::HostAllocationCallbacks<ScopedAllocator<Persistent, Transient>>;
+
+		VkAllocationCallbacks callbacks;
+		callbacks.pUserData = &allocators;
+		callbacks.pfnAllocation = &Callbacks::Allocate;
+		callbacks.pfnReallocation = &Callbacks::Reallocate;
+		callbacks.pfnFree = &Callbacks::Free;
+		callbacks.pfnInternalAllocation = nullptr;
+		callbacks.pfnInternalFree = nullptr;
+		return callbacks;
+	}
+}
\ No newline at end of file
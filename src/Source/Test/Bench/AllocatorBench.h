@@ -0,0 +1,221 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "HE_Allocator.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Allocation patterns and size distributions shared by the allocator benchmarks
+// Every allocator sees the same sequence of sizes, drawn once from a fixed seed
+namespace HE
+{
+	namespace Bench
+	{
+		enum class Sizes
+		{
+			Fixed, // 32 bytes, ex: list nodes
+			Small, // 8 to 64 bytes, mostly 16 and 32: components and small strings
+			Mixed, // 80% up to 128 bytes, 15% up to 1 KiB, 5% up to 8 KiB: the engine's general workload
+		};
+
+		inline const char* to_string(Sizes sizes)
+		{
+			switch (sizes)
+			{
+			case Sizes::Fixed: return "Fixed";
+			case Sizes::Small: return "Small";
+			default: return "Mixed";
+			}
+		}
+
+		// Deterministic xorshift, so that runs are comparable
+		class Random
+		{
+		public:
+			std::uint32_t operator()() noexcept
+			{
+				m_nState ^= m_nState << 13;
+				m_nState ^= m_nState >> 17;
+				m_nState ^= m_nState << 5;
+				return m_nState;
+			}
+
+		private:
+			std::uint32_t m_nState{ 2463534242u };
+		};
+
+		// Returns n sizes of the distribution, clamped to nMax
+		inline std::vector<size_t> MakeSizes(Sizes sizes, size_t n, size_t nMax)
+		{
+			static constexpr size_t small_sizes[] = { 8, 16, 16, 16, 24, 32, 32, 32, 48, 64 };
+
+			Random random;
+			std::vector<size_t> result(n);
+			for (auto& nSize : result)
+			{
+				auto const nRoll = random() % 100;
+				switch (sizes)
+				{
+				case Sizes::Fixed: nSize = 32; break;
+				case Sizes::Small: nSize = small_sizes[nRoll % 10]; break;
+				case Sizes::Mixed:
+					if (nRoll < 80) nSize = 8 + random() % 121;
+					else if (nRoll < 95) nSize = 129 + random() % 896;
+					else nSize = 1025 + random() % 7168;
+					break;
+				}
+				nSize = Math::Min(nSize, nMax);
+			}
+			return result;
+		}
+
+		constexpr size_t batch_size = 256;
+		constexpr size_t batch_count = 64;
+
+		// Next step of a thread count going from 1 to nMax by doubling. The last step is nMax even if it is not a power
+		// of 2, and the step after it is past nMax
+		inline unsigned NextThreadCount(unsigned n, unsigned nMax) noexcept
+		{
+			return n == nMax ? nMax + 1 : Math::Min(2 * n, nMax);
+		}
+
+		// Touches the block, so that the allocation cannot be optimized away and its memory is brought in the cache
+		inline void Touch(Blk b) noexcept
+		{
+			*static_cast<volatile char*>(b.ptr) = 0;
+		}
+
+		// Allocates batches of blocks, and deallocates them in reverse order
+		template<class A>
+		void Lifo(A& a, const std::vector<size_t>& sizes)
+		{
+			Blk blocks[batch_size];
+			for (size_t nBatch = 0; nBatch < batch_count; ++nBatch)
+			{
+				for (size_t i = 0; i < batch_size; ++i) Touch(blocks[i] = a.allocate(sizes[i]));
+				for (size_t i = batch_size; i-- > 0;) a.deallocate(blocks[i]);
+			}
+		}
+
+		// Allocates batches of blocks, and deallocates them in allocation order
+		template<class A>
+		void Fifo(A& a, const std::vector<size_t>& sizes)
+		{
+			Blk blocks[batch_size];
+			for (size_t nBatch = 0; nBatch < batch_count; ++nBatch)
+			{
+				for (size_t i = 0; i < batch_size; ++i) Touch(blocks[i] = a.allocate(sizes[i]));
+				for (size_t i = 0; i < batch_size; ++i) a.deallocate(blocks[i]);
+			}
+		}
+
+		// Every operation picks a random slot of the batch, and deallocates its block or allocates one in it
+		template<class A>
+		void RandomOrder(A& a, const std::vector<size_t>& sizes)
+		{
+			Blk blocks[batch_size] = {};
+			Random random;
+			for (size_t nOperation = 0; nOperation < 2 * batch_size * batch_count; ++nOperation)
+			{
+				auto const i = random() % batch_size;
+				if (blocks[i].ptr)
+				{
+					a.deallocate(blocks[i]);
+					blocks[i] = { nullptr, 0 };
+				}
+				else
+				{
+					Touch(blocks[i] = a.allocate(sizes[i]));
+				}
+			}
+			for (auto const& b : blocks)
+			{
+				if (b.ptr) a.deallocate(b);
+			}
+		}
+
+		// nPairs producer threads allocate batches of blocks, and hand them to their consumer thread, which deallocates them
+		// The allocator must be thread safe
+		template<class A>
+		void ProducerConsumer(A& a, const std::vector<size_t>& sizes, unsigned nPairs)
+		{
+			struct Channel
+			{
+				std::mutex mutex;
+				std::condition_variable ready;
+				std::deque<std::unique_ptr<Blk[]>> batches;
+			};
+
+			std::vector<Channel> channels(nPairs);
+			std::vector<std::thread> threads;
+			for (auto& channel : channels)
+			{
+				threads.emplace_back([&a, &sizes, &channel]() {
+					for (size_t nBatch = 0; nBatch < batch_count; ++nBatch)
+					{
+						std::unique_ptr<Blk[]> blocks{ new Blk[batch_size] };
+						for (size_t i = 0; i < batch_size; ++i) Touch(blocks[i] = a.allocate(sizes[i]));
+
+						std::lock_guard<std::mutex> lock{ channel.mutex };
+						channel.batches.push_back(std::move(blocks));
+						channel.ready.notify_one();
+					}
+				});
+
+				threads.emplace_back([&a, &channel]() {
+					for (size_t nBatch = 0; nBatch < batch_count; ++nBatch)
+					{
+						std::unique_lock<std::mutex> lock{ channel.mutex };
+						channel.ready.wait(lock, [&channel]() { return !channel.batches.empty(); });
+						auto const blocks = std::move(channel.batches.front());
+						channel.batches.pop_front();
+						lock.unlock();
+
+						for (size_t i = 0; i < batch_size; ++i) a.deallocate(blocks[i]);
+					}
+				});
+			}
+			for (auto& thread : threads) thread.join();
+		}
+
+		// Operations counted by the single threaded patterns
+		constexpr size_t pattern_operations = 2 * batch_size * batch_count;
+
+		// Measures the single threaded patterns for every size distribution, each on a new A
+		// nMaxSize clamps the sizes, for allocators with a size limit
+		template<class A>
+		void MeasurePatterns(Context& context, const std::string& sAllocator, size_t nMaxSize = Allocator::unbounded)
+		{
+			for (auto const sizes : { Sizes::Fixed, Sizes::Small, Sizes::Mixed })
+			{
+				auto const cSizes = MakeSizes(sizes, batch_size, nMaxSize);
+				auto const sSuffix = std::string{ "/" } + to_string(sizes);
+
+				auto const pLifo = std::make_unique<A>();
+				context.measure(sAllocator + "/LIFO" + sSuffix, pattern_operations, [&]() { Lifo(*pLifo, cSizes); });
+				auto const pFifo = std::make_unique<A>();
+				context.measure(sAllocator + "/FIFO" + sSuffix, pattern_operations, [&]() { Fifo(*pFifo, cSizes); });
+				auto const pRandom = std::make_unique<A>();
+				context.measure(sAllocator + "/Random" + sSuffix, pattern_operations, [&]() { RandomOrder(*pRandom, cSizes); });
+			}
+		}
+
+		// Measures the producer-consumer pattern from 1 to hardware_concurrency / 2 pairs of threads
+		template<class A>
+		void MeasureProducerConsumer(Context& context, const std::string& sAllocator, A& a)
+		{
+			auto const cSizes = MakeSizes(Sizes::Small, batch_size, Allocator::unbounded);
+			auto const nMaxPairs = Math::Max(std::thread::hardware_concurrency() / 2, 1u);
+			for (unsigned nPairs = 1; nPairs <= nMaxPairs; nPairs = NextThreadCount(nPairs, nMaxPairs))
+			{
+				auto const sName = sAllocator + "/ProducerConsumer/Small/threads:" + std::to_string(2 * nPairs);
+				context.measure(sName, pattern_operations * nPairs, [&]() { ProducerConsumer(a, cSizes, nPairs); }, 2 * nPairs);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+namespace HE
+{
+	namespace Bench
+	{
+		namespace
+		{
+			std::vector<std::pair<const char*, Function>>& Registry()
+			{
+				static std::vector<std::pair<const char*, Function>> registry;
+				return registry;
+			}
+
+			const char* FindArgument(int argc, char** argv, const char* sName)
+			{
+				auto const nLength = std::strlen(sName);
+				for (int i = 1; i < argc; ++i)
+				{
+					if (std::strncmp(argv[i], sName, nLength) == 0 && (argv[i][nLength] == '\0' || argv[i][nLength] == '='))
+					{
+						return argv[i][nLength] == '=' ? argv[i] + nLength + 1 : argv[i] + nLength;
+					}
+				}
+				return nullptr;
+			}
+
+			void WriteJsonString(std::ostream& out, const std::string& s)
+			{
+				out << '"';
+				for (auto const c : s)
+				{
+					if (c == '"' || c == '\\') out << '\\';
+					out << c;
+				}
+				out << '"';
+			}
+		}
+
+		bool Register(const char* sName, Function f)
+		{
+			Registry().emplace_back(sName, f);
+			return true;
+		}
+
+		std::vector<Result> Run(const std::string& sFilter)
+		{
+			Context context{ sFilter };
+			for (auto const& benchmark : Registry())
+			{
+				benchmark.second(context);
+			}
+			return context.results();
+		}
+
+		void WriteJson(std::ostream& out, const std::vector<Result>& results)
+		{
+#ifdef NDEBUG
+			auto const sBuild = "Release";
+#else
+			auto const sBuild = "Debug";
+#endif
+
+			char sNs[32];
+			out << "{\n";
+			out << "\t\"context\": { \"build\": \"" << sBuild << "\", \"pointer_size\": " << sizeof(void*)
+				<< ", \"hardware_concurrency\": " << std::thread::hardware_concurrency() << " },\n";
+			out << "\t\"benchmarks\": [";
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				auto const& result = results[i];
+				std::snprintf(sNs, sizeof(sNs), "%.3f", result.nsPerOperation);
+
+				out << (i == 0 ? "\n" : ",\n") << "\t\t{ \"name\": ";
+				WriteJsonString(out, result.name);
+				out << ", \"threads\": " << result.threads << ", \"operations\": " << result.operations << ", \"ns_per_op\": " << sNs << " }";
+			}
+			out << "\n\t]\n}\n";
+		}
+
+		bool IsRequested(int argc, char** argv)
+		{
+			return FindArgument(argc, argv, "--benchmark") != nullptr;
+		}
+
+		int Main(int argc, char** argv)
+		{
+			auto const results = Run(FindArgument(argc, argv, "--benchmark"));
+
+			auto const sOut = FindArgument(argc, argv, "--benchmark_out");
+			if (!sOut)
+			{
+				WriteJson(std::cout, results);
+				return 0;
+			}
+
+			std::ofstream file{ sOut };
+			if (!file)
+			{
+				std::fprintf(stderr, "Could not open %s\n", sOut);
+				return 1;
+			}
+			WriteJson(file, results);
+
+			for (auto const& result : results)
+			{
+				std::printf("%-64s %2u threads %10.2f ns/op\n", result.name.c_str(), result.threads, result.nsPerOperation);
+			}
+			return 0;
+		}
+	}
+}
\ No newline at end of file
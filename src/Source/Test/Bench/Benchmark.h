@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A minimal benchmark runner, sharing the test executable
+// Benchmarks are registered with HE_BENCHMARK, and only run when the executable is started with --benchmark:
+//   HazelEngine_Test --benchmark[=filter] [--benchmark_out=results.json]
+// Results are written as JSON, to the file if there is one, or to the standard output otherwise
+// Numbers from a Debug build are only good for finding bugs in the benchmarks
+namespace HE
+{
+	namespace Bench
+	{
+		struct Result
+		{
+			std::string name;
+			unsigned threads;
+			size_t operations;
+			double nsPerOperation;
+		};
+
+		class Context
+		{
+		public:
+			static constexpr int run_count = 5;
+
+			explicit Context(std::string sFilter) : m_sFilter{ std::move(sFilter) } {}
+
+			// Times nRuns calls of f after a warm-up call, and records the fastest one
+			// f performs nOperations operations of the benchmark, on nThreads threads
+			template<class F>
+			void measure(const std::string& sName, size_t nOperations, F&& f, unsigned nThreads = 1)
+			{
+				if (!matches(sName)) return;
+
+				f();
+				auto best = std::chrono::steady_clock::duration::max();
+				for (int i = 0; i < run_count; ++i)
+				{
+					auto const tStart = std::chrono::steady_clock::now();
+					f();
+					best = std::min(best, std::chrono::steady_clock::now() - tStart);
+				}
+
+				auto const fNs = std::chrono::duration<double, std::nano>(best).count();
+				m_results.push_back({ sName, nThreads, nOperations, fNs / nOperations });
+			}
+
+			bool matches(const std::string& sName) const { return sName.find(m_sFilter) != std::string::npos; }
+			const std::vector<Result>& results() const noexcept { return m_results; }
+
+		private:
+			std::string m_sFilter;
+			std::vector<Result> m_results;
+		};
+
+		using Function = void(*)(Context&);
+
+		// Use HE_BENCHMARK instead
+		bool Register(const char* sName, Function f);
+
+		// Runs every registered benchmark, recording the results whose name contains sFilter
+		std::vector<Result> Run(const std::string& sFilter);
+
+		void WriteJson(std::ostream& out, const std::vector<Result>& results);
+
+		// True if the command line has --benchmark
+		bool IsRequested(int argc, char** argv);
+
+		// Runs the benchmarks according to the command line, and returns the exit code of the program
+		int Main(int argc, char** argv);
+	}
+}
+
+#define HE_BENCHMARK(Name)																\
+	static void Name(HE::Bench::Context&);												\
+	static bool const Name##_registered = HE::Bench::Register(#Name, &Name);			\
+	static void Name(HE::Bench::Context& context)
@@ -0,0 +1,47 @@
+#include "AllocatorBench.h"
+
+using namespace HE;
+using namespace HE::Bench;
+
+HE_BENCHMARK(MallocAllocatorBench)
+{
+	MeasurePatterns<MallocAllocator>(context, "MallocAllocator");
+	MeasureProducerConsumer(context, "MallocAllocator", MallocAllocator::it);
+}
+
+HE_BENCHMARK(AlignedMallocAllocatorBench)
+{
+	MeasurePatterns<AlignedMallocAllocator>(context, "AlignedMallocAllocator");
+	MeasureProducerConsumer(context, "AlignedMallocAllocator", AlignedMallocAllocator::it);
+}
+
+// Always returns the same buffer, so this is only the cost of the size check
+HE_BENCHMARK(LightInlineAllocatorBench)
+{
+	MeasurePatterns<LightInlineAllocator<256>>(context, "LightInlineAllocator<256>", 256);
+}
+
+HE_BENCHMARK(FreelistAllocatorBench)
+{
+	MeasurePatterns<FreelistAllocator<MallocAllocator, 8, 64>>(context, "FreelistAllocator<Malloc,8,64>");
+	MeasurePatterns<FreelistAllocator<MallocAllocator, 8, 64, 64>>(context, "FreelistAllocator<Malloc,8,64,Batch64>");
+}
+
+// The stack only gets its memory back from LIFO deallocations, so the other patterns end up on malloc
+HE_BENCHMARK(FallbackAllocatorBench)
+{
+	MeasurePatterns<FallbackAllocator<StackAllocator<16 * 1024>, MallocAllocator>>(context, "FallbackAllocator<Stack16K,Malloc>");
+}
+
+// The SegregateAllocator derives from both of its allocators, so they cannot share a base: the freelist is on AlignedMalloc
+HE_BENCHMARK(SegregateAllocatorBench)
+{
+	using Small = FreelistAllocator<AlignedMallocAllocator, 0, 128>;
+	MeasurePatterns<SegregateAllocator<128, Small, MallocAllocator>>(context, "SegregateAllocator<128,Freelist,Malloc>");
+}
+
+HE_BENCHMARK(AffixAllocatorBench)
+{
+	MeasurePatterns<AffixAllocator<MallocAllocator, size_t>>(context, "AffixAllocator<Malloc,size_t>");
+	MeasurePatterns<AffixAllocator<MallocAllocator, size_t, size_t>>(context, "AffixAllocator<Malloc,size_t,size_t>");
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "AllocatorBench.h"
+#include "HE_ConcurrentAllocator.h"
+
+using namespace HE;
+using namespace HE::Bench;
+
+namespace
+{
+	class LockedFreelistAllocator
+	{
+	public:
+		static constexpr size_t alignment = MallocAllocator::alignment;
+
+		Blk allocate(size_t n)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_freelist.allocate(n);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_freelist.deallocate(b);
+		}
+
+	private:
+		std::mutex m_mutex;
+		FreelistAllocator<MallocAllocator, 8, 64> m_freelist;
+	};
+
+	// Every thread runs the LIFO pattern on the same allocator, from 1 to hardware_concurrency threads
+	template<class A>
+	void MeasureScaling(Context& context, const std::string& sAllocator)
+	{
+		auto const cSizes = MakeSizes(Sizes::Small, batch_size, Allocator::unbounded);
+		auto const nMaxThreads = Math::Max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned nThreads = 1; nThreads <= nMaxThreads; nThreads = NextThreadCount(nThreads, nMaxThreads))
+		{
+			A a;
+			auto const sName = sAllocator + "/LIFO/Small/threads:" + std::to_string(nThreads);
+			context.measure(sName, pattern_operations * nThreads, [&]() {
+				std::vector<std::thread> threads;
+				for (unsigned t = 0; t < nThreads; ++t) threads.emplace_back([&]() { Lifo(a, cSizes); });
+				for (auto& thread : threads) thread.join();
+			}, nThreads);
+		}
+	}
+}
+
+// Compares the SharedAllocator with a mutex-protected FreelistAllocator
+HE_BENCHMARK(SharedAllocatorBench)
+{
+	using Shared = SharedAllocator<MallocAllocator, 8, 64>;
+	MeasureScaling<Shared>(context, "SharedAllocator<Malloc,8,64>");
+	MeasureScaling<LockedFreelistAllocator>(context, "LockedFreelistAllocator<Malloc,8,64>");
+
+	Shared shared;
+	MeasureProducerConsumer(context, "SharedAllocator<Malloc,8,64>", shared);
+	LockedFreelistAllocator locked;
+	MeasureProducerConsumer(context, "LockedFreelistAllocator<Malloc,8,64>", locked);
+}
+
+HE_BENCHMARK(ConcurrentFreelistAllocatorBench)
+{
+	using Freelist = ConcurrentFreelistAllocator<MallocAllocator, 8, 64>;
+	MeasurePatterns<Freelist>(context, "ConcurrentFreelistAllocator<Malloc,8,64>");
+	MeasureScaling<Freelist>(context, "ConcurrentFreelistAllocator<Malloc,8,64>");
+
+	Freelist freelist;
+	MeasureProducerConsumer(context, "ConcurrentFreelistAllocator<Malloc,8,64>", freelist);
+}
\ No newline at end of file
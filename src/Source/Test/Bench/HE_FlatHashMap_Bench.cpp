@@ -0,0 +1,87 @@
+#include "AllocatorBench.h"
+#include "HE_FlatHashMap.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace HE;
+using namespace HE::Bench;
+
+namespace
+{
+	constexpr size_t key_count = 64 * 1024;
+
+	// Random 64-bit ids, ex: asset GUIDs
+	std::vector<std::uint64_t> MakeRandomKeys(size_t n, Random& random)
+	{
+		std::vector<std::uint64_t> keys(n);
+		for (auto& nKey : keys) nKey = (std::uint64_t{ random() } << 32) | random();
+		return keys;
+	}
+
+	// Sequential multiples of 16, like pointers or handles: std::hash is the identity for these
+	std::vector<std::uint64_t> MakeSequentialKeys(size_t n)
+	{
+		std::vector<std::uint64_t> keys(n);
+		for (size_t i = 0; i < n; ++i) keys[i] = 0x10000 + 16 * i;
+		return keys;
+	}
+
+	// Insertion into an empty map, lookups of keys in the map and of keys not in it, then erasure of every key
+	template<class Map>
+	void MeasureMap(Context& context, const std::string& sMap, const std::string& sKeys, const std::vector<std::uint64_t>& keys, const std::vector<std::uint64_t>& missingKeys)
+	{
+		auto const sPrefix = sMap + "/" + sKeys + "/";
+		volatile std::uint64_t nSink = 0;
+
+		context.measure(sPrefix + "Insert", keys.size(), [&]() {
+			Map map;
+			for (auto const nKey : keys) map[nKey] = nKey;
+			nSink = nSink + map.size();
+		});
+
+		Map map;
+		for (auto const nKey : keys) map[nKey] = nKey;
+
+		context.measure(sPrefix + "FindHit", keys.size(), [&]() {
+			std::uint64_t nSum = 0;
+			for (auto const nKey : keys) nSum += map.find(nKey)->second;
+			nSink = nSink + nSum;
+		});
+
+		context.measure(sPrefix + "FindMiss", missingKeys.size(), [&]() {
+			size_t nFound = 0;
+			for (auto const nKey : missingKeys) nFound += map.count(nKey);
+			nSink = nSink + nFound;
+		});
+
+		context.measure(sPrefix + "Erase", keys.size(), [&]() {
+			Map erased;
+			for (auto const nKey : keys) erased[nKey] = nKey;
+			for (auto const nKey : keys) erased.erase(nKey);
+			nSink = nSink + erased.size();
+		});
+	}
+
+	template<class Map>
+	void MeasureMap(Context& context, const std::string& sMap)
+	{
+		Random random;
+		auto const randomKeys = MakeRandomKeys(key_count, random);
+		auto const missingRandomKeys = MakeRandomKeys(key_count, random);
+		MeasureMap<Map>(context, sMap, "Random", randomKeys, missingRandomKeys);
+
+		auto const sequentialKeys = MakeSequentialKeys(2 * key_count);
+		std::vector<std::uint64_t> const presentSequentialKeys(sequentialKeys.begin(), sequentialKeys.begin() + key_count);
+		std::vector<std::uint64_t> const missingSequentialKeys(sequentialKeys.begin() + key_count, sequentialKeys.end());
+		MeasureMap<Map>(context, sMap, "Sequential", presentSequentialKeys, missingSequentialKeys);
+	}
+}
+
+// The erase benchmark also includes the insertions that fill the map
+HE_BENCHMARK(FlatHashMapBench)
+{
+	MeasureMap<FlatHashMap<std::uint64_t, std::uint64_t>>(context, "FlatHashMap<uint64,uint64>");
+	MeasureMap<std::unordered_map<std::uint64_t, std::uint64_t>>(context, "std::unordered_map<uint64,uint64>");
+}
\ No newline at end of file
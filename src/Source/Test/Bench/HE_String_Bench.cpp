@@ -0,0 +1,88 @@
+#include "AllocatorBench.h"
+#include "HE_String.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace HE;
+using namespace HE::Bench;
+
+namespace
+{
+	constexpr size_t format_count = 10000;
+}
+
+// A typical log line, formatted with a format string parsed at run-time and during compilation
+HE_BENCHMARK(FormatBench)
+{
+	size_t nSink = 0;
+
+	context.measure("Format/Runtime", format_count, [&]() {
+		for (size_t i = 0; i < format_count; ++i)
+		{
+			nSink += Format("[{_}] entity {_} moved to {_:.2}, {_:.2}", "Simulation", i, 1.5f * i, -2.25f).size();
+		}
+	});
+
+	context.measure("Format/Compiled", format_count, [&]() {
+		for (size_t i = 0; i < format_count; ++i)
+		{
+			nSink += Format(HE_FORMAT("[{_}] entity {_} moved to {_:.2}, {_:.2}"), "Simulation", i, 1.5f * i, -2.25f).size();
+		}
+	});
+
+	context.measure("Format/CompiledToBuffer", format_count, [&]() {
+		char buffer[256];
+		for (size_t i = 0; i < format_count; ++i)
+		{
+			nSink += FormatTo(buffer, HE_FORMAT("[{_}] entity {_} moved to {_:.2}, {_:.2}"), "Simulation", i, 1.5f * i, -2.25f).size;
+		}
+	});
+
+	context.measure("Format/RuntimeNoArguments", format_count, [&]() {
+		for (size_t i = 0; i < format_count; ++i) nSink += Format("HazelEngine has stopped", i).size();
+	});
+
+	context.measure("Format/CompiledNoArguments", format_count, [&]() {
+		for (size_t i = 0; i < format_count; ++i) nSink += Format(HE_FORMAT("HazelEngine has stopped"), i).size();
+	});
+
+	if (nSink == 0) Log("");
+}
+
+// Telemetry-like numbers, written by snprintf and by WriteDecimal and WriteShortest
+HE_BENCHMARK(NumberFormatBench)
+{
+	constexpr size_t number_count = 4096;
+	std::vector<long long> integers(number_count);
+	std::vector<double> doubles(number_count);
+	Random random;
+	for (size_t i = 0; i < number_count; ++i)
+	{
+		auto const nBits = static_cast<long long>((static_cast<std::uint64_t>(random()) << 32) | random());
+		integers[i] = nBits >> (random() % 64);
+		doubles[i] = static_cast<double>(random() % 1000000) / 1000.0 + static_cast<double>(i);
+	}
+
+	size_t nSink = 0;
+	char buffer[max_number_chars];
+
+	context.measure("NumberFormat/IntegerSnprintf", number_count, [&]() {
+		for (auto const n : integers) nSink += static_cast<size_t>(std::snprintf(buffer, sizeof(buffer), "%lld", n));
+	});
+
+	context.measure("NumberFormat/IntegerWriteDecimal", number_count, [&]() {
+		for (auto const n : integers) nSink += static_cast<size_t>(WriteDecimal(buffer, n) - buffer);
+	});
+
+	context.measure("NumberFormat/DoubleSnprintf", number_count, [&]() {
+		for (auto const d : doubles) nSink += static_cast<size_t>(std::snprintf(buffer, sizeof(buffer), "%.17g", d));
+	});
+
+	context.measure("NumberFormat/DoubleWriteShortest", number_count, [&]() {
+		for (auto const d : doubles) nSink += static_cast<size_t>(WriteShortest(buffer, d) - buffer);
+	});
+
+	if (nSink == 0) Log("");
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "HE_Allocator.h"
 #include "HE_Platform.h"
 
+#include <cstring>
+#include <limits>
+
 using namespace HE;
 
 
@@ -13,6 +16,37 @@ namespace
 	{
 		return reinterpret_cast<size_t>(p) % alignment == 0;
 	}
+
+	// Malloc allocator that counts the calls made to it, so that they can be checked from outside of the allocator
+	// which uses it as its Parent
+	class CountingAllocator
+	{
+	public:
+		static constexpr size_t alignment = MallocAllocator::alignment;
+		static size_t s_nAllocations;
+		static size_t s_nDeallocations;
+
+		static void reset() noexcept
+		{
+			s_nAllocations = 0;
+			s_nDeallocations = 0;
+		}
+
+		Blk allocate(size_t n)
+		{
+			++s_nAllocations;
+			return MallocAllocator::it.allocate(n);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			++s_nDeallocations;
+			MallocAllocator::it.deallocate(b);
+		}
+	};
+
+	size_t CountingAllocator::s_nAllocations = 0;
+	size_t CountingAllocator::s_nDeallocations = 0;
 }
 
 TEST(NullAllocator, Allocate)
@@ -106,6 +140,177 @@ TEST(LightInlineAllocator, Owns)
 	EXPECT_TRUE(a.owns(b2));
 }
 
+TEST(StackAllocator, Allocate)
+{
+	StackAllocator<64> a;
+	auto const b1 = allocate<size_t>(a);
+	auto const b2 = allocate<size_t>(a);
+
+	EXPECT_NE(nullptr, b1.ptr);
+	EXPECT_EQ(sizeof(size_t), b1.length);
+	EXPECT_EQ(static_cast<char*>(b1.ptr) + Math::RoundUpToMultipleOf(sizeof(size_t), a.alignment), b2.ptr);
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b2.ptr) = 42ull);
+}
+
+TEST(StackAllocator, AllocateAligned)
+{
+	StackAllocator<128> a;
+	a.allocate(1);
+	auto const b = a.allocate(sizeof(size_t) * 4, alignof(size_t) * 4);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(sizeof(size_t) * 4, b.length);
+	EXPECT_TRUE(IsAligned(b.ptr, alignof(size_t) * 4));
+}
+
+TEST(StackAllocator, Full)
+{
+	StackAllocator<32> a;
+	EXPECT_NE(nullptr, a.allocate(32).ptr);
+	EXPECT_EQ(nullptr, a.allocate(1).ptr);
+}
+
+TEST(StackAllocator, Overflow)
+{
+	auto const nMax = std::numeric_limits<size_t>::max();
+	StackAllocator<256> a;
+	auto b = a.allocate(16);
+
+	EXPECT_EQ(nullptr, a.allocate(nMax).ptr);
+	EXPECT_EQ(nullptr, a.allocate(nMax - 5).ptr);
+	EXPECT_EQ(nullptr, a.allocate(nMax - 5, alignof(size_t) * 4).ptr);
+	EXPECT_FALSE(a.expand(b, nMax - 20));
+	EXPECT_EQ(16, a.size());
+
+	FallbackAllocator<StackAllocator<256>, NullAllocator> f;
+	EXPECT_EQ(nullptr, f.allocate(nMax - 5).ptr);
+}
+
+TEST(StackAllocator, Deallocate)
+{
+	StackAllocator<64> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(16);
+
+	// Out of order deallocations are ignored
+	a.deallocate(b1);
+	EXPECT_EQ(32, a.size());
+
+	a.deallocate(b2);
+	a.deallocate(b1);
+	EXPECT_EQ(0, a.size());
+	EXPECT_EQ(b1.ptr, a.allocate(16).ptr);
+}
+
+TEST(StackAllocator, Owns)
+{
+	StackAllocator<64> a;
+	auto const b = allocate<size_t>(a);
+	EXPECT_TRUE(a.owns(b));
+	EXPECT_FALSE(a.owns({ &a + 1, 8 }));
+}
+
+TEST(StackAllocator, Rewind)
+{
+	StackAllocator<64> a;
+	a.allocate(8);
+	auto const m = a.marker();
+	auto const b = a.allocate(16);
+	a.allocate(8);
+
+	a.rewind(m);
+	EXPECT_EQ(b.ptr, a.allocate(16).ptr);
+
+	a.deallocateAll();
+	EXPECT_EQ(0, a.size());
+}
+
+TEST(StackAllocator, ParentAllocate)
+{
+	StackAllocator<64, MallocAllocator> a;
+	auto const b = allocate<size_t>(a);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_TRUE(a.owns(b));
+
+	StackAllocator<64, NullAllocator> n;
+	EXPECT_EQ(nullptr, n.allocate(sizeof(size_t)).ptr);
+	EXPECT_FALSE(n.owns({ nullptr, 0 }));
+}
+
+TEST(StackAllocator, Fallback)
+{
+	FallbackAllocator<StackAllocator<32>, MallocAllocator> a;
+	auto const b1 = a.allocate(32);
+	auto const b2 = a.allocate(32);
+
+	EXPECT_NE(nullptr, b1.ptr);
+	EXPECT_NE(nullptr, b2.ptr);
+	EXPECT_NO_FATAL_FAILURE(a.deallocate(b2));
+	EXPECT_NO_FATAL_FAILURE(a.deallocate(b1));
+}
+
+TEST(StackAllocator, Segregate)
+{
+	SegregateAllocator<16, StackAllocator<64>, MallocAllocator> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(32);
+
+	EXPECT_EQ(static_cast<void*>(&a), b1.ptr);
+	EXPECT_NE(nullptr, b2.ptr);
+	EXPECT_NO_FATAL_FAILURE(a.deallocate(b2));
+	EXPECT_NO_FATAL_FAILURE(a.deallocate(b1));
+}
+
+TEST(FrameAllocator, Allocate)
+{
+	FrameAllocator<64> a;
+	auto const b = allocate<size_t>(a);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(sizeof(size_t), b.length);
+	EXPECT_TRUE(a.owns(b));
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b.ptr) = 42ull);
+}
+
+TEST(FrameAllocator, NextFrame)
+{
+	FrameAllocator<64, 2> a;
+	auto const b1 = a.allocate(16);
+	*static_cast<size_t*>(b1.ptr) = 42ull;
+
+	// The previous frame's memory is still readable after a frame change
+	a.nextFrame();
+	EXPECT_EQ(1, a.frame());
+	auto const b2 = a.allocate(16);
+	EXPECT_NE(b1.ptr, b2.ptr);
+	EXPECT_EQ(42ull, *static_cast<size_t*>(b1.ptr));
+	EXPECT_TRUE(a.owns(b1));
+
+	// Coming back to the first frame's stack resets it
+	a.nextFrame();
+	EXPECT_EQ(0, a.frame());
+	EXPECT_EQ(b1.ptr, a.allocate(16).ptr);
+}
+
+TEST(FrameAllocator, DeallocateAll)
+{
+	FrameAllocator<32, 3> a;
+	auto const b1 = a.allocate(32);
+	a.nextFrame();
+	a.allocate(32);
+	EXPECT_EQ(nullptr, a.allocate(1).ptr);
+
+	a.deallocateAll();
+	EXPECT_NE(nullptr, a.allocate(32).ptr);
+	a.nextFrame();
+	a.nextFrame();
+	EXPECT_EQ(b1.ptr, a.allocate(32).ptr);
+}
+
+static_assert(IsOwningAllocator<FrameAllocator<64>>(), "Test fail on FrameAllocator");
+static_assert(IsAlignedAllocator<FrameAllocator<64, 3, AlignedMallocAllocator>>(), "Test fail on FrameAllocator");
+
 TEST(FallbackAllocator, Allocate)
 {
 	FallbackAllocator<NullAllocator, MallocAllocator> a;
@@ -186,6 +391,63 @@ TEST(FreelistAllocator, Deallocate)
 	EXPECT_NO_FATAL_FAILURE(a.deallocate(blk1));
 }
 
+TEST(FreelistAllocator, BatchAllocate)
+{
+	CountingAllocator::reset();
+	FreelistAllocator<CountingAllocator, 16, 16, 8> a;
+
+	Blk blocks[8];
+	for (auto& b : blocks)
+	{
+		b = a.allocate(16);
+		EXPECT_NE(nullptr, b.ptr);
+		EXPECT_EQ(16, b.length);
+	}
+	EXPECT_EQ(1, CountingAllocator::s_nAllocations);
+
+	// Nodes are carved contiguously from the chunk
+	for (size_t i = 1; i < 8; ++i)
+	{
+		EXPECT_EQ(static_cast<char*>(blocks[0].ptr) + i * 16, blocks[i].ptr);
+	}
+
+	a.allocate(16);
+	EXPECT_EQ(2, CountingAllocator::s_nAllocations);
+}
+
+TEST(FreelistAllocator, BatchDeallocateAll)
+{
+	CountingAllocator::reset();
+	FreelistAllocator<CountingAllocator, 16, 32, 4> a;
+
+	for (size_t i = 0; i < 10; ++i)
+	{
+		a.deallocate(a.allocate(24));
+		a.allocate(16);
+	}
+	EXPECT_EQ(3, CountingAllocator::s_nAllocations);
+
+	// Chunks are freed in bulk, not node by node
+	a.deallocateAll();
+	EXPECT_EQ(3, CountingAllocator::s_nDeallocations);
+	EXPECT_NE(nullptr, a.allocate(16).ptr);
+	EXPECT_EQ(4, CountingAllocator::s_nAllocations);
+}
+
+TEST(FreelistAllocator, DeallocateAll)
+{
+	CountingAllocator::reset();
+	FreelistAllocator<CountingAllocator, 16> a;
+
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(16);
+	a.deallocate(b1);
+	a.deallocate(b2);
+	a.deallocateAll();
+	EXPECT_EQ(2, CountingAllocator::s_nDeallocations);
+}
+
+static_assert(FreelistAllocator<NullAllocator, 16, 16, 4>::is_batched(), "Test fail on FreelistAllocator");
 static_assert(FreelistAllocator<NullAllocator, 16>::has_fast_deallocateAll(), "Test fail on FreelistAllocator");
 static_assert(!FreelistAllocator<MallocAllocator, 16>::has_fast_deallocateAll(), "Test fail on FreelistAllocator");
 
@@ -317,4 +579,592 @@ static_assert(std::is_empty<SegregateAllocator<16, NullAllocator, MallocAllocato
 static_assert(StateSize<SegregateAllocator<16, NullAllocator, MallocAllocator>>::value == 0, "???!");
 
 static_assert(equal_<StateSize<SegregateAllocator<16, NullAllocator, MallocAllocator>>, std::integral_constant<size_t, 0>>::value, "???");
-static_assert(IsStatelessAllocator<SegregateAllocator<16, NullAllocator, MallocAllocator>>(), "Test fail on SegregateAllocator");
\ No newline at end of file
+static_assert(IsStatelessAllocator<SegregateAllocator<16, NullAllocator, MallocAllocator>>(), "Test fail on SegregateAllocator");
+
+namespace
+{
+	template<size_t BucketMin, size_t BucketMax>
+	using FreelistBucket = FreelistAllocator<MallocAllocator, BucketMin, BucketMax>;
+
+	template<size_t BucketMin, size_t BucketMax>
+	using InlineBucket = LightInlineAllocator<BucketMax>;
+}
+
+TEST(Bucketizer, BucketIndex)
+{
+	using A = Bucketizer<FreelistBucket, 0, 256, 16>;
+	EXPECT_EQ(16, A::bucket_count);
+	EXPECT_EQ(0, A::bucketIndex(1));
+	EXPECT_EQ(0, A::bucketIndex(16));
+	EXPECT_EQ(1, A::bucketIndex(17));
+	EXPECT_EQ(15, A::bucketIndex(256));
+	EXPECT_EQ(A::bucket_count, A::bucketIndex(0));
+	EXPECT_EQ(A::bucket_count, A::bucketIndex(257));
+}
+
+TEST(Bucketizer, Allocate)
+{
+	Bucketizer<FreelistBucket, 0, 256, 16> a;
+	auto const b = a.allocate(20);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(20, b.length);
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b.ptr) = 42ull);
+
+	a.deallocate(b);
+}
+
+TEST(Bucketizer, OutOfRangeAllocate)
+{
+	Bucketizer<FreelistBucket, 16, 256, 16> a;
+	EXPECT_EQ(nullptr, a.allocate(16).ptr);
+	EXPECT_EQ(nullptr, a.allocate(257).ptr);
+}
+
+TEST(Bucketizer, SameBucketReuse)
+{
+	Bucketizer<FreelistBucket, 0, 256, 16> a;
+	auto const b1 = a.allocate(20);
+	a.deallocate(b1);
+
+	// 20 and 32 share the 17-32 bucket, 33 does not
+	auto const b2 = a.allocate(33);
+	EXPECT_NE(b1.ptr, b2.ptr);
+	auto const b3 = a.allocate(32);
+	EXPECT_EQ(b1.ptr, b3.ptr);
+
+	a.deallocate(b2);
+	a.deallocate(b3);
+}
+
+TEST(Bucketizer, Owns)
+{
+	Bucketizer<InlineBucket, 0, 64, 32> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(48);
+
+	EXPECT_NE(b1.ptr, b2.ptr);
+	EXPECT_TRUE(a.owns(b1));
+	EXPECT_TRUE(a.owns(b2));
+
+	int i;
+	EXPECT_FALSE(a.owns({ &i, sizeof(i) }));
+}
+
+TEST(LogBucketizer, BucketIndex)
+{
+	using A = LogBucketizer<FreelistBucket, 8, 1024>;
+	EXPECT_EQ(7, A::bucket_count);
+	EXPECT_EQ(0, A::bucketIndex(9));
+	EXPECT_EQ(0, A::bucketIndex(16));
+	EXPECT_EQ(1, A::bucketIndex(17));
+	EXPECT_EQ(6, A::bucketIndex(513));
+	EXPECT_EQ(6, A::bucketIndex(1024));
+	EXPECT_EQ(A::bucket_count, A::bucketIndex(8));
+	EXPECT_EQ(A::bucket_count, A::bucketIndex(1025));
+}
+
+TEST(LogBucketizer, Allocate)
+{
+	LogBucketizer<FreelistBucket, 8, 1024> a;
+	auto const b1 = a.allocate(100);
+	a.deallocate(b1);
+
+	auto const b2 = a.allocate(128);
+	EXPECT_EQ(b1.ptr, b2.ptr);
+	a.deallocate(b2);
+}
+
+static_assert(IsAllocator<Bucketizer<FreelistBucket, 0, 256, 16>>(), "Test fail on Bucketizer");
+static_assert(IsOwningAllocator<Bucketizer<InlineBucket, 0, 64, 32>>(), "Test fail on Bucketizer");
+static_assert(IsAlignedAllocator<Bucketizer<InlineBucket, 0, 64, 32>>(), "Test fail on Bucketizer");
+static_assert(IsAllocator<LogBucketizer<FreelistBucket, 8, 1024>>(), "Test fail on LogBucketizer");
+
+TEST(BitmappedBlock, Allocate)
+{
+	BitmappedBlock<MallocAllocator, 16, 128> a;
+	auto const b = a.allocate(16);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(16, b.length);
+	EXPECT_TRUE(IsAligned(static_cast<char*>(b.ptr), decltype(a)::alignment));
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b.ptr) = 42ull);
+
+	a.deallocate(b);
+}
+
+TEST(BitmappedBlock, Contiguous)
+{
+	BitmappedBlock<void, 16, 128> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(40); // 3 blocks
+	auto const b3 = a.allocate(1);
+
+	EXPECT_EQ(static_cast<char*>(b1.ptr) + 16, b2.ptr);
+	EXPECT_EQ(static_cast<char*>(b2.ptr) + 48, b3.ptr);
+}
+
+TEST(BitmappedBlock, Full)
+{
+	// Count isn't a multiple of the bitmap's word size
+	BitmappedBlock<void, 8, 100> a;
+	for (int i = 0; i < 100; ++i)
+	{
+		ASSERT_NE(nullptr, a.allocate(8).ptr);
+	}
+	EXPECT_EQ(nullptr, a.allocate(8).ptr);
+
+	a.deallocateAll();
+	EXPECT_EQ(nullptr, a.allocate(801).ptr);
+	EXPECT_NE(nullptr, a.allocate(800).ptr);
+}
+
+TEST(BitmappedBlock, Deallocate)
+{
+	BitmappedBlock<void, 16, 8> a;
+	Blk blocks[8];
+	for (auto& b : blocks) b = a.allocate(16);
+
+	// Free blocks 2, 4, 5 and 6: only the last three can hold a 3 block allocation
+	a.deallocate(blocks[2]);
+	a.deallocate(blocks[4]);
+	a.deallocate(blocks[5]);
+	a.deallocate(blocks[6]);
+
+	EXPECT_EQ(blocks[4].ptr, a.allocate(48).ptr);
+	EXPECT_EQ(blocks[2].ptr, a.allocate(16).ptr);
+	EXPECT_EQ(nullptr, a.allocate(16).ptr);
+}
+
+TEST(BitmappedBlock, CrossWordRun)
+{
+	BitmappedBlock<void, 8, 256> a;
+	for (int i = 0; i < 60; ++i) a.allocate(8);
+
+	// Blocks 60 to 69 straddle the first two words of the bitmap
+	auto const b = a.allocate(80);
+	auto const first = a.allocate(8);
+	EXPECT_EQ(static_cast<char*>(b.ptr) + 80, first.ptr);
+
+	a.deallocate(b);
+	EXPECT_EQ(b.ptr, a.allocate(80).ptr);
+}
+
+TEST(BitmappedBlock, SparseBitmap)
+{
+	// Most of the words are full, so the search skips them
+	BitmappedBlock<MallocAllocator, 8, 1024> a;
+	Blk blocks[1024];
+	for (auto& b : blocks) b = a.allocate(8);
+	EXPECT_EQ(nullptr, a.allocate(8).ptr);
+
+	a.deallocate(blocks[1000]);
+	a.deallocate(blocks[900]);
+	EXPECT_EQ(blocks[900].ptr, a.allocate(8).ptr);
+	EXPECT_EQ(blocks[1000].ptr, a.allocate(8).ptr);
+}
+
+TEST(BitmappedBlock, DeallocateAll)
+{
+	BitmappedBlock<void, 16, 4> a;
+	auto const b = a.allocate(64);
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(nullptr, a.allocate(16).ptr);
+
+	a.deallocateAll();
+	EXPECT_EQ(b.ptr, a.allocate(64).ptr);
+}
+
+TEST(BitmappedBlock, Owns)
+{
+	BitmappedBlock<MallocAllocator, 16, 16> a;
+	auto const b = a.allocate(32);
+	EXPECT_TRUE(a.owns(b));
+
+	int i;
+	EXPECT_FALSE(a.owns({ &i, sizeof(i) }));
+}
+
+TEST(BitmappedBlock, Fallback)
+{
+	FallbackAllocator<BitmappedBlock<void, 16, 2>, MallocAllocator> a;
+	auto const b1 = a.allocate(32);
+	auto const b2 = a.allocate(16);
+
+	EXPECT_NE(nullptr, b2.ptr);
+	a.deallocate(b2);
+	a.deallocate(b1);
+}
+
+static_assert(IsOwningAllocator<BitmappedBlock<MallocAllocator, 16, 16>>(), "Test fail on BitmappedBlock");
+static_assert(BitmappedBlock<MallocAllocator, 16, 16>::alignment == MallocAllocator::alignment, "Test fail on BitmappedBlock");
+static_assert(BitmappedBlock<void, 12, 16>::alignment == 4, "Test fail on BitmappedBlock");
+
+TEST(CompactingAllocator, Allocate)
+{
+	CompactingAllocator<MallocAllocator, 1024> a;
+	auto const h = a.allocate(20);
+	ASSERT_FALSE(h.isNull());
+
+	auto const b = a.resolve(h);
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(20, b.length);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b.ptr) % decltype(a)::alignment);
+
+	a.deallocate(h);
+	EXPECT_FALSE(a.contains(h));
+	EXPECT_EQ(nullptr, a.resolve(h).ptr);
+	EXPECT_EQ(0, a.size());
+}
+
+TEST(CompactingAllocator, Full)
+{
+	CompactingAllocator<void, 256, 2> a;
+	EXPECT_TRUE(a.allocate(1024).isNull());
+
+	EXPECT_FALSE(a.allocate(8).isNull());
+	EXPECT_FALSE(a.allocate(8).isNull());
+	EXPECT_TRUE(a.allocate(8).isNull()); // Out of handles
+}
+
+// With a Parent, the redirection table is allocated after the heap instead of inline
+TEST(CompactingAllocator, ParentTable)
+{
+	CompactingAllocator<MallocAllocator, 1001, 4> a;
+	decltype(a)::Handle handles[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		handles[i] = a.allocate(240);
+		ASSERT_FALSE(handles[i].isNull());
+		auto const b = a.resolve(handles[i]);
+		std::memset(b.ptr, i, b.length);
+	}
+	EXPECT_TRUE(a.allocate(8).isNull()); // Out of handles
+
+	for (int i = 0; i < 4; ++i)
+	{
+		auto const b = a.resolve(handles[i]);
+		ASSERT_EQ(240, b.length);
+		EXPECT_EQ(i, static_cast<char*>(b.ptr)[239]);
+		a.deallocate(handles[i]);
+	}
+}
+
+TEST(CompactingAllocator, Compact)
+{
+	CompactingAllocator<void, 1024> a;
+	decltype(a)::Handle handles[8];
+	for (int i = 0; i < 8; ++i)
+	{
+		handles[i] = a.allocate(24);
+		*static_cast<int*>(a.resolve(handles[i]).ptr) = i;
+	}
+	for (int i = 0; i < 8; i += 2) a.deallocate(handles[i]);
+
+	EXPECT_FALSE(a.isCompact());
+	EXPECT_EQ(4, a.fragmentation().freeBlocks);
+
+	EXPECT_EQ(4 * 32, a.compact());
+	EXPECT_TRUE(a.isCompact());
+	EXPECT_EQ(4 * 32, a.size());
+	for (int i = 1; i < 8; i += 2) EXPECT_EQ(i, *static_cast<int*>(a.resolve(handles[i]).ptr));
+
+	auto const fragmentation = a.fragmentation();
+	EXPECT_EQ(0, fragmentation.freeBlocks);
+	EXPECT_EQ(0, fragmentation.freeBytes);
+	EXPECT_EQ(0.0, fragmentation.ratio());
+}
+
+TEST(CompactingAllocator, IncrementalCompact)
+{
+	CompactingAllocator<void, 1024> a;
+	decltype(a)::Handle handles[8];
+	for (auto& h : handles) h = a.allocate(24);
+	a.deallocate(handles[0]);
+
+	// Each block is 32 bytes with its header, so a budget of 40 bytes moves two of them
+	EXPECT_EQ(64, a.compact(40));
+	EXPECT_FALSE(a.isCompact());
+	EXPECT_EQ(static_cast<char*>(a.resolve(handles[1]).ptr) + 32, a.resolve(handles[2]).ptr);
+
+	EXPECT_EQ(5 * 32, a.compactFor(std::chrono::milliseconds{ 10 }));
+	EXPECT_TRUE(a.isCompact());
+	EXPECT_EQ(7 * 32, a.size());
+}
+
+TEST(CompactingAllocator, Fragmentation)
+{
+	CompactingAllocator<void, 1024> a;
+	auto const h1 = a.allocate(56);
+	auto const h2 = a.allocate(24);
+	a.allocate(24);
+	a.deallocate(h1);
+	a.deallocate(h2);
+
+	auto const fragmentation = a.fragmentation();
+	EXPECT_EQ(32, fragmentation.liveBytes);
+	EXPECT_EQ(96, fragmentation.freeBytes);
+	EXPECT_EQ(1, fragmentation.freeBlocks);
+	EXPECT_EQ(1024 - 128, fragmentation.largestFreeBlock);
+	EXPECT_GT(fragmentation.ratio(), 0.0);
+}
+
+TEST(CompactingAllocator, ReuseHole)
+{
+	CompactingAllocator<void, 128, 4> a;
+	auto const h1 = a.allocate(56);
+	auto const h2 = a.allocate(56);
+	a.deallocate(h1);
+
+	// The top is full, so the allocation goes in the hole, and splits it
+	auto const h3 = a.allocate(24);
+	ASSERT_FALSE(h3.isNull());
+	EXPECT_LT(a.resolve(h3).ptr, a.resolve(h2).ptr);
+	EXPECT_FALSE(a.allocate(24).isNull());
+	EXPECT_TRUE(a.allocate(24).isNull());
+}
+
+// Deallocating the top block also gives back the holes right below it
+TEST(CompactingAllocator, HolesJoinTop)
+{
+	CompactingAllocator<void, 128, 4> a;
+	auto const h1 = a.allocate(56);
+	auto const h2 = a.allocate(56);
+	a.deallocate(h1);
+	a.deallocate(h2);
+
+	EXPECT_TRUE(a.isCompact());
+	EXPECT_EQ(0, a.size());
+	EXPECT_EQ(0, a.fragmentation().freeBlocks);
+	EXPECT_EQ(0.0, a.fragmentation().ratio());
+	EXPECT_FALSE(a.allocate(120).isNull());
+}
+
+TEST(CompactingAllocator, DeallocateAll)
+{
+	CompactingAllocator<void, 256> a;
+	auto const h = a.allocate(64);
+	a.deallocateAll();
+
+	EXPECT_FALSE(a.contains(h));
+	EXPECT_EQ(0, a.size());
+	EXPECT_FALSE(a.allocate(240).isNull());
+}
+
+static_assert(!IsAllocator<CompactingAllocator<void, 256>>(), "Test fail on CompactingAllocator");
+static_assert(sizeof(CompactingAllocator<MallocAllocator, 64 * 1024 * 1024>) < 1024, "Test fail on CompactingAllocator");
+
+TEST(Reallocate, NullBlock)
+{
+	Blk b{ nullptr, 0 };
+	ASSERT_TRUE(reallocate(MallocAllocator::it, b, 16));
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(16, b.length);
+
+	ASSERT_TRUE(reallocate(MallocAllocator::it, b, 0));
+	EXPECT_EQ(nullptr, b.ptr);
+}
+
+TEST(Reallocate, Malloc)
+{
+	auto b = MallocAllocator::it.allocate(16);
+	std::memset(b.ptr, 7, b.length);
+
+	ASSERT_TRUE(reallocate(MallocAllocator::it, b, 4096));
+	EXPECT_EQ(4096, b.length);
+	EXPECT_EQ(7, static_cast<char*>(b.ptr)[15]);
+
+	MallocAllocator::it.deallocate(b);
+}
+
+TEST(Reallocate, ByCopy)
+{
+	// AlignedMallocAllocator has no reallocate, so the block is moved
+	auto b = AlignedMallocAllocator::it.allocate(16);
+	std::memset(b.ptr, 7, b.length);
+
+	ASSERT_TRUE(reallocate(AlignedMallocAllocator::it, b, 64));
+	EXPECT_EQ(64, b.length);
+	EXPECT_EQ(7, static_cast<char*>(b.ptr)[15]);
+
+	AlignedMallocAllocator::it.deallocate(b);
+}
+
+TEST(Reallocate, KeepsAlignment)
+{
+	// aligned_alloc requires sizes that are multiples of the alignment
+	constexpr size_t alignment = 4 * AlignedMallocAllocator::alignment;
+	Blk b{ nullptr, 0 };
+	ASSERT_TRUE(reallocate(AlignedMallocAllocator::it, b, alignment, alignment));
+	EXPECT_TRUE(IsAligned(b.ptr, alignment));
+	std::memset(b.ptr, 7, b.length);
+
+	ASSERT_TRUE(reallocate(AlignedMallocAllocator::it, b, 4096, alignment));
+	EXPECT_EQ(4096, b.length);
+	EXPECT_TRUE(IsAligned(b.ptr, alignment));
+	EXPECT_EQ(7, static_cast<char*>(b.ptr)[alignment - 1]);
+	std::memset(b.ptr, 9, b.length);
+
+	ASSERT_TRUE(reallocate(AlignedMallocAllocator::it, b, alignment, alignment));
+	EXPECT_TRUE(IsAligned(b.ptr, alignment));
+	EXPECT_EQ(9, static_cast<char*>(b.ptr)[alignment - 1]);
+
+	ASSERT_TRUE(reallocate(AlignedMallocAllocator::it, b, 0, alignment));
+	EXPECT_EQ(nullptr, b.ptr);
+}
+
+TEST(StackAllocator, Expand)
+{
+	StackAllocator<64> a;
+	auto b1 = a.allocate(16);
+	auto b2 = a.allocate(16);
+
+	EXPECT_FALSE(a.expand(b1, 16));
+	EXPECT_TRUE(a.expand(b2, 16));
+	EXPECT_EQ(32, b2.length);
+	EXPECT_EQ(48, a.size());
+	EXPECT_FALSE(a.expand(b2, 32));
+}
+
+TEST(StackAllocator, Reallocate)
+{
+	StackAllocator<128> a;
+	auto b1 = a.allocate(16);
+	auto const b2 = a.allocate(16);
+	std::memset(b1.ptr, 7, b1.length);
+
+	// b1 isn't the last block, so it is moved after b2
+	ASSERT_TRUE(reallocate(a, b1, 32));
+	EXPECT_EQ(static_cast<char*>(b2.ptr) + 16, b1.ptr);
+	EXPECT_EQ(7, static_cast<char*>(b1.ptr)[15]);
+
+	// Now it is, so it shrinks in place
+	ASSERT_TRUE(reallocate(a, b1, 8));
+	EXPECT_EQ(static_cast<char*>(b1.ptr) + Math::RoundUpToMultipleOf(8, decltype(a)::alignment), a.allocate(8).ptr);
+}
+
+TEST(StackAllocator, ShrinkInPlace)
+{
+	StackAllocator<64> a;
+	auto b1 = a.allocate(32);
+	auto const p = b1.ptr;
+	a.allocate(32);
+	ASSERT_EQ(nullptr, a.allocate(1).ptr);
+
+	// b1 isn't the last block, and the stack is full, but it shrinks without moving
+	ASSERT_TRUE(reallocate(a, b1, 8));
+	EXPECT_EQ(p, b1.ptr);
+	EXPECT_EQ(8, b1.length);
+}
+
+TEST(LightInlineAllocator, Reallocate)
+{
+	LightInlineAllocator<32> a;
+	auto b = a.allocate(16);
+	EXPECT_TRUE(a.expand(b, 16));
+	EXPECT_FALSE(a.expand(b, 1));
+	EXPECT_FALSE(reallocate(a, b, 64));
+	EXPECT_EQ(32, b.length);
+}
+
+TEST(FallbackAllocator, Reallocate)
+{
+	FallbackAllocator<StackAllocator<32>, MallocAllocator> a;
+	auto b = a.allocate(16);
+	std::memset(b.ptr, 7, b.length);
+
+	// Grows in place in the Primary, then moves to the Fallback
+	auto const p = b.ptr;
+	ASSERT_TRUE(reallocate(a, b, 32));
+	EXPECT_EQ(p, b.ptr);
+	ASSERT_TRUE(reallocate(a, b, 64));
+	EXPECT_NE(p, b.ptr);
+	EXPECT_EQ(7, static_cast<char*>(b.ptr)[15]);
+	EXPECT_EQ(64, b.length);
+
+	a.deallocate(b);
+}
+
+TEST(FreelistAllocator, Reallocate)
+{
+	FreelistAllocator<MallocAllocator, 16, 64> a;
+	auto b = a.allocate(16);
+	auto const p = b.ptr;
+
+	EXPECT_TRUE(a.expand(b, 48));
+	EXPECT_EQ(p, b.ptr);
+	EXPECT_FALSE(a.expand(b, 1));
+
+	ASSERT_TRUE(reallocate(a, b, 32));
+	EXPECT_EQ(p, b.ptr);
+	ASSERT_TRUE(reallocate(a, b, 128));
+	EXPECT_EQ(128, b.length);
+
+	a.deallocate(b);
+}
+
+TEST(BitmappedBlock, Reallocate)
+{
+	BitmappedBlock<void, 16, 8> a;
+	auto b1 = a.allocate(16);
+	auto const b2 = a.allocate(16);
+	a.deallocate(b2);
+
+	EXPECT_TRUE(a.expand(b1, 16));
+	EXPECT_EQ(32, b1.length);
+	auto const b3 = a.allocate(16);
+	EXPECT_FALSE(a.expand(b1, 1));
+
+	// Moves after b3, then shrinking frees the tail blocks
+	ASSERT_TRUE(reallocate(a, b1, 48));
+	EXPECT_EQ(static_cast<char*>(b3.ptr) + 16, b1.ptr);
+	ASSERT_TRUE(reallocate(a, b1, 16));
+	EXPECT_EQ(static_cast<char*>(b1.ptr) + 16, a.allocate(48).ptr);
+}
+
+TEST(SegregateAllocator, Reallocate)
+{
+	SegregateAllocator<32, StackAllocator<64>, MallocAllocator> a;
+	auto b = a.allocate(16);
+	std::memset(b.ptr, 7, b.length);
+
+	ASSERT_TRUE(reallocate(a, b, 32));
+	ASSERT_TRUE(reallocate(a, b, 100)); // Crosses to the large allocator
+	EXPECT_EQ(7, static_cast<char*>(b.ptr)[15]);
+
+	a.deallocate(b);
+}
+
+TEST(Bucketizer, Reallocate)
+{
+	Bucketizer<FreelistBucket, 0, 64, 16> a;
+	auto b = a.allocate(20);
+	auto const p = b.ptr;
+
+	EXPECT_TRUE(a.expand(b, 12));
+	EXPECT_FALSE(a.expand(b, 1));
+	ASSERT_TRUE(reallocate(a, b, 40));
+	EXPECT_NE(p, b.ptr);
+	EXPECT_FALSE(reallocate(a, b, 65));
+
+	a.deallocate(b);
+}
+
+TEST(AffixAllocator, Reallocate)
+{
+	AffixAllocator<MallocAllocator, size_t> a;
+	auto b = a.allocate(16);
+	decltype(a)::Prefix(b) = 42;
+
+	ASSERT_TRUE(reallocate(a, b, 4096));
+	EXPECT_EQ(42, decltype(a)::Prefix(b));
+
+	a.deallocate(b);
+}
+
+static_assert(IsReallocatingAllocator<MallocAllocator>(), "Test fail on MallocAllocator");
+static_assert(!IsExpandingAllocator<MallocAllocator>(), "Test fail on MallocAllocator");
+static_assert(!IsReallocatingAllocator<AlignedMallocAllocator>(), "Test fail on AlignedMallocAllocator");
+static_assert(IsExpandingAllocator<StackAllocator<64>>() && IsReallocatingAllocator<StackAllocator<64>>(), "Test fail on StackAllocator");
+static_assert(IsReallocatingAllocator<AffixAllocator<MallocAllocator, size_t>>(), "Test fail on AffixAllocator");
+static_assert(!IsReallocatingAllocator<AffixAllocator<MallocAllocator, size_t, size_t>>(), "Test fail on AffixAllocator");
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include "HE_ConcurrentAllocator.h"
+#include "HE_RingBuffer.h"
+
+#include <thread>
+#include <vector>
+
+using namespace HE;
+
+namespace
+{
+	// Malloc allocator that counts the calls made to it, so that they can be checked from outside of the allocator
+	// which uses it as its Parent. The ConcurrentFreelistAllocator only uses its Parent under a mutex
+	class CountingAllocator
+	{
+	public:
+		static constexpr size_t alignment = MallocAllocator::alignment;
+		static size_t s_nAllocations;
+		static size_t s_nDeallocations;
+
+		static void reset() noexcept
+		{
+			s_nAllocations = 0;
+			s_nDeallocations = 0;
+		}
+
+		Blk allocate(size_t n)
+		{
+			++s_nAllocations;
+			return MallocAllocator::it.allocate(n);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			++s_nDeallocations;
+			MallocAllocator::it.deallocate(b);
+		}
+	};
+
+	size_t CountingAllocator::s_nAllocations = 0;
+	size_t CountingAllocator::s_nDeallocations = 0;
+}
+
+TEST(SharedAllocator, Allocate)
+{
+	SharedAllocator<MallocAllocator, 16> a;
+	auto const b = a.allocate(16);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(16, b.length);
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b.ptr) = 42ull);
+
+	a.deallocate(b);
+}
+
+TEST(SharedAllocator, OutOfRangeAllocate)
+{
+	SharedAllocator<MallocAllocator, 16, 32> a;
+	auto const b = a.allocate(64);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(64, b.length);
+
+	a.deallocate(b);
+}
+
+TEST(SharedAllocator, LocalReuse)
+{
+	SharedAllocator<MallocAllocator, 16> a;
+	auto const b1 = a.allocate(16);
+	a.deallocate(b1);
+
+	auto const b2 = a.allocate(16);
+	EXPECT_EQ(b1.ptr, b2.ptr);
+	a.deallocate(b2);
+}
+
+TEST(SharedAllocator, RemoteDeallocate)
+{
+	SharedAllocator<MallocAllocator, 16, 16, 2> a;
+	auto const b1 = a.allocate(16);
+
+	std::thread{ [&a, b1]() { a.deallocate(b1); } }.join();
+
+	// The magazine only had one node, so the next miss reclaims the remote node
+	auto const b2 = a.allocate(16);
+	EXPECT_EQ(b1.ptr, b2.ptr);
+	a.deallocate(b2);
+}
+
+TEST(SharedAllocator, Owns)
+{
+	SharedAllocator<StackAllocator<1024>, 16> a;
+	auto const b = a.allocate(16);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_TRUE(a.owns(b));
+
+	StackAllocator<64> other;
+	EXPECT_FALSE(a.owns(other.allocate(16)));
+
+	a.deallocate(b);
+}
+
+// The magazines are allocated on the Parent along with the nodes, and given back to it on destruction
+TEST(SharedAllocator, ParentMagazines)
+{
+	CountingAllocator::reset();
+	{
+		SharedAllocator<CountingAllocator, 16, 16, 4> a;
+		a.deallocate(a.allocate(16));
+		EXPECT_EQ(1 + 2, CountingAllocator::s_nAllocations);
+
+		std::thread{ [&a]() { a.deallocate(a.allocate(16)); } }.join();
+		EXPECT_EQ(2 * (1 + 2), CountingAllocator::s_nAllocations);
+	}
+	EXPECT_EQ(CountingAllocator::s_nAllocations, CountingAllocator::s_nDeallocations);
+}
+
+TEST(SharedAllocator, ConcurrentAllocate)
+{
+	SharedAllocator<MallocAllocator, 8, 64, 16> a;
+	auto const nThreads = 4;
+	auto const nIterations = 10000;
+
+	// Each thread frees the blocks of its neighbour, checking their content
+	std::vector<std::vector<Blk>> handoffs(nThreads);
+	std::vector<std::thread> threads;
+	std::atomic<int> nErrors{ 0 };
+	for (int t = 0; t < nThreads; ++t)
+	{
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < nIterations; ++i)
+			{
+				auto const b = a.allocate(8 + i % 57);
+				*static_cast<int*>(b.ptr) = t;
+				handoffs[t].push_back(b);
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	threads.clear();
+
+	for (int t = 0; t < nThreads; ++t)
+	{
+		threads.emplace_back([&, t]() {
+			auto const nOther = (t + 1) % nThreads;
+			for (auto const& b : handoffs[nOther])
+			{
+				if (*static_cast<int*>(b.ptr) != nOther) ++nErrors;
+				a.deallocate(b);
+				a.deallocate(a.allocate(32));
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	EXPECT_EQ(0, nErrors);
+}
+
+TEST(ConcurrentFreelistAllocator, Allocate)
+{
+	ConcurrentFreelistAllocator<MallocAllocator, 16> a;
+	auto const b = a.allocate(16);
+
+	EXPECT_NE(nullptr, b.ptr);
+	EXPECT_EQ(16, b.length);
+	EXPECT_NO_FATAL_FAILURE(*reinterpret_cast<size_t*>(b.ptr) = 42ull);
+
+	a.deallocate(b);
+}
+
+TEST(ConcurrentFreelistAllocator, Reuse)
+{
+	ConcurrentFreelistAllocator<MallocAllocator, 17, 32> a;
+	auto const b1 = a.allocate(23);
+	a.deallocate(b1);
+
+	auto const b2 = a.allocate(32);
+	EXPECT_EQ(b1.ptr, b2.ptr);
+	EXPECT_EQ(32, b2.length);
+	a.deallocate(b2);
+}
+
+TEST(ConcurrentFreelistAllocator, MaxNodes)
+{
+	ConcurrentFreelistAllocator<MallocAllocator, 16, 16, 1, 1> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(16);
+	a.deallocate(b1);
+	a.deallocate(b2); // Goes back to the Parent
+
+	EXPECT_EQ(b1.ptr, a.allocate(16).ptr);
+}
+
+TEST(ConcurrentFreelistAllocator, Owns)
+{
+	ConcurrentFreelistAllocator<StackAllocator<64>, 16> a;
+	auto const b = a.allocate(16);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_TRUE(a.owns(b));
+
+	StackAllocator<64> other;
+	EXPECT_FALSE(a.owns(other.allocate(16)));
+
+	a.deallocate(b);
+}
+
+TEST(ConcurrentFreelistAllocator, DeallocateAll)
+{
+	ConcurrentFreelistAllocator<MallocAllocator, 16> a;
+	a.deallocate(a.allocate(16));
+	EXPECT_NO_FATAL_FAILURE(a.deallocateAll());
+	EXPECT_NE(nullptr, a.allocate(16).ptr);
+}
+
+static_assert(ConcurrentFreelistAllocator<NullAllocator, 16>::has_fast_deallocateAll(), "Test fail on ConcurrentFreelistAllocator");
+static_assert(!ConcurrentFreelistAllocator<MallocAllocator, 16>::has_fast_deallocateAll(), "Test fail on ConcurrentFreelistAllocator");
+
+// Producers hand their blocks to consumers through a queue, so blocks are deallocated on other threads than the one
+// that allocated them. With a small MaxNodes, consumers also give nodes back to the Parent while producers pop
+TEST(ConcurrentFreelistAllocator, ProducerConsumer)
+{
+	constexpr int thread_count = 2;
+	constexpr int value_count = 20000;
+	CountingAllocator::reset();
+	ConcurrentFreelistAllocator<CountingAllocator, 32, 32, 1, 16> a;
+	MPMCRingBuffer<Blk> queue{ 64 };
+
+	// Every block holds the value it was allocated for. If two threads ever get the same node
+	// at the same time, a consumer sees a value twice
+	std::vector<std::atomic<int>> seen(thread_count * value_count);
+	for (auto& nSeen : seen) nSeen = 0;
+	std::atomic<int> nPopped{ 0 };
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; ++t)
+	{
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < value_count; ++i)
+			{
+				auto const b = a.allocate(32);
+				static_cast<int*>(b.ptr)[4] = t * value_count + i;
+				while (!queue.tryPush(b)) std::this_thread::yield();
+			}
+		});
+
+		threads.emplace_back([&]() {
+			Blk b;
+			while (nPopped < thread_count * value_count)
+			{
+				if (!queue.tryPop(b))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				++seen[static_cast<int*>(b.ptr)[4]];
+				a.deallocate(b);
+				++nPopped;
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	for (auto& nSeen : seen) ASSERT_EQ(1, nSeen.load());
+
+	// Every block allocated on the Parent is either back in it, or in the freelist
+	a.deallocateAll();
+	EXPECT_NE(0u, CountingAllocator::s_nAllocations);
+	EXPECT_EQ(CountingAllocator::s_nAllocations, CountingAllocator::s_nDeallocations);
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include "HE_FlatHashMap.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace HE;
+
+namespace
+{
+	// Puts every key in the same probe sequence
+	struct ConstantHash
+	{
+		size_t operator()(int) const noexcept { return 42; }
+	};
+
+	struct alignas(32) OverAligned
+	{
+		int value;
+	};
+}
+
+TEST(FlatHashMap, Empty)
+{
+	FlatHashMap<int, int> map;
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(0u, map.capacity());
+	EXPECT_FALSE(map.contains(1));
+	EXPECT_EQ(map.end(), map.find(1));
+	EXPECT_EQ(0u, map.erase(1));
+	EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(FlatHashMap, InsertFind)
+{
+	FlatHashMap<int, int> map;
+	auto const result = map.try_emplace(1, 10);
+	EXPECT_TRUE(result.second);
+	EXPECT_EQ(1, result.first->first);
+	EXPECT_EQ(10, result.first->second);
+
+	auto const duplicate = map.try_emplace(1, 20);
+	EXPECT_FALSE(duplicate.second);
+	EXPECT_EQ(10, duplicate.first->second);
+
+	EXPECT_TRUE(map.insert({ 2, 20 }).second);
+	map[3] = 30;
+	map.insert_or_assign(1, 11);
+
+	EXPECT_EQ(3u, map.size());
+	EXPECT_EQ(11, map.find(1)->second);
+	EXPECT_EQ(20, map.find(2)->second);
+	EXPECT_EQ(30, map[3]);
+	EXPECT_EQ(1u, map.count(2));
+	EXPECT_EQ(0u, map.count(4));
+}
+
+TEST(FlatHashMap, Erase)
+{
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 100; ++i) map[i] = i;
+
+	for (int i = 0; i < 100; i += 2) EXPECT_EQ(1u, map.erase(i));
+	EXPECT_EQ(50u, map.size());
+	for (int i = 0; i < 100; ++i) EXPECT_EQ(i % 2 == 1, map.contains(i));
+}
+
+TEST(FlatHashMap, Growth)
+{
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 1000; ++i) map[i] = 2 * i;
+
+	EXPECT_EQ(1000u, map.size());
+	EXPECT_LE(map.load_factor(), 0.875f);
+	for (int i = 0; i < 1000; ++i) EXPECT_EQ(2 * i, map[i]);
+}
+
+// The inserted value refers to an entry that the growth moves
+TEST(FlatHashMap, GrowthWithAliasedValue)
+{
+	FlatHashMap<int, std::string> map;
+	map.reserve(1);
+	auto const nCapacity = map.capacity();
+	for (int i = 0; map.size() < nCapacity - nCapacity / 8; ++i) map[i] = std::string(40, static_cast<char>('a' + i));
+
+	auto const result = map.try_emplace(100, map.find(3)->second);
+	EXPECT_TRUE(result.second);
+	EXPECT_GT(map.capacity(), nCapacity);
+	EXPECT_EQ(std::string(40, 'd'), result.first->second);
+	EXPECT_EQ(std::string(40, 'd'), map[3]);
+}
+
+TEST(FlatHashMap, Reserve)
+{
+	FlatHashMap<int, int> map;
+	map.reserve(100);
+	auto const nCapacity = map.capacity();
+	EXPECT_GE(nCapacity, 100u);
+
+	for (int i = 0; i < 100; ++i) map[i] = i;
+	EXPECT_EQ(nCapacity, map.capacity());
+}
+
+TEST(FlatHashMap, Clear)
+{
+	FlatHashMap<int, std::string> map;
+	for (int i = 0; i < 50; ++i) map[i] = std::to_string(i);
+
+	auto const nCapacity = map.capacity();
+	map.clear();
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(nCapacity, map.capacity());
+	EXPECT_EQ(map.begin(), map.end());
+
+	map[7] = "seven";
+	EXPECT_EQ("seven", map[7]);
+}
+
+// Every key collides, so erasing has to shift the probe sequence back across the end of the table
+TEST(FlatHashMap, Collisions)
+{
+	FlatHashMap<int, int, ConstantHash> map;
+	for (int i = 0; i < 20; ++i) map[i] = i;
+
+	for (int i = 0; i < 20; i += 3) map.erase(i);
+	for (int i = 0; i < 20; ++i)
+	{
+		EXPECT_EQ(i % 3 != 0, map.contains(i));
+		if (i % 3 != 0)
+		{
+			EXPECT_EQ(i, map[i]);
+		}
+	}
+
+	for (int i = 0; i < 20; ++i) map.erase(i);
+	EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatHashMap, Iteration)
+{
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 100; ++i) map[i] = i;
+
+	int nSum = 0;
+	size_t nCount = 0;
+	for (auto& entry : map)
+	{
+		EXPECT_EQ(entry.first, entry.second);
+		entry.second = 0;
+		nSum += entry.first;
+		++nCount;
+	}
+	EXPECT_EQ(100u, nCount);
+	EXPECT_EQ(4950, nSum);
+
+	const auto& cMap = map;
+	for (const auto& entry : cMap) EXPECT_EQ(0, entry.second);
+	FlatHashMap<int, int>::const_iterator it = map.begin();
+	EXPECT_EQ(it, cMap.begin());
+}
+
+TEST(FlatHashMap, OverAligned)
+{
+	FlatHashMap<int, OverAligned, std::hash<int>, AlignedMallocAllocator> map;
+	for (int i = 0; i < 100; ++i) map[i].value = i;
+	for (auto const& entry : map)
+	{
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(&entry.second) % 32);
+		EXPECT_EQ(entry.first, entry.second.value);
+	}
+}
+
+// Random operations, checked against std::unordered_map
+TEST(FlatHashMap, Random)
+{
+	FlatHashMap<std::uint64_t, std::string> map;
+	std::unordered_map<std::uint64_t, std::string> reference;
+	std::mt19937_64 random{ 1234 };
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		auto const nKey = random() % 2048;
+		switch (random() % 3)
+		{
+		case 0:
+			EXPECT_EQ(reference.emplace(nKey, std::to_string(i)).second, map.try_emplace(nKey, std::to_string(i)).second);
+			break;
+		case 1:
+			EXPECT_EQ(reference.erase(nKey), map.erase(nKey));
+			break;
+		default:
+		{
+			auto const it = map.find(nKey);
+			auto const referenceIt = reference.find(nKey);
+			ASSERT_EQ(referenceIt == reference.end(), it == map.end());
+			if (it != map.end())
+			{
+				EXPECT_EQ(referenceIt->second, it->second);
+			}
+			break;
+		}
+		}
+		ASSERT_EQ(reference.size(), map.size());
+	}
+
+	for (auto const& entry : map) EXPECT_EQ(reference.at(entry.first), entry.second);
+}
+
+// These shouldn't compile
+//static_assert(sizeof(FlatHashMap<std::string, int>), "Fail"); // Copying the key of an entry can throw
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "HE_HandlePool.h"
+#include "HE_StatsAllocator.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace HE;
+
+static_assert(Handle<int>{}.isNull(), "Test fail on Handle");
+static_assert(Handle<int>::fromValue(Handle<int>{ 3, 5 }.value()) == Handle<int>{ 3, 5 }, "Test fail on Handle");
+
+TEST(HandlePool, Emplace)
+{
+	HandlePool<std::string> pool;
+	auto const h = pool.emplace(3, 'a');
+
+	EXPECT_FALSE(h.isNull());
+	EXPECT_TRUE(pool.contains(h));
+	EXPECT_EQ("aaa", pool[h]);
+	EXPECT_EQ(1, pool.size());
+}
+
+TEST(HandlePool, Erase)
+{
+	HandlePool<std::string> pool;
+	auto const h1 = pool.insert("first");
+	auto const h2 = pool.insert("second");
+	auto const h3 = pool.insert("third");
+
+	EXPECT_TRUE(pool.erase(h1));
+	EXPECT_FALSE(pool.erase(h1));
+	EXPECT_FALSE(pool.contains(h1));
+	EXPECT_EQ(nullptr, pool.get(h1));
+
+	// The last object was moved in the hole, its handle still refers to it
+	EXPECT_EQ("second", pool[h2]);
+	EXPECT_EQ("third", pool[h3]);
+	EXPECT_EQ(2, pool.size());
+}
+
+TEST(HandlePool, StaleHandle)
+{
+	HandlePool<int> pool;
+	auto const h1 = pool.insert(1);
+	pool.erase(h1);
+
+	// The slot is reused, with another generation
+	auto const h2 = pool.insert(2);
+	EXPECT_EQ(h1.index, h2.index);
+	EXPECT_NE(h1, h2);
+	EXPECT_FALSE(pool.contains(h1));
+	EXPECT_EQ(2, pool[h2]);
+}
+
+TEST(HandlePool, InvalidHandle)
+{
+	HandlePool<int> pool;
+	auto const h = pool.insert(1);
+
+	EXPECT_FALSE(pool.contains(Handle<int>{}));
+	EXPECT_FALSE(pool.contains(Handle<int>{ h.index + 1, h.generation }));
+	EXPECT_FALSE(pool.contains(Handle<int>{ h.index, h.generation + 1 }));
+}
+
+TEST(HandlePool, Pages)
+{
+	HandlePool<int, MallocAllocator, 4> pool;
+	std::vector<Handle<int>> handles;
+	for (int i = 0; i < 100; ++i) handles.push_back(pool.insert(i));
+
+	EXPECT_EQ(100, pool.capacity());
+	for (int i = 0; i < 100; i += 2) pool.erase(handles[i]);
+	for (int i = 1; i < 100; i += 2) EXPECT_EQ(i, pool[handles[i]]);
+
+	EXPECT_EQ(50, pool.size());
+	EXPECT_EQ(100, pool.capacity());
+}
+
+TEST(HandlePool, Iterate)
+{
+	HandlePool<int, MallocAllocator, 4> pool;
+	std::vector<Handle<int>> handles;
+	for (int i = 0; i < 10; ++i) handles.push_back(pool.insert(i));
+	pool.erase(handles[3]);
+
+	std::vector<int> values;
+	for (auto it = pool.begin(); it != pool.end(); ++it)
+	{
+		EXPECT_EQ(*it, pool[it.handle()]);
+		values.push_back(*it);
+	}
+
+	std::sort(values.begin(), values.end());
+	EXPECT_EQ((std::vector<int>{ 0, 1, 2, 4, 5, 6, 7, 8, 9 }), values);
+}
+
+TEST(HandlePool, Clear)
+{
+	HandlePool<std::string> pool;
+	auto const h = pool.insert("value");
+	pool.clear();
+
+	EXPECT_TRUE(pool.empty());
+	EXPECT_FALSE(pool.contains(h));
+	EXPECT_TRUE(pool.contains(pool.insert("other")));
+}
+
+TEST(HandlePool, Allocator)
+{
+	using Stats = StatsAllocator<MallocAllocator, StatsFlags::Allocations | StatsFlags::Deallocations>;
+	HandlePool<int, Stats, 16> pool;
+	for (int i = 0; i < 32; ++i) pool.insert(i);
+	for (int i = 0; i < 16; ++i) pool.erase(pool.handleAt(0));
+	for (int i = 0; i < 16; ++i) pool.insert(i);
+
+	// Two value pages, two slot pages and their two page tables, and nothing per object
+	EXPECT_EQ(6, pool.allocator().stats().allocations);
+	EXPECT_EQ(0, pool.allocator().stats().deallocations);
+}
+
+TEST(HandlePool, OutOfMemory)
+{
+	HandlePool<int, StackAllocator<1024>, 16> pool;
+
+	// A failed insertion leaves the pool untouched
+	std::vector<Handle<int>> handles;
+	EXPECT_THROW(for (;;) handles.push_back(pool.insert(42)), std::bad_alloc);
+	EXPECT_FALSE(handles.empty());
+	EXPECT_THROW(pool.reserve(1000), std::bad_alloc);
+	EXPECT_EQ(handles.size(), pool.size());
+	for (auto const h : handles) EXPECT_TRUE(pool.contains(h));
+}
\ No newline at end of file
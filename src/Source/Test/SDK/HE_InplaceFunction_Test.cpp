@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "HE_InplaceFunction.h"
+
+#include <memory>
+#include <string>
+
+using namespace HE;
+
+TEST(InplaceFunction, Empty)
+{
+	InplaceFunction<void()> f;
+	EXPECT_FALSE(f);
+	EXPECT_TRUE(f == nullptr);
+	EXPECT_THROW(f(), Assert::Exception);
+}
+
+TEST(InplaceFunction, Call)
+{
+	int nCalls = 0;
+	InplaceFunction<int(int)> f = [&nCalls](int i) { ++nCalls; return i * 2; };
+
+	EXPECT_TRUE(f);
+	EXPECT_TRUE(f.isInline());
+	EXPECT_EQ(42, f(21));
+	EXPECT_EQ(1, nCalls);
+}
+
+TEST(InplaceFunction, ReferenceArgument)
+{
+	InplaceFunction<size_t(const std::string&)> f = [](const std::string& s) { return s.size(); };
+	EXPECT_EQ(5, f("hello"));
+}
+
+// The result is discarded, as with std::function
+TEST(InplaceFunction, VoidResult)
+{
+	int nCalls = 0;
+	InplaceFunction<void()> f = [&nCalls]() { return ++nCalls; };
+	f();
+	EXPECT_EQ(1, nCalls);
+}
+
+static_assert(std::is_constructible<InplaceFunction<void(int)>, int(*)(int)>::value, "Test fail on InplaceFunction");
+static_assert(!std::is_constructible<InplaceFunction<void(int)>, int(*)()>::value, "Test fail on InplaceFunction");
+static_assert(!std::is_constructible<InplaceFunction<std::string()>, int(*)()>::value, "Test fail on InplaceFunction");
+
+TEST(InplaceFunction, Large)
+{
+	char buffer[64] = "large";
+	InplaceFunction<char(), 16> f = [buffer]() { return buffer[0]; };
+
+	EXPECT_FALSE(f.isInline());
+	EXPECT_EQ('l', f());
+}
+
+TEST(InplaceFunction, Copy)
+{
+	auto const p = std::make_shared<int>(42);
+	InplaceFunction<int()> f = [p]() { return *p; };
+	auto g = f;
+
+	EXPECT_EQ(3, p.use_count());
+	EXPECT_EQ(42, g());
+
+	g = nullptr;
+	EXPECT_EQ(2, p.use_count());
+	g = f;
+	EXPECT_EQ(42, g());
+}
+
+TEST(InplaceFunction, Move)
+{
+	auto const p = std::make_shared<int>(42);
+	InplaceFunction<int()> f = [p]() { return *p; };
+	auto g = std::move(f);
+
+	EXPECT_FALSE(f);
+	EXPECT_EQ(2, p.use_count());
+	EXPECT_EQ(42, g());
+
+	char buffer[64] = "large";
+	InplaceFunction<char(), 16> large = [buffer]() { return buffer[0]; };
+	auto movedLarge = std::move(large);
+	EXPECT_FALSE(large);
+	EXPECT_EQ('l', movedLarge());
+}
+
+TEST(InplaceFunction, Destroy)
+{
+	auto const p = std::make_shared<int>(42);
+	{
+		InplaceFunction<int()> f = [p]() { return *p; };
+		EXPECT_EQ(2, p.use_count());
+	}
+	EXPECT_EQ(1, p.use_count());
+}
\ No newline at end of file
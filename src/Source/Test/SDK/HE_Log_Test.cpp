@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "HE_Assert.h"
+#include "HE_Log.h"
+#include "HE_Platform.h"
+#include "HE_String.h"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace HE;
+
+namespace
+{
+	std::vector<std::string> Lines(const std::string& sOutput)
+	{
+		std::vector<std::string> lines;
+		std::istringstream stream{ sOutput };
+		for (std::string sLine; std::getline(stream, sLine);) lines.push_back(sLine);
+		return lines;
+	}
+
+	std::string CapturedLog()
+	{
+		FlushLog();
+		return testing::internal::GetCapturedStdout();
+	}
+
+	constexpr int pending_count = 50;
+
+#if defined(PLATFORM_WINDOWS)
+	// The CRT may translate the line ends
+	constexpr const char* pending_line_end = "\\r?\\n";
+#else
+	constexpr const char* pending_line_end = "\n";
+#endif
+
+	// Death tests only match the output on stderr
+	void LogPending()
+	{
+		for (int i = 0; i < pending_count; ++i) LogError("pending {_}", i);
+	}
+
+	std::string PendingLines()
+	{
+		std::string sLines;
+		for (int i = 0; i < pending_count; ++i) sLines += Format("pending {_}", i) + pending_line_end;
+		return sLines;
+	}
+}
+
+TEST(Log, Flush)
+{
+	testing::internal::CaptureStdout();
+	Log("first");
+	Log(std::string{ "second" });
+	Log("{_} + {_}", 1, 2);
+	EXPECT_EQ("first\nsecond\n1 + 2\n", CapturedLog());
+
+	testing::internal::CaptureStderr();
+	LogError("error {_}", 42);
+	FlushLog();
+	EXPECT_EQ("error 42\n", testing::internal::GetCapturedStderr());
+}
+
+// Messages longer than a slot are not interleaved with the others
+TEST(Log, LongMessages)
+{
+	std::string const sLong(1000, 'x');
+	std::string const sSlot(243, 'y');
+
+	testing::internal::CaptureStdout();
+	std::thread other{ [&]() {
+		for (int i = 0; i < 100; ++i) Log(sLong);
+	} };
+	for (int i = 0; i < 100; ++i)
+	{
+		Log(sSlot);
+		Log("");
+	}
+	other.join();
+
+	auto const lines = Lines(CapturedLog());
+	ASSERT_EQ(300u, lines.size());
+	size_t nLong = 0;
+	for (auto const& sLine : lines)
+	{
+		if (sLine == sLong) ++nLong;
+		else EXPECT_TRUE(sLine == sSlot || sLine.empty()) << sLine.size();
+	}
+	EXPECT_EQ(100u, nLong);
+}
+
+// Each thread's messages are written in the order it logged them
+TEST(Log, Threads)
+{
+	constexpr int thread_count = 4;
+	constexpr int message_count = 2000;
+
+	testing::internal::CaptureStdout();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; ++t)
+	{
+		threads.emplace_back([t]() {
+			for (int i = 0; i < message_count; ++i) Log("{_} {_}", t, i);
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	int next[thread_count] = {};
+	auto const lines = Lines(CapturedLog());
+	ASSERT_EQ(size_t{ thread_count * message_count }, lines.size());
+	for (auto const& sLine : lines)
+	{
+		int t, i;
+		ASSERT_EQ(2, std::sscanf(sLine.c_str(), "%d %d", &t, &i)) << sLine;
+		ASSERT_EQ(next[t], i);
+		++next[t];
+	}
+}
+
+// FlushLog returns while another thread keeps logging
+TEST(Log, FlushWhileLogging)
+{
+	testing::internal::CaptureStdout();
+	std::atomic<bool> bStop{ false };
+	std::thread other{ [&]() {
+		while (!bStop.load(std::memory_order_relaxed)) Log("other");
+	} };
+
+	Log("marker");
+	FlushLog();
+	bStop.store(true, std::memory_order_relaxed);
+	other.join();
+
+	auto const lines = Lines(CapturedLog());
+	EXPECT_EQ(1, std::count(lines.begin(), lines.end(), "marker"));
+}
+
+// A full buffer drops the whole message, and counts it
+TEST(Log, Drop)
+{
+	constexpr int message_count = 20000;
+	auto const settings = GetLogSettings();
+	SetLogSettings({ 4 * 256, LogOverflow::Drop });
+	auto const nDropped = DroppedLogMessages();
+
+	testing::internal::CaptureStdout();
+	std::thread{ []() {
+		for (int i = 0; i < message_count; ++i) Log("message {_}", i);
+	} }.join();
+	auto const lines = Lines(CapturedLog());
+	SetLogSettings(settings);
+
+	EXPECT_EQ(size_t{ message_count }, lines.size() + DroppedLogMessages() - nDropped);
+	for (auto const& sLine : lines) EXPECT_EQ(0u, sLine.find("message ")) << sLine;
+}
+
+TEST(Log, EmptyBufferSize)
+{
+	auto const settings = GetLogSettings();
+	EXPECT_THROW(SetLogSettings({ 0, LogOverflow::Block }), Assert::Exception);
+	EXPECT_EQ(settings.threadBufferSize, GetLogSettings().threadBufferSize);
+}
+
+// The messages still in the buffers are written before the process dies
+TEST(LogDeathTest, FlushOnTerminate)
+{
+	EXPECT_DEATH({ LogPending(); std::terminate(); }, PendingLines());
+}
+
+TEST(LogDeathTest, FlushOnAbort)
+{
+	EXPECT_DEATH({ LogPending(); std::raise(SIGABRT); }, PendingLines());
+}
+
+#if !defined(PLATFORM_WINDOWS)
+TEST(LogDeathTest, FlushOnSegfault)
+{
+	EXPECT_EXIT({ LogPending(); std::raise(SIGSEGV); }, testing::KilledBySignal(SIGSEGV), PendingLines());
+}
+#endif
\ No newline at end of file
@@ -19,4 +19,34 @@ static_assert(Max(2, 2.4f, 1.0) == 2.4f, "HE::Math::Max failed to pass test");
 
 static_assert(RoundUpToMultipleOf(1, 4) == 4, "HE::Math::RoundUpToMultipleOf failed to pass test");
 static_assert(RoundUpToMultipleOf(13, 9) == 18, "HE::Math::RoundUpToMultipleOf failed to pass test");
-//static_assert(RoundUpToMultipleOf(1, -2) == 4, "HE::Math::RoundUpToMultipleOf failed to pass test"); // Should not compile
\ No newline at end of file
+//static_assert(RoundUpToMultipleOf(1, -2) == 4, "HE::Math::RoundUpToMultipleOf failed to pass test"); // Should not compile
+
+static_assert(Log2(1) == 0, "HE::Math::Log2 failed to pass test");
+static_assert(Log2(2) == 1, "HE::Math::Log2 failed to pass test");
+static_assert(Log2(1023) == 9, "HE::Math::Log2 failed to pass test");
+static_assert(Log2(1024) == 10, "HE::Math::Log2 failed to pass test");
+
+TEST(Math, CountLeadingZeros)
+{
+	EXPECT_EQ(63, CountLeadingZeros(1));
+	EXPECT_EQ(0, CountLeadingZeros(0x8000000000000000ull));
+	EXPECT_EQ(31, CountLeadingZeros(0x100000000ull));
+}
+
+TEST(Math, CountTrailingZeros)
+{
+	EXPECT_EQ(0, CountTrailingZeros(1));
+	EXPECT_EQ(63, CountTrailingZeros(0x8000000000000000ull));
+	EXPECT_EQ(32, CountTrailingZeros(0x300000000ull));
+}
+
+TEST(Math, Log2)
+{
+	EXPECT_EQ(0, FloorLog2(1));
+	EXPECT_EQ(9, FloorLog2(1023));
+	EXPECT_EQ(10, FloorLog2(1024));
+	EXPECT_EQ(0, CeilLog2(1));
+	EXPECT_EQ(10, CeilLog2(1023));
+	EXPECT_EQ(10, CeilLog2(1024));
+	EXPECT_EQ(11, CeilLog2(1025));
+}
\ No newline at end of file
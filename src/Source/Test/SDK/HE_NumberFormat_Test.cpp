@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "HE_NumberFormat.h"
+#include "HE_String.h"
+
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace HE;
+
+namespace
+{
+	template<class T>
+	std::string Decimal(T val)
+	{
+		char buffer[max_number_chars];
+		return{ buffer, WriteDecimal(buffer, val) };
+	}
+
+	template<class T>
+	std::string Shortest(T val)
+	{
+		char buffer[max_number_chars];
+		return{ buffer, WriteShortest(buffer, val) };
+	}
+
+	template<class Float, class Bits>
+	Float FromBits(Bits bits)
+	{
+		Float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+}
+
+TEST(WriteDecimal, Integers)
+{
+	EXPECT_EQ("0", Decimal(0));
+	EXPECT_EQ("7", Decimal(7u));
+	EXPECT_EQ("-42", Decimal(-42L));
+	EXPECT_EQ("100", Decimal(100));
+	EXPECT_EQ("1000000007", Decimal(1000000007ULL));
+	EXPECT_EQ("-2147483648", Decimal(INT_MIN));
+	EXPECT_EQ("4294967295", Decimal(UINT_MAX));
+	EXPECT_EQ("-9223372036854775808", Decimal(LLONG_MIN));
+	EXPECT_EQ("18446744073709551615", Decimal(ULLONG_MAX));
+
+	for (unsigned long long n = 1; n < ULLONG_MAX / 10; n = n * 10 + 3)
+	{
+		EXPECT_EQ(std::to_string(n), Decimal(n));
+		EXPECT_EQ(std::to_string(n - 1), Decimal(n - 1));
+	}
+}
+
+TEST(WriteShortest, Notation)
+{
+	EXPECT_EQ("0", Shortest(0.0));
+	EXPECT_EQ("-0", Shortest(-0.0));
+	EXPECT_EQ("1.5", Shortest(1.5));
+	EXPECT_EQ("-2.25", Shortest(-2.25f));
+	EXPECT_EQ("1500", Shortest(1500.0));
+	EXPECT_EQ("0.1", Shortest(0.1));
+	EXPECT_EQ("0.1", Shortest(0.1f));
+	EXPECT_EQ("0.30000000000000004", Shortest(0.1 + 0.2));
+	EXPECT_EQ("0.000001", Shortest(1e-6));
+	EXPECT_EQ("1e-7", Shortest(1e-7));
+	EXPECT_EQ("123456789012345680000", Shortest(123456789012345678901.0));
+	EXPECT_EQ("1e+21", Shortest(1e21));
+	EXPECT_EQ("1.7976931348623157e+308", Shortest(DBL_MAX));
+	EXPECT_EQ("5e-324", Shortest(FromBits<double>(std::uint64_t{ 1 })));
+	EXPECT_EQ("2.2250738585072014e-308", Shortest(DBL_MIN));
+	EXPECT_EQ("3.4028235e+38", Shortest(FLT_MAX));
+	EXPECT_EQ("1e-45", Shortest(FromBits<float>(std::uint32_t{ 1 })));
+	EXPECT_EQ("16777216", Shortest(16777216.0f));
+	EXPECT_EQ("inf", Shortest(std::numeric_limits<double>::infinity()));
+	EXPECT_EQ("-inf", Shortest(-std::numeric_limits<float>::infinity()));
+	EXPECT_EQ("nan", Shortest(std::numeric_limits<double>::quiet_NaN()));
+	EXPECT_EQ("0.5", Shortest(0.5L));
+}
+
+// Random bit patterns read back to the same value
+TEST(WriteShortest, RoundTrip)
+{
+	std::mt19937_64 random{ 42 };
+	for (int i = 0; i < 100000; ++i)
+	{
+		auto const d = FromBits<double>(random());
+		if (!std::isfinite(d)) continue;
+
+		auto const s = Shortest(d);
+		ASSERT_EQ(d, std::strtod(s.c_str(), nullptr)) << s;
+		ASSERT_LE(s.size(), 25u);
+
+		auto const f = FromBits<float>(static_cast<std::uint32_t>(random()));
+		if (!std::isfinite(f)) continue;
+
+		auto const sFloat = Shortest(f);
+		ASSERT_EQ(f, std::strtof(sFloat.c_str(), nullptr)) << sFloat;
+		ASSERT_LE(sFloat.size(), 22u);
+	}
+}
+
+TEST(to_string, Numbers)
+{
+	EXPECT_EQ("-12", to_string(-12));
+	EXPECT_EQ("12", to_string(size_t{ 12 }));
+	EXPECT_EQ("0.25", to_string(0.25f));
+	EXPECT_EQ("1e+100", to_string(1e100));
+	EXPECT_EQ("x = 0.1, n = -3", Format("x = {_}, n = {_}", 0.1, -3));
+	EXPECT_EQ("x = 0.1, n = -3", Format(HE_FORMAT("x = {_}, n = {_}"), 0.1f, -3LL));
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include "HE_RingBuffer.h"
+
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace HE;
+
+TEST(SPSCRingBuffer, PushPop)
+{
+	SPSCRingBuffer<int> queue{ 3 };
+	EXPECT_EQ(4u, queue.capacity());
+
+	int nValue = 0;
+	EXPECT_FALSE(queue.tryPop(nValue));
+	for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.tryPush(i));
+	EXPECT_FALSE(queue.tryPush(4));
+	EXPECT_EQ(4u, queue.sizeApprox());
+
+	// Wraps around the end of the storage
+	for (int lap = 0; lap < 3; ++lap)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			EXPECT_TRUE(queue.tryPop(nValue));
+			EXPECT_EQ(i, nValue);
+			EXPECT_TRUE(queue.tryPush(i));
+		}
+	}
+}
+
+TEST(SPSCRingBuffer, Batch)
+{
+	SPSCRingBuffer<int> queue{ 8 };
+	std::vector<int> values(10);
+	std::iota(values.begin(), values.end(), 0);
+
+	EXPECT_EQ(8u, queue.tryPushBatch(values.begin(), values.size()));
+	EXPECT_EQ(0u, queue.tryPushBatch(values.begin() + 8, 2));
+
+	int popped[5];
+	EXPECT_EQ(5u, queue.tryPopBatch(popped, 5));
+	for (int i = 0; i < 5; ++i) EXPECT_EQ(i, popped[i]);
+
+	EXPECT_EQ(2u, queue.tryPushBatch(values.begin() + 8, 2));
+	EXPECT_EQ(5u, queue.tryPopBatch(popped, 5));
+	for (int i = 0; i < 5; ++i) EXPECT_EQ(5 + i, popped[i]);
+	EXPECT_EQ(0u, queue.tryPopBatch(popped, 5));
+}
+
+TEST(SPSCRingBuffer, DestroysRemainingElements)
+{
+	auto const pValue = std::make_shared<int>(0);
+	{
+		SPSCRingBuffer<std::shared_ptr<int>> queue{ 4 };
+		for (int i = 0; i < 3; ++i) queue.tryPush(pValue);
+		EXPECT_EQ(4, pValue.use_count());
+	}
+	EXPECT_EQ(1, pValue.use_count());
+}
+
+TEST(SPSCRingBuffer, Threads)
+{
+	constexpr int value_count = 100000;
+	SPSCRingBuffer<int> queue{ 64 };
+
+	std::thread producer{ [&]() {
+		int i = 0;
+		while (i < value_count)
+		{
+			int batch[8];
+			std::iota(batch, batch + 8, i);
+			auto const nPushed = queue.tryPushBatch(batch, Math::Min(8, value_count - i));
+			if (nPushed == 0) std::this_thread::yield();
+			i += static_cast<int>(nPushed);
+		}
+	} };
+
+	// The queue is drained even after a value comes out of order, so that the producer can finish and be joined
+	int nPopped = 0;
+	int nFirstMismatch = -1;
+	while (nPopped < value_count)
+	{
+		int nValue;
+		if (!queue.tryPop(nValue))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (nValue != nPopped && nFirstMismatch == -1) nFirstMismatch = nPopped;
+		++nPopped;
+	}
+	producer.join();
+	EXPECT_EQ(-1, nFirstMismatch);
+}
+
+TEST(MPMCRingBuffer, PushPop)
+{
+	MPMCRingBuffer<std::unique_ptr<int>> queue{ 4 };
+	for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.tryEmplace(new int{ i }));
+	EXPECT_FALSE(queue.tryPush(std::make_unique<int>(4)));
+
+	for (int lap = 0; lap < 3; ++lap)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			std::unique_ptr<int> p;
+			EXPECT_TRUE(queue.tryPop(p));
+			EXPECT_EQ(i, *p);
+			EXPECT_TRUE(queue.tryPush(std::move(p)));
+		}
+	}
+
+	std::unique_ptr<int> popped[8];
+	EXPECT_EQ(4u, queue.tryPopBatch(popped, 8));
+	EXPECT_EQ(0u, queue.sizeApprox());
+	EXPECT_FALSE(queue.tryPop(popped[0]));
+}
+
+TEST(MPMCRingBuffer, Batch)
+{
+	MPMCRingBuffer<int> queue{ 8 };
+	std::vector<int> values(10);
+	std::iota(values.begin(), values.end(), 0);
+
+	EXPECT_EQ(8u, queue.tryPushBatch(values.begin(), values.size()));
+	int popped[10];
+	EXPECT_EQ(3u, queue.tryPopBatch(popped, 3));
+	EXPECT_EQ(2u, queue.tryPushBatch(values.begin() + 8, 2));
+	EXPECT_EQ(7u, queue.tryPopBatch(popped + 3, 10));
+	for (int i = 0; i < 10; ++i) EXPECT_EQ(i, popped[i]);
+}
+
+TEST(MPMCRingBuffer, EmptyBatch)
+{
+	MPMCRingBuffer<int> queue{ 4 };
+	int values[4] = { 0, 1, 2, 3 };
+	int popped[4];
+
+	EXPECT_EQ(0u, queue.tryPushBatch(values, 0));
+	EXPECT_EQ(0u, queue.tryPopBatch(popped, 0));
+
+	EXPECT_EQ(2u, queue.tryPushBatch(values, 2));
+	EXPECT_EQ(0u, queue.tryPushBatch(values + 2, 0));
+	EXPECT_EQ(0u, queue.tryPopBatch(popped, 0));
+	EXPECT_EQ(2u, queue.sizeApprox());
+
+	EXPECT_EQ(2u, queue.tryPopBatch(popped, 4));
+	EXPECT_EQ(0, popped[0]);
+	EXPECT_EQ(1, popped[1]);
+}
+
+TEST(MPMCRingBuffer, DestroysRemainingElements)
+{
+	auto const pValue = std::make_shared<int>(0);
+	{
+		MPMCRingBuffer<std::shared_ptr<int>> queue{ 4 };
+		for (int i = 0; i < 3; ++i) queue.tryPush(pValue);
+		EXPECT_EQ(4, pValue.use_count());
+	}
+	EXPECT_EQ(1, pValue.use_count());
+}
+
+// Every value pushed by the producers is popped exactly once, by single or batch operations
+TEST(MPMCRingBuffer, Threads)
+{
+	constexpr int thread_count = 4;
+	constexpr int value_count = 20000;
+	MPMCRingBuffer<int> queue{ 32 };
+	std::vector<std::atomic<int>> seen(thread_count * value_count);
+	for (auto& nSeen : seen) nSeen = 0;
+	std::atomic<int> nPopped{ 0 };
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; ++t)
+	{
+		threads.emplace_back([&, t]() {
+			int i = 0;
+			while (i < value_count)
+			{
+				if (t % 2 == 0)
+				{
+					if (queue.tryPush(t * value_count + i)) ++i;
+					else std::this_thread::yield();
+				}
+				else
+				{
+					int batch[4];
+					auto const n = Math::Min(4, value_count - i);
+					for (int j = 0; j < n; ++j) batch[j] = t * value_count + i + j;
+					auto const nPushed = queue.tryPushBatch(batch, n);
+					if (nPushed == 0) std::this_thread::yield();
+					i += static_cast<int>(nPushed);
+				}
+			}
+		});
+
+		threads.emplace_back([&, t]() {
+			int batch[4];
+			while (nPopped < thread_count * value_count)
+			{
+				auto const n = t % 2 == 0 ? (queue.tryPop(batch[0]) ? 1 : 0) : queue.tryPopBatch(batch, 4);
+				if (n == 0) std::this_thread::yield();
+				for (size_t j = 0; j < n; ++j) ++seen[batch[j]];
+				nPopped += static_cast<int>(n);
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	for (auto& nSeen : seen) ASSERT_EQ(1, nSeen.load());
+	EXPECT_EQ(0u, queue.sizeApprox());
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "HE_SmallVector.h"
+
+#include <memory>
+#include <string>
+
+using namespace HE;
+
+namespace
+{
+	// Counts the allocations that reach the Parent
+	class CountingAllocator
+	{
+	public:
+		static constexpr size_t alignment = MallocAllocator::alignment;
+		static int s_nAllocations;
+
+		Blk allocate(size_t n)
+		{
+			++s_nAllocations;
+			return MallocAllocator::it.allocate(n);
+		}
+
+		void deallocate(Blk b) noexcept
+		{
+			MallocAllocator::it.deallocate(b);
+		}
+	};
+
+	int CountingAllocator::s_nAllocations = 0;
+}
+
+TEST(SmallVector, Inline)
+{
+	CountingAllocator::s_nAllocations = 0;
+	SmallVector<int, 8, CountingAllocator> v;
+	for (int i = 0; i < 8; ++i) v.push_back(i);
+
+	EXPECT_TRUE(v.isInline());
+	EXPECT_EQ(8, v.size());
+	EXPECT_EQ(8, v.capacity());
+	EXPECT_EQ(7, v.back());
+	EXPECT_EQ(0, CountingAllocator::s_nAllocations);
+}
+
+TEST(SmallVector, Grow)
+{
+	CountingAllocator::s_nAllocations = 0;
+	SmallVector<std::string, 4, CountingAllocator> v;
+	for (int i = 0; i < 20; ++i) v.push_back(std::to_string(i));
+
+	EXPECT_FALSE(v.isInline());
+	EXPECT_EQ(20, v.size());
+	EXPECT_EQ("0", v.front());
+	EXPECT_EQ("19", v.back());
+	EXPECT_EQ(3, CountingAllocator::s_nAllocations); // 8, 16 then 32 elements
+}
+
+TEST(SmallVector, GrowTrivial)
+{
+	SmallVector<int, 4> v{ 1, 2, 3, 4 };
+	v.push_back(5);
+
+	EXPECT_FALSE(v.isInline());
+	EXPECT_EQ(5, v.size());
+	for (int i = 0; i < 5; ++i) EXPECT_EQ(i + 1, v[i]);
+}
+
+TEST(SmallVector, PushBackElement)
+{
+	SmallVector<std::string, 2> v{ "first", "second" };
+	v.push_back(v[0]);
+
+	EXPECT_EQ("first", v[2]);
+}
+
+TEST(SmallVector, CopyAndMove)
+{
+	SmallVector<std::string, 2> small{ "a" };
+	SmallVector<std::string, 2> large{ "a", "b", "c" };
+
+	auto smallCopy = small;
+	auto largeCopy = large;
+	EXPECT_EQ("a", smallCopy[0]);
+	EXPECT_EQ("c", largeCopy[2]);
+
+	auto const pLarge = large.data();
+	auto movedLarge = std::move(large);
+	EXPECT_EQ(pLarge, movedLarge.data()); // The heap block is stolen
+	EXPECT_TRUE(large.empty());
+	EXPECT_TRUE(large.isInline());
+
+	auto movedSmall = std::move(small);
+	EXPECT_TRUE(movedSmall.isInline());
+	EXPECT_EQ("a", movedSmall[0]);
+
+	movedSmall = std::move(movedLarge);
+	EXPECT_EQ(3, movedSmall.size());
+	movedSmall = smallCopy;
+	EXPECT_EQ(1, movedSmall.size());
+}
+
+TEST(SmallVector, Erase)
+{
+	SmallVector<std::unique_ptr<int>, 4> v;
+	for (int i = 0; i < 4; ++i) v.emplace_back(new int{ i });
+
+	auto const it = v.erase(v.begin() + 1);
+	EXPECT_EQ(2, **it);
+	EXPECT_EQ(3, v.size());
+	EXPECT_EQ(3, *v.back());
+}
+
+TEST(SmallVector, Resize)
+{
+	SmallVector<int, 4> v;
+	v.resize(10, 7);
+	EXPECT_EQ(10, v.size());
+	EXPECT_EQ(7, v[9]);
+
+	v.resize(2);
+	EXPECT_EQ(2, v.size());
+	EXPECT_EQ(10, v.capacity());
+}
+
+static_assert(sizeof(SmallVector<int, 8>) >= 8 * sizeof(int), "Test fail on SmallVector");
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "HE_StatsAllocator.h"
+
+using namespace HE;
+
+TEST(StatsAllocator, Counters)
+{
+	StatsAllocator<MallocAllocator> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(100);
+	a.deallocate(b1);
+
+	auto const stats = a.stats();
+	EXPECT_EQ(2, stats.allocations);
+	EXPECT_EQ(0, stats.failedAllocations);
+	EXPECT_EQ(1, stats.deallocations);
+	EXPECT_EQ(100, stats.bytesInUse);
+	EXPECT_EQ(116, stats.peakBytes);
+
+	a.deallocate(b2);
+	EXPECT_EQ(0, a.stats().bytesInUse);
+	EXPECT_EQ(116, a.stats().peakBytes);
+}
+
+TEST(StatsAllocator, FailedAllocation)
+{
+	StatsAllocator<StackAllocator<64>> a;
+	a.allocate(64);
+	EXPECT_EQ(nullptr, a.allocate(64).ptr);
+
+	EXPECT_EQ(1, a.stats().allocations);
+	EXPECT_EQ(1, a.stats().failedAllocations);
+	EXPECT_EQ(64, a.stats().bytesInUse);
+}
+
+TEST(StatsAllocator, Histogram)
+{
+	StatsAllocator<MallocAllocator, StatsFlags::SizeHistogram> a;
+	Blk blocks[] = { a.allocate(1), a.allocate(16), a.allocate(17), a.allocate(32), a.allocate(1000) };
+	for (auto b : blocks) a.deallocate(b);
+
+	auto const stats = a.stats();
+	EXPECT_EQ(1, stats.histogram[0]);
+	EXPECT_EQ(1, stats.histogram[4]);
+	EXPECT_EQ(2, stats.histogram[5]);
+	EXPECT_EQ(1, stats.histogram[10]);
+
+	// Only the histogram was selected
+	EXPECT_EQ(0, stats.allocations);
+	EXPECT_EQ(0, stats.peakBytes);
+}
+
+TEST(StatsAllocator, CallSites)
+{
+	StatsAllocator<MallocAllocator, StatsFlags::All> a;
+	auto const nLine = __LINE__ + 1;
+	auto const b1 = a.allocate(16, HE_CALL_SITE);
+	auto const b2 = a.allocate(16);
+
+	EXPECT_EQ(nLine, decltype(a)::callSite(b1).line);
+	EXPECT_STREQ(__FILE__, decltype(a)::callSite(b1).file);
+	EXPECT_EQ(nullptr, decltype(a)::callSite(b2).file);
+	EXPECT_EQ(32, a.stats().bytesInUse);
+
+	a.deallocate(b1);
+	a.deallocate(b2);
+}
+
+TEST(StatsAllocator, ResetStats)
+{
+	StatsAllocator<MallocAllocator> a;
+	auto const b = a.allocate(16);
+	a.deallocate(a.allocate(100));
+	a.resetStats();
+
+	auto const stats = a.stats();
+	EXPECT_EQ(0, stats.allocations);
+	EXPECT_EQ(0, stats.deallocations);
+	EXPECT_EQ(16, stats.bytesInUse);
+	EXPECT_EQ(16, stats.peakBytes);
+
+	a.deallocate(b);
+}
+
+TEST(StatsAllocator, DeallocateAll)
+{
+	StatsAllocator<StackAllocator<64>> a;
+	a.allocate(16);
+	a.allocate(16);
+	a.deallocateAll();
+
+	EXPECT_EQ(0, a.stats().bytesInUse);
+	EXPECT_EQ(32, a.stats().peakBytes);
+}
+
+TEST(StatsAllocator, Dump)
+{
+	StatsAllocator<MallocAllocator, StatsFlags::All> a;
+	a.deallocate(a.allocate(24));
+
+	auto const s = to_string(a.stats());
+	EXPECT_NE(std::string::npos, s.find("allocations: 1 (0 failed), deallocations: 1"));
+	EXPECT_NE(std::string::npos, s.find("<= 32 bytes: 1"));
+}
+
+static_assert(std::is_empty<StatsAllocator<MallocAllocator, 0>>::value, "Test fail on StatsAllocator");
+static_assert(sizeof(StatsAllocator<MallocAllocator, StatsFlags::Allocations>) == 2 * sizeof(size_t), "Test fail on StatsAllocator");
+static_assert(IsOwningAllocator<StatsAllocator<StackAllocator<64>>>(), "Test fail on StatsAllocator");
+static_assert(IsAlignedAllocator<StatsAllocator<StackAllocator<64>>>(), "Test fail on StatsAllocator");
+static_assert(!IsOwningAllocator<StatsAllocator<MallocAllocator>>(), "Test fail on StatsAllocator");
+
+TEST(StatsAllocator, Reallocate)
+{
+	StatsAllocator<MallocAllocator> a;
+	auto b = a.allocate(16);
+	ASSERT_TRUE(reallocate(a, b, 100));
+	EXPECT_EQ(100, a.stats().bytesInUse);
+	EXPECT_EQ(100, a.stats().peakBytes);
+
+	a.deallocate(b);
+	EXPECT_EQ(0, a.stats().bytesInUse);
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "HE_StdAllocator.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <list>
+
+using namespace HE;
+
+TEST(StdAllocator, Stateless)
+{
+	std::vector<int, StdAllocator<int, MallocAllocator>> v;
+	for (int i = 0; i < 100; ++i) v.push_back(i);
+
+	EXPECT_EQ(99, v.back());
+	EXPECT_EQ(&MallocAllocator::it, &v.get_allocator().allocator());
+}
+
+TEST(StdAllocator, Stateful)
+{
+	using Stack = StackAllocator<1024>;
+	Stack stack;
+	std::vector<int, StdAllocator<int, Stack>> v{ StdAllocator<int, Stack>{ stack } };
+	v.reserve(16);
+	v.push_back(42);
+
+	EXPECT_TRUE(stack.owns({ v.data(), sizeof(int) }));
+	EXPECT_EQ(16 * sizeof(int), stack.size());
+}
+
+TEST(StdAllocator, Exhausted)
+{
+	using Stack = StackAllocator<64>;
+	Stack stack;
+	std::vector<int, StdAllocator<int, Stack>> v{ StdAllocator<int, Stack>{ stack } };
+
+	EXPECT_THROW(v.resize(100), std::bad_alloc);
+}
+
+TEST(StdAllocator, String)
+{
+	using Stack = StackAllocator<1024>;
+	using String = std::basic_string<char, std::char_traits<char>, StdAllocator<char, Stack>>;
+	Stack stack;
+	String s{ StdAllocator<char, Stack>{ stack } };
+	s.assign(100, 'a');
+
+	EXPECT_TRUE(stack.owns({ &s[0], s.size() }));
+}
+
+TEST(StdAllocator, UnorderedMap)
+{
+	using Pool = FreelistAllocator<MallocAllocator, 8, 64>;
+	using Map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, StdAllocator<std::pair<const int, int>, Pool>>;
+	Pool pool;
+	Map m{ 16, std::hash<int>{}, std::equal_to<int>{}, StdAllocator<std::pair<const int, int>, Pool>{ pool } };
+	for (int i = 0; i < 100; ++i) m[i] = i * 2;
+	for (int i = 0; i < 100; i += 2) m.erase(i);
+
+	EXPECT_EQ(50, m.size());
+	EXPECT_EQ(198, m[99]);
+}
+
+TEST(StdAllocator, OverAligned)
+{
+	struct alignas(64) Aligned
+	{
+		char c;
+	};
+
+	std::vector<Aligned, StdAllocator<Aligned, AlignedMallocAllocator>> v(3);
+	EXPECT_EQ(0, reinterpret_cast<size_t>(v.data()) % 64);
+}
+
+TEST(StdAllocator, Equality)
+{
+	using Stack = StackAllocator<64>;
+	Stack s1, s2;
+	StdAllocator<int, Stack> a1{ s1 };
+	StdAllocator<char, Stack> a2{ a1 };
+	StdAllocator<int, Stack> a3{ s2 };
+
+	EXPECT_TRUE(a1 == a2);
+	EXPECT_TRUE(a1 != a3);
+
+	using MallocInt = StdAllocator<int, MallocAllocator>;
+	using MallocChar = StdAllocator<char, MallocAllocator>;
+	EXPECT_TRUE(MallocInt{} == MallocChar{});
+}
+
+TEST(StdAllocator, MoveAssignment)
+{
+	using Stack = StackAllocator<1024>;
+	using List = std::list<int, StdAllocator<int, Stack>>;
+	Stack s1, s2;
+	List l1{ StdAllocator<int, Stack>{ s1 } };
+	List l2{ StdAllocator<int, Stack>{ s2 } };
+	l1.push_back(1);
+
+	// The allocator propagates, so nodes don't have to be copied to s2
+	l2 = std::move(l1);
+	EXPECT_EQ(&s1, &l2.get_allocator().allocator());
+	EXPECT_EQ(1, l2.front());
+}
+
+static_assert(std::is_empty<StdAllocator<int, MallocAllocator>>::value, "Test fail on StdAllocator");
+static_assert(sizeof(StdAllocator<int, StackAllocator<64>>) == sizeof(void*), "Test fail on StdAllocator");
+static_assert(StdAllocator<int, MallocAllocator>::is_always_equal::value, "Test fail on StdAllocator");
+static_assert(!StdAllocator<int, StackAllocator<64>>::is_always_equal::value, "Test fail on StdAllocator");
+static_assert(!std::is_default_constructible<StdAllocator<int, StackAllocator<64>>>::value, "Test fail on StdAllocator");
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "HE_String.h"
 
+#include <iterator>
+
 using namespace HE;
 using namespace std::string_literals;
 
@@ -77,6 +79,17 @@ TEST(HE_Format, SimpleNumber)
 	ASSERT_EQ("LMAO! 2CAT!!1", Format("LMAO! {0}CAT!!1", 2));
 }
 
+TEST(HE_Format, Pointer)
+{
+	int value = 0;
+	void* const p = &value;
+
+	char sExpected[32];
+	std::snprintf(sExpected, sizeof(sExpected), "%p", p);
+	EXPECT_EQ(sExpected, Format("{_}", p));
+	EXPECT_EQ(sExpected, Format(HE_FORMAT("{_}"), p));
+}
+
 TEST(HE_Format, NextArg)
 {
 	ASSERT_EQ("Can you recognize those memes?", Format("Can you recognize those {_}?", "memes"));
@@ -104,6 +117,14 @@ TEST(HE_Format, MultipleArguments)
 	ASSERT_EQ("The result of this test is 42", Format("The {0} of this {1} is {2}", "result", "test", 42));
 }
 
+TEST(HE_Format, ManyArguments)
+{
+	std::string const sName = "ten";
+	EXPECT_EQ("ten 9 8 7 6 5 4 3 2 1 0.5 1",
+		Format("{10} {9} {8} {7} {6} {5} {4} {3} {2} {1} {0} {_}", 0.5, 1, 2u, 3L, 4UL, 5LL, 6ULL, short{ 7 }, 8.0f, "9", sName));
+	EXPECT_EQ("[0.50]", Format("[{0:.2}]", 0.5f, sName, 3));
+}
+
 TEST(HE_Format, FormatWorks)
 {
 	ASSERT_NO_THROW(Format("{0:.2}", 7.25f));
@@ -125,7 +146,128 @@ TEST(HE_Format, MisorderedArguments)
 	ASSERT_EQ("7.5 + 13.5 = 21", Format("{1:1.1} + {2:2.1} = {0}", 21, 7.5f, 13.5));
 }
 
+TEST(HE_Format, Escape)
+{
+	EXPECT_EQ("{0} is 1", Format("\\{0} is {0}", 1));
+}
+
+TEST(HE_FormatString, NoFormat)
+{
+	EXPECT_EQ("Hello", Format(HE_FORMAT("Hello")));
+	EXPECT_EQ("", Format(HE_FORMAT("")));
+}
+
+TEST(HE_FormatString, Tokens)
+{
+	EXPECT_EQ("Hello World!", Format(HE_FORMAT("Hello {0}!"), "World"));
+	EXPECT_EQ("LMAO! 2CAT!!1", Format(HE_FORMAT("LMAO! {0}CAT!!1"), 2));
+	EXPECT_EQ("I wish I could take this testing seriously",
+		Format(HE_FORMAT("{_} wish I could take this {_} {_}"), "I", "testing", "seriously"));
+	EXPECT_EQ("mushi mushi, Jesus desu", Format(HE_FORMAT("{0} {0}, Jesus desu"), "mushi"));
+}
+
+TEST(HE_FormatString, NextArgOffset)
+{
+	EXPECT_EQ("It's currently 42 degrees Fahrenheit outside in this January 3rd. Oh btw forgot Hello",
+		Format(HE_FORMAT("It's currently {1} degrees {_} outside in this {3} {_}rd. Oh btw forgot {0}"), "Hello", 42, "Fahrenheit", "January", 3));
+}
+
+TEST(HE_FormatString, Specifier)
+{
+	EXPECT_EQ("Pi is kind of like 3.14", Format(HE_FORMAT("Pi is kind of like {_:.2}"), 3.1415f));
+	EXPECT_EQ("7.5 + 13.5 = 21", Format(HE_FORMAT("{1:1.1} + {2:2.1} = {0}"), 21, 7.5f, 13.5));
+	EXPECT_EQ("0000002a", Format(HE_FORMAT("{_:08x}"), 42u));
+}
+
+TEST(HE_FormatString, Escape)
+{
+	EXPECT_EQ("{0} is 1", Format(HE_FORMAT("\\{0} is {0}"), 1));
+}
+
+// Parsed the same way as at run-time
+TEST(HE_FormatString, SameAsRuntime)
+{
+	std::string const sValue = "value";
+	EXPECT_EQ(Format("[{_}] {1:.3} {0}, {_}", sValue, 2.5, 'c'), Format(HE_FORMAT("[{_}] {1:.3} {0}, {_}"), sValue, 2.5, 'c'));
+}
+
+TEST(to_string, long_format)
+{
+	EXPECT_EQ("   42", to_string(42L, "5"));
+	EXPECT_EQ("2a", to_string(42UL, "x"));
+	EXPECT_EQ("0052", to_string(42ULL, "04o"));
+	EXPECT_EQ("0052", to_string(42ULL, "04oll"));
+	EXPECT_EQ("-42", to_string(-42LL, "lld"));
+	EXPECT_EQ("1.50", to_string(1.5L, ".2"));
+}
+
+TEST(HE_FormatTo, Buffer)
+{
+	char buffer[64];
+	auto const result = FormatTo(buffer, "{_} + {_} = {_:.1}, {_}", 1, 2u, 3.0, "three"s);
+	EXPECT_EQ("1 + 2 = 3.0, three", std::string(buffer, result.out));
+	EXPECT_EQ(18u, result.size);
+
+	auto const compiledResult = FormatTo(buffer, HE_FORMAT("{_} + {_} = {_:.1}, {_}"), 1, 2u, 3.0, "three"s);
+	EXPECT_EQ("1 + 2 = 3.0, three", std::string(buffer, compiledResult.out));
+}
+
+TEST(HE_FormatTo, Truncated)
+{
+	char buffer[8] = {};
+	auto const result = FormatTo(gsl::span<char>{ buffer, 6 }, "Hello {_}!", "World");
+	EXPECT_EQ(12u, result.size);
+	EXPECT_EQ(buffer + 6, result.out);
+	EXPECT_EQ("Hello ", std::string(buffer, result.out));
+	EXPECT_EQ('\0', buffer[6]);
+
+	EXPECT_EQ(12u, FormatTo(gsl::span<char>{ buffer, 8 }, HE_FORMAT("Hello {_}!"), "World").size);
+	EXPECT_EQ("Hello Wo", std::string(buffer, 8));
+}
+
+TEST(HE_FormatTo, OutputIterator)
+{
+	std::string sOutput = ">";
+	auto it = FormatTo(std::back_inserter(sOutput), "{0} {1:03} {0}", 'c', 7);
+	*it = '<';
+	EXPECT_EQ(">99 007 99<", sOutput);
+
+	FormatTo(std::back_inserter(sOutput), HE_FORMAT(" \\{_:x}"), 255u);
+	EXPECT_EQ(">99 007 99< {_:x}", sOutput);
+}
+
+TEST(HE_FormatTo, FormattedSize)
+{
+	EXPECT_EQ(0u, FormattedSize(""));
+	EXPECT_EQ(Format("{_}: {_:.3}", "pi", 3.14159).size(), FormattedSize("{_}: {_:.3}", "pi", 3.14159));
+	EXPECT_EQ(300u, FormattedSize("{_:300}", 1));
+	EXPECT_EQ(5u, FormattedSize(HE_FORMAT("{_}"), 12345));
+}
+
+// Conversions longer than the stack buffer of the built-in numbers
+TEST(HE_FormatTo, LongConversion)
+{
+	auto const sExpected = std::string(299, ' ') + "1";
+	EXPECT_EQ(sExpected, Format("{_:300}", 1));
+
+	char buffer[400];
+	auto const result = FormatTo(buffer, HE_FORMAT("{_:300}"), 1);
+	EXPECT_EQ(sExpected, std::string(buffer, result.out));
+}
+
+TEST(HE_FormatTo, SpecifierTooLong)
+{
+	auto const sFormat = "{_:" + std::string(100, '0') + "}";
+	EXPECT_THROW(Format(sFormat.c_str(), 1), Assert::Exception);
+}
+
+// These shouldn't compile
+//static_assert(sizeof(Format(HE_FORMAT("{1}"), 1)), "Fail"); // Index higher than the number of arguments
+//static_assert(sizeof(Format(HE_FORMAT("{x}"), 1)), "Fail"); // Invalid index
+//static_assert(sizeof(Format(HE_FORMAT("{0"), 1)), "Fail"); // Missing '}'
+
 // constexpr_string tests
 static_assert(constexpr_string{ "Hey, a test" }.size() == 11, "constexpr_string test failed");
 static_assert(constexpr_string{ "Hey, a test" }[2] == 'y', "constexpr_string test failed");
+static_assert(constexpr_string{ "Hey, a test" }.data()[5] == 'a', "constexpr_string test failed");
 //static_assert(constexpr_string{ "Umm" }[7], "Fail"); // This shouldn't compile
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "HE_TrackingAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace HE;
+
+namespace
+{
+	using Tracking = TrackingAllocator<MallocAllocator>;
+
+	// Two distinct call stacks
+	Blk AllocateFromLoader(Tracking& a, size_t n) { return a.allocate(n); }
+	Blk AllocateFromAudio(Tracking& a, size_t n) { return a.allocate(n); }
+}
+
+static_assert(IsAllocator<Tracking>(), "TrackingAllocator should be an allocator");
+
+TEST(TrackingAllocator, LiveAllocations)
+{
+	Tracking a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(100);
+	auto const b3 = a.allocate(7);
+	a.deallocate(b2);
+
+	std::vector<size_t> sizes;
+	a.forEachLive([&](const AllocationRecord& record) {
+		sizes.push_back(record.size);
+		EXPECT_EQ(CurrentThreadId(), record.threadId);
+	});
+	ASSERT_EQ(2u, sizes.size());
+	EXPECT_EQ(7u, sizes[0]);
+	EXPECT_EQ(16u, sizes[1]);
+
+	EXPECT_EQ(b3.ptr, Tracking::record(b3).block());
+	EXPECT_LE(Tracking::record(b1).timestamp, Tracking::record(b3).timestamp);
+	EXPECT_EQ(23u, a.bytesInUse());
+	EXPECT_EQ(123u, a.peakBytes());
+
+	a.deallocate(b1);
+	a.deallocate(b3);
+	size_t nLive = 0;
+	a.forEachLive([&](const AllocationRecord&) { ++nLive; });
+	EXPECT_EQ(0u, nLive);
+	EXPECT_EQ(0u, a.bytesInUse());
+}
+
+TEST(TrackingAllocator, Reallocate)
+{
+	Tracking a;
+	auto const b1 = a.allocate(8);
+	auto b2 = a.allocate(16);
+	auto const b3 = a.allocate(8);
+	std::memset(b2.ptr, 0x5A, b2.length);
+
+	EXPECT_TRUE(a.reallocate(b2, 4096));
+	EXPECT_EQ(4096u, Tracking::record(b2).size);
+	EXPECT_EQ(0x5A, static_cast<unsigned char*>(b2.ptr)[15]);
+	EXPECT_EQ(4112u, a.bytesInUse());
+
+	size_t nLive = 0;
+	a.forEachLive([&](const AllocationRecord&) { ++nLive; });
+	EXPECT_EQ(3u, nLive);
+
+	a.deallocate(b1);
+	a.deallocate(b2);
+	a.deallocate(b3);
+	EXPECT_EQ(0u, a.bytesInUse());
+}
+
+TEST(TrackingAllocator, Threads)
+{
+	Tracking a;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&]() {
+			std::vector<Blk> blocks;
+			for (int i = 0; i < 1000; ++i) blocks.push_back(a.allocate(16));
+			for (size_t i = 0; i < blocks.size(); i += 2) a.deallocate(blocks[i]);
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	std::vector<std::uint32_t> threadIds;
+	size_t nLive = 0;
+	a.forEachLive([&](const AllocationRecord& record) {
+		++nLive;
+		if (std::find(threadIds.begin(), threadIds.end(), record.threadId) == threadIds.end()) threadIds.push_back(record.threadId);
+	});
+	EXPECT_EQ(2000u, nLive);
+	EXPECT_EQ(4u, threadIds.size());
+	EXPECT_EQ(2000u * 16, a.bytesInUse());
+}
+
+TEST(TrackingAllocator, Report)
+{
+	Tracking a;
+	std::vector<Blk> blocks;
+	for (int i = 0; i < 10; ++i) blocks.push_back(AllocateFromLoader(a, 1000));
+	for (int i = 0; i < 10; ++i) blocks.push_back(AllocateFromAudio(a, 100));
+
+	// Without backtraces, everything is under the unknown call stack
+	if (Tracking::record(blocks.front()).backtraceHash == 0) return;
+
+	auto report = a.report();
+	ASSERT_EQ(2u, report.size());
+	EXPECT_EQ(Tracking::record(blocks.front()).backtraceHash, report[0].backtraceHash);
+	EXPECT_EQ(10u, report[0].liveAllocations);
+	EXPECT_EQ(10000u, report[0].liveBytes);
+	EXPECT_EQ(Tracking::record(blocks.back()).backtraceHash, report[1].backtraceHash);
+	EXPECT_EQ(1000u, report[1].liveBytes);
+
+	Backtrace backtrace;
+	EXPECT_TRUE(FindBacktrace(report[0].backtraceHash, backtrace));
+	EXPECT_NE(0u, backtrace.count);
+	EXPECT_NE(std::string::npos, to_string(report[0]).find("10000 bytes in 10 live allocations"));
+
+	// The loader's peak stays after its memory is freed
+	for (size_t i = 0; i < 10; ++i) a.deallocate(blocks[i]);
+	report = a.report();
+	ASSERT_EQ(2u, report.size());
+	EXPECT_EQ(1000u, report[0].liveBytes);
+	EXPECT_EQ(0u, report[1].liveBytes);
+	EXPECT_EQ(10000u, report[1].peakBytes);
+	EXPECT_EQ(11000u, a.peakBytes());
+
+	a.resetPeak();
+	EXPECT_EQ(1000u, a.peakBytes());
+	EXPECT_EQ(1u, a.report().size());
+
+	for (size_t i = 10; i < blocks.size(); ++i) a.deallocate(blocks[i]);
+}
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include <gtest/gtest.h>
+
+#include "HE_VirtualMemory.h"
+
+#include <cstring>
+#include <limits>
+
+using namespace HE;
+
+namespace
+{
+	bool IsAligned(const void* p, size_t alignment) noexcept
+	{
+		return reinterpret_cast<size_t>(p) % alignment == 0;
+	}
+}
+
+TEST(VirtualMemory, PageSize)
+{
+	auto const nPageSize = VirtualMemory::GetPageSize();
+	EXPECT_TRUE(Math::IsPow2(nPageSize));
+	EXPECT_EQ(0, nPageSize % PlatformPageSize);
+}
+
+TEST(VirtualMemory, ReserveCommit)
+{
+	auto const nSize = 16 * VirtualMemory::GetPageSize();
+	auto const p = static_cast<char*>(VirtualMemory::Reserve(nSize));
+	ASSERT_NE(nullptr, p);
+
+	ASSERT_TRUE(VirtualMemory::Commit(p, nSize));
+	std::memset(p, 0xAB, nSize);
+
+	// Committed pages come back zeroed after a decommit
+	VirtualMemory::Decommit(p, nSize);
+	ASSERT_TRUE(VirtualMemory::Commit(p, nSize));
+	EXPECT_EQ(0, p[0]);
+	EXPECT_EQ(0, p[nSize - 1]);
+
+	VirtualMemory::Release(p, nSize);
+}
+
+TEST(VirtualMemory, ReserveAligned)
+{
+	auto const nAlignment = 1024 * 1024;
+	auto const p = VirtualMemory::ReserveAligned(3 * VirtualMemory::GetPageSize(), nAlignment);
+	ASSERT_NE(nullptr, p);
+	EXPECT_TRUE(IsAligned(p, nAlignment));
+
+	VirtualMemory::Release(p, 3 * VirtualMemory::GetPageSize());
+}
+
+TEST(VirtualMemory, ReserveHugePages)
+{
+	// Falls back to regular pages when huge pages are not available
+	auto const nSize = 4 * 1024 * 1024;
+	auto const p = static_cast<char*>(VirtualMemory::ReserveAligned(nSize, 2 * 1024 * 1024, true));
+	ASSERT_NE(nullptr, p);
+
+	ASSERT_TRUE(VirtualMemory::Commit(p, nSize));
+	p[0] = 1;
+	p[nSize - 1] = 1;
+
+	VirtualMemory::Release(p, nSize);
+}
+
+TEST(VirtualMemory, HugePageBacking)
+{
+	auto backing = VirtualMemory::HugePageBacking::Explicit;
+	auto const p = VirtualMemory::Reserve(VirtualMemory::GetPageSize(), false, &backing);
+	ASSERT_NE(nullptr, p);
+	EXPECT_EQ(VirtualMemory::HugePageBacking::None, backing);
+	VirtualMemory::Release(p, VirtualMemory::GetPageSize());
+
+	// Without huge pages, the reservation still succeeds
+	auto const nSize = 4 * 1024 * 1024;
+	auto const pHuge = VirtualMemory::ReserveAligned(nSize, 2 * 1024 * 1024, true, &backing);
+	ASSERT_NE(nullptr, pHuge);
+	if (VirtualMemory::GetHugePageSize() == 0)
+	{
+		EXPECT_EQ(VirtualMemory::HugePageBacking::None, backing);
+	}
+	else if (VirtualMemory::GetHugePageSize() != 2 * 1024 * 1024)
+	{
+		// Pages of another size could not be committed by steps of the alignment
+		EXPECT_NE(VirtualMemory::HugePageBacking::Explicit, backing);
+	}
+	VirtualMemory::Release(pHuge, nSize);
+}
+
+TEST(PageAllocator, Allocate)
+{
+	auto const b = PageAllocator::it.allocate(100);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_EQ(100, b.length);
+	EXPECT_TRUE(IsAligned(b.ptr, PageAllocator::alignment));
+	EXPECT_NO_FATAL_FAILURE(std::memset(b.ptr, 0, b.length));
+
+	PageAllocator::it.deallocate(b);
+}
+
+TEST(PageAllocator, AllocateAligned)
+{
+	auto const b = PageAllocator::it.allocate(100, 64 * 1024);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_TRUE(IsAligned(b.ptr, 64 * 1024));
+
+	PageAllocator::it.deallocate(b);
+}
+
+TEST(PageAllocator, Parent)
+{
+	FreelistAllocator<PageAllocator, 8 * 1024> a;
+	auto const b1 = a.allocate(8 * 1024);
+	a.deallocate(b1);
+	EXPECT_EQ(b1.ptr, a.allocate(8 * 1024).ptr);
+}
+
+// Compacting then trimming gives back the pages above the top of the heap
+TEST(PageAllocator, CompactingTrim)
+{
+	CompactingAllocator<PageAllocator, 256 * 1024, 64> a;
+	auto const nPageSize = VirtualMemory::GetPageSize();
+	EXPECT_EQ(a.capacity(), a.committed());
+
+	decltype(a)::Handle handles[16];
+	for (auto& h : handles)
+	{
+		h = a.allocate(15 * 1024);
+		ASSERT_FALSE(h.isNull());
+	}
+	for (int i = 0; i < 16; i += 2) a.deallocate(handles[i]);
+
+	// The holes stay committed until compacted
+	auto const nTop = a.size();
+	a.trim();
+	EXPECT_EQ(Math::RoundUpToMultipleOf(nTop, nPageSize), a.committed());
+
+	a.compact();
+	a.trim();
+	EXPECT_EQ(Math::RoundUpToMultipleOf(a.size(), nPageSize), a.committed());
+	EXPECT_LE(a.committed(), nTop / 2 + nPageSize);
+
+	// The decommitted pages are committed again when allocated
+	for (int i = 0; i < 16; i += 2)
+	{
+		handles[i] = a.allocate(15 * 1024);
+		ASSERT_FALSE(handles[i].isNull());
+		auto const b = a.resolve(handles[i]);
+		std::memset(b.ptr, i, b.length);
+	}
+	EXPECT_EQ(Math::RoundUpToMultipleOf(nTop, nPageSize), a.committed());
+}
+
+static_assert(IsAlignedAllocator<PageAllocator>(), "Test fail on PageAllocator");
+static_assert(IsStatelessAllocator<PageAllocator>(), "Test fail on PageAllocator");
+
+TEST(VirtualRegionAllocator, LazyCommit)
+{
+	// 64 GiB of address space on 64-bit targets and 256 MiB on 32-bit ones, without any of it being resident
+	VirtualRegionAllocator<size_t{ 1 } << (sizeof(void*) == 8 ? 36 : 28)> a;
+	ASSERT_NE(0, a.reserved());
+	EXPECT_EQ(0, a.committed());
+
+	auto const b1 = a.allocate(100);
+	ASSERT_NE(nullptr, b1.ptr);
+	EXPECT_EQ(decltype(a)::commit_granularity, a.committed());
+	std::memset(b1.ptr, 0, b1.length);
+
+	auto const b2 = a.allocate(1024 * 1024);
+	ASSERT_NE(nullptr, b2.ptr);
+	EXPECT_GE(a.committed(), a.size());
+	std::memset(b2.ptr, 0, b2.length);
+}
+
+TEST(VirtualRegionAllocator, AllocateAligned)
+{
+	VirtualRegionAllocator<1024 * 1024> a;
+	a.allocate(1);
+	auto const b = a.allocate(16, 4096);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_TRUE(IsAligned(b.ptr, 4096));
+}
+
+TEST(VirtualRegionAllocator, Full)
+{
+	VirtualRegionAllocator<64 * 1024> a;
+	EXPECT_NE(nullptr, a.allocate(32 * 1024).ptr);
+	EXPECT_EQ(nullptr, a.allocate(64 * 1024).ptr);
+	EXPECT_NE(nullptr, a.allocate(32 * 1024).ptr);
+}
+
+TEST(VirtualRegionAllocator, Overflow)
+{
+	auto const nMax = std::numeric_limits<size_t>::max();
+	VirtualRegionAllocator<64 * 1024> a;
+	auto b = a.allocate(16);
+
+	EXPECT_EQ(nullptr, a.allocate(nMax - 5).ptr);
+	EXPECT_EQ(nullptr, a.allocate(nMax - 5, 4096).ptr);
+	EXPECT_FALSE(a.reallocate(b, nMax - 5));
+	EXPECT_EQ(16, b.length);
+	EXPECT_EQ(decltype(a)::commit_granularity, a.committed());
+}
+
+TEST(VirtualRegionAllocator, Trim)
+{
+	VirtualRegionAllocator<16 * 1024 * 1024> a;
+	auto const b1 = a.allocate(16);
+	auto const b2 = a.allocate(1024 * 1024);
+	auto const nCommitted = a.committed();
+
+	a.deallocate(b2);
+	EXPECT_EQ(nCommitted, a.committed());
+
+	a.trim();
+	EXPECT_EQ(decltype(a)::commit_granularity, a.committed());
+	EXPECT_TRUE(a.owns(b1));
+
+	a.deallocateAll();
+	EXPECT_EQ(0, a.committed());
+	EXPECT_EQ(b1.ptr, a.allocate(16).ptr);
+}
+
+TEST(VirtualRegionAllocator, HugePages)
+{
+	VirtualRegionAllocator<64 * 1024 * 1024, true> a;
+	auto const b = a.allocate(3 * 1024 * 1024);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_EQ(4 * 1024 * 1024, a.committed());
+	std::memset(b.ptr, 0, b.length);
+}
+
+TEST(VirtualRegionAllocator, Parent)
+{
+	StackAllocator<1024, VirtualRegionAllocator<1024 * 1024>> a;
+	auto const b = a.allocate(512);
+	EXPECT_NE(nullptr, b.ptr);
+	a.deallocate(b);
+}
+
+static_assert(IsAlignedAllocator<VirtualRegionAllocator<1024>>(), "Test fail on VirtualRegionAllocator");
+static_assert(IsOwningAllocator<VirtualRegionAllocator<1024>>(), "Test fail on VirtualRegionAllocator");
+
+TEST(VirtualRegionAllocator, Reallocate)
+{
+	VirtualRegionAllocator<16 * 1024 * 1024> a;
+	auto b = a.allocate(16);
+	auto const p = b.ptr;
+
+	// The last block grows in place, committing pages on the way
+	ASSERT_TRUE(reallocate(a, b, 1024 * 1024));
+	EXPECT_EQ(p, b.ptr);
+	EXPECT_GE(a.committed(), 1024 * 1024);
+	std::memset(b.ptr, 0, b.length);
+
+	EXPECT_FALSE(a.expand(b, 16 * 1024 * 1024));
+}
+
+TEST(HugePageArena, Allocate)
+{
+	HugePageArena a{ 5 * 1024 * 1024 };
+	EXPECT_EQ(6 * 1024 * 1024, a.reserved());
+
+	auto const b1 = a.allocate(100);
+	ASSERT_NE(nullptr, b1.ptr);
+	EXPECT_TRUE(IsAligned(b1.ptr, 2 * 1024 * 1024));
+	EXPECT_EQ(2 * 1024 * 1024, a.committed());
+
+	auto const b2 = a.allocate(3 * 1024 * 1024, 1024 * 1024);
+	ASSERT_NE(nullptr, b2.ptr);
+	EXPECT_TRUE(IsAligned(b2.ptr, 1024 * 1024));
+	EXPECT_EQ(4 * 1024 * 1024, a.committed());
+	std::memset(b2.ptr, 0, b2.length);
+
+	EXPECT_EQ(nullptr, a.allocate(3 * 1024 * 1024).ptr);
+	if (a.backing() == VirtualMemory::HugePageBacking::None) SUCCEED() << "Huge pages are not available";
+}
+
+// Sizes that overflow once rounded up fail to reserve, ex: a huge --simulation-arena argument
+TEST(HugePageArena, Overflow)
+{
+	auto const nMax = std::numeric_limits<size_t>::max();
+	EXPECT_EQ(nullptr, VirtualMemory::Reserve(nMax));
+	EXPECT_EQ(nullptr, VirtualMemory::ReserveAligned(nMax, 2 * 1024 * 1024));
+	EXPECT_EQ(nullptr, VirtualMemory::ReserveAligned(nMax - 1024 * 1024, 2 * 1024 * 1024));
+
+	HugePageArena a{ nMax };
+	EXPECT_EQ(0, a.reserved());
+	EXPECT_EQ(nullptr, a.allocate(100).ptr);
+
+	// Allocations that overflow once rounded up fail on a valid arena too
+	HugePageArena h{ 4 * 1024 * 1024 };
+	ASSERT_NE(0, h.reserved());
+	EXPECT_EQ(nullptr, h.allocate(nMax).ptr);
+	EXPECT_EQ(nullptr, h.allocate(nMax, 1024 * 1024).ptr);
+
+	auto b = h.allocate(100);
+	ASSERT_NE(nullptr, b.ptr);
+	EXPECT_FALSE(h.reallocate(b, nMax));
+	EXPECT_FALSE(h.expand(b, nMax - 100));
+	EXPECT_EQ(100, b.length);
+	EXPECT_EQ(Math::RoundUpToMultipleOf(100, HugePageArena::alignment), h.size());
+}
+
+static_assert(IsAlignedAllocator<HugePageArena>(), "Test fail on HugePageArena");
+static_assert(IsOwningAllocator<HugePageArena>(), "Test fail on HugePageArena");
\ No newline at end of file
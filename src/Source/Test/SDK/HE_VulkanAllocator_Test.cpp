@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "HE_VulkanAllocator.h"
+#include "HE_StatsAllocator.h"
+
+#include <limits>
+#include <vector>
+
+using namespace HE;
+
+namespace
+{
+	// Mimics the host allocations an ICD makes through the application's callbacks
+	class MockDriver
+	{
+	public:
+		explicit MockDriver(const VkAllocationCallbacks& callbacks) : m_callbacks{ callbacks } {}
+
+		void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+		{
+			return m_callbacks.pfnAllocation(m_callbacks.pUserData, size, alignment, scope);
+		}
+
+		void* reallocate(void* p, size_t size, size_t alignment, VkSystemAllocationScope scope)
+		{
+			return m_callbacks.pfnReallocation(m_callbacks.pUserData, p, size, alignment, scope);
+		}
+
+		void free(void* p)
+		{
+			m_callbacks.pfnFree(m_callbacks.pUserData, p);
+		}
+
+		// An object with a state growing in several reallocations, like a pipeline cache
+		void* createObject(size_t nFinalSize)
+		{
+			void* p = nullptr;
+			for (size_t n = 16; n <= nFinalSize; n *= 2)
+			{
+				p = reallocate(p, n, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+				static_cast<char*>(p)[0] = 42;
+				static_cast<char*>(p)[n - 1] = 42;
+			}
+			return p;
+		}
+
+	private:
+		VkAllocationCallbacks m_callbacks;
+	};
+
+	bool IsAligned(const void* p, size_t alignment) noexcept
+	{
+		return reinterpret_cast<size_t>(p) % alignment == 0;
+	}
+}
+
+TEST(VulkanAllocationCallbacks, Allocate)
+{
+	StatsAllocator<MallocAllocator> allocator;
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocator) };
+
+	auto const p1 = driver.allocate(100, 8, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+	auto const p2 = driver.allocate(100, 256, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+	ASSERT_NE(nullptr, p1);
+	ASSERT_NE(nullptr, p2);
+	EXPECT_TRUE(IsAligned(p1, 8));
+	EXPECT_TRUE(IsAligned(p2, 256));
+	EXPECT_EQ(2, allocator.stats().allocations);
+
+	driver.free(p1);
+	driver.free(p2);
+	driver.free(nullptr);
+	EXPECT_EQ(2, allocator.stats().deallocations);
+	EXPECT_EQ(0, allocator.stats().bytesInUse);
+}
+
+TEST(VulkanAllocationCallbacks, Reallocate)
+{
+	StatsAllocator<MallocAllocator> allocator;
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocator) };
+
+	auto const p = driver.createObject(1024);
+	ASSERT_NE(nullptr, p);
+	EXPECT_EQ(42, static_cast<char*>(p)[0]);
+	EXPECT_TRUE(IsAligned(p, 16));
+
+	EXPECT_EQ(nullptr, driver.reallocate(p, 0, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+	EXPECT_EQ(0, allocator.stats().bytesInUse);
+}
+
+TEST(VulkanAllocationCallbacks, ReallocateInPlace)
+{
+	// The last block of a stack grows in place through expand
+	StackAllocator<4096> allocator;
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocator) };
+
+	auto const p = driver.allocate(16, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	static_cast<char*>(p)[0] = 42;
+	EXPECT_EQ(p, driver.reallocate(p, 1024, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+	EXPECT_EQ(p, driver.reallocate(p, 512, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+	EXPECT_EQ(42, static_cast<char*>(p)[0]);
+
+	driver.free(p);
+	EXPECT_EQ(0, allocator.size());
+}
+
+TEST(VulkanAllocationCallbacks, CommandScope)
+{
+	StatsAllocator<MallocAllocator> persistent;
+	StackAllocator<4096> transient;
+	vk::ScopedAllocator<decltype(persistent), decltype(transient)> allocators{ persistent, transient };
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocators) };
+
+	auto const pObject = driver.allocate(64, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	auto const pCommand = driver.allocate(64, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+
+	EXPECT_EQ(1, persistent.stats().allocations);
+	EXPECT_TRUE(transient.owns({ pCommand, 64 }));
+	EXPECT_FALSE(transient.owns({ pObject, 64 }));
+
+	driver.free(pCommand);
+	EXPECT_EQ(0, transient.size());
+	driver.free(pObject);
+	EXPECT_EQ(0, persistent.stats().bytesInUse);
+}
+
+TEST(VulkanAllocationCallbacks, OutOfMemory)
+{
+	StackAllocator<64> allocator;
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocator) };
+
+	EXPECT_EQ(nullptr, driver.allocate(128, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+}
+
+// A huge size from the driver fails instead of wrapping to a small allocation
+TEST(VulkanAllocationCallbacks, Overflow)
+{
+	StatsAllocator<MallocAllocator> allocator;
+	MockDriver driver{ vk::MakeAllocationCallbacks(allocator) };
+	auto const nMax = std::numeric_limits<size_t>::max();
+
+	EXPECT_EQ(nullptr, driver.allocate(nMax, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+	EXPECT_EQ(nullptr, driver.allocate(nMax - 16, 256, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+
+	auto const p = driver.allocate(16, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	ASSERT_NE(nullptr, p);
+	EXPECT_EQ(nullptr, driver.reallocate(p, nMax - 16, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT));
+	EXPECT_EQ(1, allocator.stats().allocations);
+
+	driver.free(p);
+	EXPECT_EQ(0, allocator.stats().bytesInUse);
+}
@@ -5,6 +5,7 @@
 
 #include "HE_String.h"
 #include "HE_Assert.h"
+#include "Bench/Benchmark.h"
 #include <debugbreak.h>
 
 HE::Assert::Response TestAssertHandler(const std::string& sCondition, const std::string& sMessage, const std::string& file, int line)
@@ -14,6 +15,9 @@ HE::Assert::Response TestAssertHandler(const std::string& sCondition, const std:
 }
 
 GTEST_API_ int main(int argc, char **argv) {
+	// --benchmark runs the benchmarks instead of the tests
+	if (HE::Bench::IsRequested(argc, argv)) return HE::Bench::Main(argc, argv);
+
 	printf("Running main() from test_main.cpp\n");
 	testing::InitGoogleTest(&argc, argv);
 